@@ -0,0 +1,179 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "utils/vector.h"
+#include "utils/stack.h"
+#include "containers.h"
+
+
+/* Sinks the values read during a measurement so the compiler cannot drop the reads. */
+static volatile uintptr_t sink;
+
+static double vectorChecked(size_t operations);
+static double vectorUnchecked(size_t operations);
+static double stackChecked(size_t operations);
+static double stackUnchecked(size_t operations);
+static double now(void);
+
+
+/**
+ * Times push, at and pop on the vector and the stack through both their checked and unchecked operations.
+ * The results are printed on the standard output as a JSON array with one object per container and interface.
+ *
+ * @param       operations the number of elements pushed, read and popped in each measurement.
+ * @param       repeat the number of times each measurement is repeated, the best time is kept.
+ */
+void runContainerBenchmarks(size_t operations, size_t repeat) {
+    struct {
+        char const * container;
+        char const * interface;
+        double (* measure)(size_t operations);
+    } const measurements[] = {
+        { "vector", "checked",      vectorChecked },
+        { "vector", "unchecked",    vectorUnchecked },
+        { "stack",  "checked",      stackChecked },
+        { "stack",  "unchecked",    stackUnchecked }
+    };
+    size_t count = sizeof measurements / sizeof measurements[0];
+
+#if defined(NDEBUG)
+    char const * build = "release";
+#else
+    char const * build = "debug";
+#endif
+
+    printf("[\n");
+    for (size_t i = 0; i < count; i++) {
+        double best = measurements[i].measure(operations);
+        for (size_t run = 1; run < repeat; run++) {
+            double seconds = measurements[i].measure(operations);
+            if (seconds < best)
+                best = seconds;
+        }
+
+        // Every element is pushed, read and popped once
+        printf(
+            "  {\"container\": \"%s\", \"interface\": \"%s\", \"build\": \"%s\", \"operations\": %zu, \"seconds\": %.6f, \"ns_per_op\": %.2f}%s\n",
+            measurements[i].container,
+            measurements[i].interface,
+            build,
+            3 * operations,
+            best,
+            best * 1e9 / (double) (3 * operations),
+            i + 1 < count ? "," : ""
+        );
+    }
+    printf("]\n");
+}
+
+
+static double vectorChecked(size_t operations) {
+    struct Vector * vector = newVector(16, "Ran out of memory while benchmarking the vector.");
+    double start = now();
+
+    for (size_t i = 0; i < operations; i++)
+        vectorPushback(vector, (void *) (uintptr_t) i);
+
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < vectorSize(vector); i++)
+        sum += (uintptr_t) vectorAt(vector, i);
+
+    while (isVectorEmpty(vector) == false)
+        sum += (uintptr_t) vectorPopback(vector);
+
+    double seconds = now() - start;
+    sink = sum;
+    deleteVector(& vector);
+    return seconds;
+}
+
+
+static double vectorUnchecked(size_t operations) {
+    struct Vector * vector = newVector(16, "Ran out of memory while benchmarking the vector.");
+    double start = now();
+
+    for (size_t i = 0; i < operations; i++)
+        vectorPushbackUnchecked(vector, (void *) (uintptr_t) i);
+
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < vectorSizeUnchecked(vector); i++)
+        sum += (uintptr_t) vectorAtUnchecked(vector, i);
+
+    while (vectorSizeUnchecked(vector) > 0)
+        sum += (uintptr_t) vectorPopbackUnchecked(vector);
+
+    double seconds = now() - start;
+    sink = sum;
+    deleteVector(& vector);
+    return seconds;
+}
+
+
+static double stackChecked(size_t operations) {
+    struct SizeTStack * stack = newSizeTStack(16, "Ran out of memory while benchmarking the stack.");
+    double start = now();
+
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < operations; i++) {
+        sizeTStackPush(stack, i);
+        sum += sizeTStackTop(stack);
+    }
+
+    while (isSizeTStackEmpty(stack) == false)
+        sum += sizeTStackPop(stack);
+
+    double seconds = now() - start;
+    sink = sum;
+    deleteSizeTStack(& stack);
+    return seconds;
+}
+
+
+static double stackUnchecked(size_t operations) {
+    struct SizeTStack * stack = newSizeTStack(16, "Ran out of memory while benchmarking the stack.");
+    double start = now();
+
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < operations; i++) {
+        sizeTStackPushUnchecked(stack, i);
+        sum += sizeTStackTopUnchecked(stack);
+    }
+
+    while (sizeTStackSizeUnchecked(stack) > 0)
+        sum += sizeTStackPopUnchecked(stack);
+
+    double seconds = now() - start;
+    sink = sum;
+    deleteSizeTStack(& stack);
+    return seconds;
+}
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, & time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
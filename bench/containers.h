@@ -0,0 +1,34 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef BENCH_CONTAINERS_H
+#define BENCH_CONTAINERS_H
+
+#include <stddef.h>
+
+
+/**
+ * Times push, at and pop on the vector and the stack through both their checked and unchecked operations.
+ * The results are printed on the standard output as a JSON array with one object per container and interface.
+ *
+ * @param       operations the number of elements pushed, read and popped in each measurement.
+ * @param       repeat the number of times each measurement is repeated, the best time is kept.
+ */
+void runContainerBenchmarks(size_t operations, size_t repeat);
+
+#endif
@@ -0,0 +1,327 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/token_type.h"
+#include "corpus.h"
+
+
+struct Builder {
+    char * buffer;
+    size_t capacity;
+    size_t length;
+    uint64_t state;
+};
+
+static void append(struct Builder * const builder, char const * text, size_t length);
+static void appendString(struct Builder * const builder, char const * text);
+static void appendRepeat(struct Builder * const builder, char c, size_t count);
+static uint32_t randomBelow(struct Builder * const builder, uint32_t bound);
+static void appendIdentifier(struct Builder * const builder);
+static void indentationLine(struct Builder * const builder);
+static void commentsLine(struct Builder * const builder);
+static void literalsLine(struct Builder * const builder);
+static void identifiersLine(struct Builder * const builder);
+static void blankLinesLine(struct Builder * const builder);
+static void indentedBlockLine(struct Builder * const builder);
+
+#define KEYWORD_LEXEME(lexeme, type) lexeme,
+static char const * const keywords[] = {
+    AVL_KEYWORDS(KEYWORD_LEXEME)
+};
+#undef KEYWORD_LEXEME
+
+static char const * const operators[] = {
+    "+", "-", "*", "**", "/", "%", "==", "===", "!=", "=!=", "<", "<=", ">", ">=", "<<", ">>", "&&", "||", "&", "|", "^", "~", "."
+};
+
+static char const * const corpus_names[] = {
+    "indentation",
+    "comments",
+    "literals",
+    "identifiers",
+    "blank-lines",
+    "indented-block"
+};
+
+static void (* const generators[])(struct Builder * const builder) = {
+    indentationLine,
+    commentsLine,
+    literalsLine,
+    identifiersLine,
+    blankLinesLine,
+    indentedBlockLine
+};
+
+
+/**
+ * Returns the name of the given corpus shape.
+ *
+ * @param       shape the corpus shape.
+ *
+ * @return      the name of the shape.
+ */
+char const * corpusName(enum CorpusShape shape) {
+    return corpus_names[shape];
+}
+
+
+/**
+ * Generates a synthetic source of the given shape.
+ * The same shape and size always yield the same source.
+ *
+ * @param       shape the corpus shape.
+ * @param       size the approximate size of the source in bytes, the source always ends with a complete line.
+ * @param       length set to the exact length of the generated source.
+ *
+ * @return      the null terminated source, to be freed by the caller.
+ */
+char * generateCorpus(enum CorpusShape shape, size_t size, size_t * length) {
+    struct Builder builder;
+    builder.capacity = size + 4096;
+    builder.length = 0;
+    builder.state = 0x9E3779B97F4A7C15u;
+    builder.buffer = malloc(builder.capacity);
+    if (builder.buffer == NULL) {
+        fprintf(stderr, "Ran out of memory while generating the <%s> corpus.\n", corpusName(shape));
+        exit(74);
+    }
+
+    while (builder.length < size)
+        generators[shape](& builder);
+
+    // Close whatever indentation levels are still open so the source ends cleanly
+    appendString(& builder, "end\n");
+    builder.buffer[builder.length] = '\0';
+    * length = builder.length;
+    return builder.buffer;
+}
+
+
+/* Corpus shapes. Each function appends one or more complete lines. */
+
+static void indentationLine(struct Builder * const builder) {
+    // A block that nests up to 32 levels deep and then closes them all at once
+    size_t depth = 1 + randomBelow(builder, 32);
+    for (size_t level = 0; level < depth; level++) {
+        appendRepeat(builder, ' ', 4 * level);
+        appendString(builder, "if ");
+        appendIdentifier(builder);
+        appendString(builder, ":\n");
+    }
+
+    appendRepeat(builder, ' ', 4 * depth);
+    appendString(builder, "pass\n");
+}
+
+static void commentsLine(struct Builder * const builder) {
+    static char const words[] = "the quantum register is initialized in the ground state before any gate is applied to it ";
+
+    switch (randomBelow(builder, 8)) {
+        // A multi line comment
+        case 0:
+            appendString(builder, "-[ ");
+            for (size_t line = 0; line < 4; line++) {
+                append(builder, words, 40 + randomBelow(builder, 40));
+                appendString(builder, "\n   ");
+            }
+            appendString(builder, "]-\n");
+            break;
+
+        // A line of code with a trailing comment
+        case 1:
+            appendString(builder, "val ");
+            appendIdentifier(builder);
+            appendString(builder, " = ");
+            appendIdentifier(builder);
+            appendString(builder, " -- ");
+            append(builder, words, 20 + randomBelow(builder, 60));
+            appendString(builder, "\n");
+            break;
+
+        // A single line comment
+        default:
+            appendString(builder, "-- ");
+            append(builder, words, 40 + randomBelow(builder, 50));
+            appendString(builder, "\n");
+            break;
+    }
+}
+
+static void literalsLine(struct Builder * const builder) {
+    static char const hex[] = "0123456789ABCDEF";
+
+    appendString(builder, "val ");
+    appendIdentifier(builder);
+    appendString(builder, " = ");
+
+    switch (randomBelow(builder, 6)) {
+        // Quantum bitstrings describe register initial states and can be very long
+        case 0: {
+            appendString(builder, "0q");
+            size_t width = 8 + randomBelow(builder, 249);
+            for (size_t i = 0; i < width; i++)
+                appendRepeat(builder, (char) ('0' + randomBelow(builder, 2)), 1);
+            appendString(builder, "b");
+            break;
+        }
+
+        case 1: {
+            appendString(builder, randomBelow(builder, 2) ? "0c" : "0q");
+            size_t width = 1 + randomBelow(builder, 16);
+            for (size_t i = 0; i < width; i++)
+                appendRepeat(builder, hex[randomBelow(builder, 16)], 1);
+            appendString(builder, "h");
+            break;
+        }
+
+        // A leading zero is reserved for the classical and quantum prefixes
+        case 2: {
+            size_t width = randomBelow(builder, 10);
+            appendRepeat(builder, (char) ('1' + randomBelow(builder, 7)), 1);
+            for (size_t i = 0; i < width; i++)
+                appendRepeat(builder, (char) ('0' + randomBelow(builder, 8)), 1);
+            appendString(builder, "o");
+            break;
+        }
+
+        case 3: {
+            size_t width = randomBelow(builder, 18);
+            appendRepeat(builder, (char) ('1' + randomBelow(builder, 9)), 1);
+            for (size_t i = 0; i < width; i++)
+                appendRepeat(builder, (char) ('0' + randomBelow(builder, 10)), 1);
+            break;
+        }
+
+        case 4: {
+            char number[32];
+            snprintf(number, sizeof number, "%u.%uf", 1 + randomBelow(builder, 99999), randomBelow(builder, 100000));
+            appendString(builder, number);
+            break;
+        }
+
+        default: {
+            char number[32];
+            snprintf(number, sizeof number, "0q%u.%ud", randomBelow(builder, 1000), randomBelow(builder, 1000));
+            appendString(builder, number);
+            break;
+        }
+    }
+
+    appendString(builder, "\n");
+}
+
+static void identifiersLine(struct Builder * const builder) {
+    size_t words = 4 + randomBelow(builder, 12);
+    for (size_t word = 0; word < words; word++) {
+        if (word > 0)
+            appendString(builder, " ");
+
+        uint32_t kind = randomBelow(builder, 8);
+        if (kind < 3)
+            appendString(builder, keywords[randomBelow(builder, sizeof keywords / sizeof keywords[0])]);
+        else if (kind < 7)
+            appendIdentifier(builder);
+        else
+            appendString(builder, operators[randomBelow(builder, sizeof operators / sizeof operators[0])]);
+    }
+
+    appendString(builder, "\n");
+}
+
+static void blankLinesLine(struct Builder * const builder) {
+    appendString(builder, "def ");
+    appendIdentifier(builder);
+    appendString(builder, ":\n    pass\n");
+
+    // Runs of blank lines that only contain the indentation of the enclosing block
+    size_t blanks = 64 + randomBelow(builder, 1024);
+    for (size_t blank = 0; blank < blanks; blank++)
+        appendString(builder, "    \n");
+}
+
+static void indentedBlockLine(struct Builder * const builder) {
+    // The whole corpus is the body of a single declaration so no line but the first begins at the first column
+    if (builder -> length == 0)
+        appendString(builder, "def block():\n");
+
+    size_t depth = 1 + randomBelow(builder, 8);
+    for (size_t level = 1; level <= depth; level++) {
+        appendRepeat(builder, ' ', 4 * level);
+        appendString(builder, "if ");
+        appendIdentifier(builder);
+        appendString(builder, ":\n");
+    }
+
+    appendRepeat(builder, ' ', 4 * (depth + 1));
+    appendString(builder, "pass\n");
+}
+
+
+/* Helpers */
+
+static void append(struct Builder * const builder, char const * text, size_t length) {
+    if (builder -> length + length + 1 > builder -> capacity) {
+        size_t new_capacity = 2 * builder -> capacity + length;
+        char * buffer = realloc(builder -> buffer, new_capacity);
+        if (buffer == NULL) {
+            fprintf(stderr, "Ran out of memory while generating a corpus.\n");
+            exit(74);
+        }
+
+        builder -> buffer = buffer;
+        builder -> capacity = new_capacity;
+    }
+
+    memcpy(builder -> buffer + builder -> length, text, length);
+    builder -> length += length;
+}
+
+static void appendString(struct Builder * const builder, char const * text) {
+    append(builder, text, strlen(text));
+}
+
+static void appendRepeat(struct Builder * const builder, char c, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        append(builder, & c, 1);
+}
+
+static void appendIdentifier(struct Builder * const builder) {
+    static char const first[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static char const rest[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+
+    char identifier[32];
+    size_t length = 2 + randomBelow(builder, 14);
+    identifier[0] = first[randomBelow(builder, sizeof first - 1)];
+    for (size_t i = 1; i < length; i++)
+        identifier[i] = rest[randomBelow(builder, sizeof rest - 1)];
+
+    append(builder, identifier, length);
+}
+
+/* xorshift64*, good enough to make corpora that do not repeat themselves and deterministic across runs */
+static uint32_t randomBelow(struct Builder * const builder, uint32_t bound) {
+    builder -> state ^= builder -> state >> 12;
+    builder -> state ^= builder -> state << 25;
+    builder -> state ^= builder -> state >> 27;
+    return (uint32_t) ((builder -> state * 0x2545F4914F6CDD1Du) >> 32) % bound;
+}
@@ -0,0 +1,58 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <stddef.h>
+
+
+/* The shapes of synthetic Avalon sources we know how to generate. Each one stresses a different part of the lexer. */
+enum CorpusShape {
+    CORPUS_INDENTATION,     // deeply nested blocks that open and close many indentation levels
+    CORPUS_COMMENTS,        // mostly single line and multi line comments
+    CORPUS_LITERALS,        // classical and quantum numeric literals such as 0q101b or 0cFFh
+    CORPUS_IDENTIFIERS,     // a mix of keywords and identifiers
+    CORPUS_BLANK_LINES,     // indented blank lines
+    CORPUS_INDENTED_BLOCK,  // a single declaration which indented body is the whole corpus
+    CORPUS_SHAPES_COUNT
+};
+
+
+/**
+ * Returns the name of the given corpus shape.
+ *
+ * @param       shape the corpus shape.
+ *
+ * @return      the name of the shape.
+ */
+char const * corpusName(enum CorpusShape shape);
+
+
+/**
+ * Generates a synthetic source of the given shape.
+ * The same shape and size always yield the same source.
+ *
+ * @param       shape the corpus shape.
+ * @param       size the approximate size of the source in bytes, the source always ends with a complete line.
+ * @param       length set to the exact length of the generated source.
+ *
+ * @return      the null terminated source, to be freed by the caller.
+ */
+char * generateCorpus(enum CorpusShape shape, size_t size, size_t * length);
+
+#endif
@@ -0,0 +1,391 @@
+/*  This file is part of the Avalon programming language
+ *
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/token_type.h"
+#include "common/char_class.h"
+#include "lexer/keywords.h"
+#include "lexer/scan.h"
+#include "keyword_lookup.h"
+
+
+/* The longest word we check the lookups against, keywords included. */
+#define WORD_MAX_LENGTH 32
+
+/* Sinks the token types found during a measurement so the compiler cannot drop the lookups. */
+static volatile uintptr_t sink;
+
+static enum TokenType trieLookup(char const * word, size_t length);
+static enum TokenType trieMatch(char const * word, size_t length, size_t start, size_t rest_length, char const * rest, enum TokenType type);
+static enum TokenType hashLookup(char const * word, size_t length);
+static bool lookupsAgree(char const * word, size_t length);
+
+
+/**
+ * Finds every word of the source, that is every run of letters, digits and underscores, and tells whether it is a keyword using the given lookup.
+ *
+ * @param       source the null terminated source to find words in.
+ * @param       lookup the way keywords are told apart from identifiers.
+ *
+ * @return      the number of words found.
+ */
+size_t classifyWords(char const * source, enum KeywordLookup lookup) {
+    size_t words = 0;
+    uintptr_t sum = 0;
+
+    for (char const * current = source; * current != '\0'; current++) {
+        if ((char_classes[(unsigned char) * current] & CHAR_IDENT) == 0)
+            continue;
+
+        // Both lookups go through the same scan so the difference between them is the lookup alone
+        char const * end = scanIdentifier(current + 1);
+        size_t length = (size_t) (end - current);
+        sum += lookup == KEYWORD_LOOKUP_TRIE ? trieLookup(current, length) : hashLookup(current, length);
+        words++;
+
+        current = end - 1;
+    }
+
+    sink = sum;
+    return words;
+}
+
+
+/**
+ * Checks that both lookups agree on every keyword, on every word of the source and on the words that are one character off a keyword.
+ * Disagreements are printed on the standard error.
+ *
+ * @param       source the null terminated source to find words in.
+ *
+ * @return      true if both lookups agree, false otherwise.
+ */
+bool keywordLookupsAgree(char const * source) {
+    #define KEYWORD_LEXEME(lexeme, type) lexeme,
+    static char const * const lexemes[] = { AVL_KEYWORDS(KEYWORD_LEXEME) };
+    #undef KEYWORD_LEXEME
+
+    bool agree = true;
+    for (size_t i = 0; i < sizeof lexemes / sizeof lexemes[0]; i++) {
+        char word[WORD_MAX_LENGTH + 1];
+        size_t length = strlen(lexemes[i]);
+        memcpy(word, lexemes[i], length + 1);
+
+        // The keyword itself and every prefix of it
+        for (size_t prefix = 1; prefix <= length; prefix++)
+            agree &= lookupsAgree(word, prefix);
+
+        // The keyword with one more character at its end
+        word[length] = 'f';
+        agree &= lookupsAgree(word, length + 1);
+        word[length] = '\0';
+
+        // The keyword with one of its characters replaced
+        for (size_t position = 0; position < length; position++) {
+            char original = word[position];
+            word[position] = original == 'e' ? 'f' : 'e';
+            agree &= lookupsAgree(word, length);
+            word[position] = original;
+        }
+    }
+
+    for (char const * current = source; * current != '\0'; current++) {
+        if ((char_classes[(unsigned char) * current] & CHAR_IDENT) == 0)
+            continue;
+
+        char const * end = scanIdentifier(current + 1);
+        agree &= lookupsAgree(current, (size_t) (end - current));
+        current = end - 1;
+    }
+
+    return agree;
+}
+
+
+/**
+ * Tells whether the word is a keyword by switching over its leading characters, the way the lexer did before keywords got a perfect hash.
+ * The entry for <def> looked past the end of the word and never matched, it is fixed here so both lookups can be compared on the same tokens.
+ *
+ * @param       word pointer to the first character of the word.
+ * @param       length the length of the word, at least one.
+ *
+ * @return      the type of the keyword, IDENTIFIER if the word is not a keyword.
+ */
+static enum TokenType trieLookup(char const * word, size_t length) {
+    switch (word[0]) {
+        case 'a':
+            return trieMatch(word, length, 1, 2, "nd", AVL_LOGICAL_AND);
+
+        case 'b':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'a':
+                        return trieMatch(word, length, 2, 2, "nd", AVL_BITWISE_AND);
+
+                    case 'n':
+                        return trieMatch(word, length, 2, 2, "ot", AVL_BITWISE_NOT);
+
+                    case 'o':
+                        return trieMatch(word, length, 2, 1, "r", AVL_BITWISE_OR);
+
+                    case 'r':
+                        return trieMatch(word, length, 2, 3, "eak", AVL_BREAK);
+                }
+            }
+            break;
+
+        case 'c':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'a':
+                        if (length <= 2 || word[2] != 's')
+                            return AVL_IDENTIFIER;
+
+                        if (length > 3) {
+                            switch (word[3]) {
+                                case 'e':
+                                    return trieMatch(word, length, 3, 1, "e", AVL_CASE);
+
+                                case 't':
+                                    return trieMatch(word, length, 3, 1, "t", AVL_CAST);
+                            }
+                        }
+                        break;
+
+                    case 'o':
+                        if (length <= 2 || word[2] != 'n')
+                            return AVL_IDENTIFIER;
+
+                        if (length > 3) {
+                            switch (word[3]) {
+                                case 's':
+                                    return trieMatch(word, length, 4, 1, "t", AVL_CONST);
+
+                                case 't':
+                                    return trieMatch(word, length, 4, 4, "inue", AVL_CONTINUE);
+                            }
+                        }
+                        break;
+                }
+            }
+            break;
+
+        case 'd':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'e':
+                        if (length <= 2 || word[2] != 'f')
+                            return AVL_IDENTIFIER;
+
+                        if (length == 3)
+                            return AVL_DEF;
+
+                        return trieMatch(word, length, 3, 4, "ault", AVL_DEFAULT);
+
+                    case 'r':
+                        return trieMatch(word, length, 2, 2, "ef", AVL_DREF);
+                }
+            }
+            break;
+
+        case 'e':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'l':
+                        if (length > 2) {
+                            switch (word[2]) {
+                                case 'i':
+                                    return trieMatch(word, length, 3, 1, "f", AVL_ELIF);
+
+                                case 's':
+                                    return trieMatch(word, length, 3, 1, "e", AVL_ELSE);
+                            }
+                        }
+                        break;
+
+                    case 'm':
+                        return trieMatch(word, length, 2, 3, "pty", AVL_EMPTY);
+                }
+            }
+            break;
+
+        case 'f':
+            return trieMatch(word, length, 1, 2, "or", AVL_FOR);
+
+        case 'i':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'f':
+                        return trieMatch(word, length, 1, 1, "f", AVL_IF);
+
+                    case 'm':
+                        return trieMatch(word, length, 2, 4, "port", AVL_IMPORT);
+
+                    case 'n':
+                        return trieMatch(word, length, 1, 1, "n", AVL_IN);
+
+                    case 's':
+                        return trieMatch(word, length, 1, 1, "s", AVL_IS);
+                }
+            }
+            break;
+
+        case 'l':
+            return trieMatch(word, length, 1, 2, "sh", AVL_LEFT_SHIFT);
+
+        case 'n':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'a':
+                        return trieMatch(word, length, 2, 7, "mespace", AVL_NAMESPACE);
+
+                    case 'e':
+                        return trieMatch(word, length, 2, 2, "xt", AVL_NEXT);
+
+                    case 'o':
+                        return trieMatch(word, length, 2, 1, "t", AVL_LOGICAL_NOT);
+                }
+            }
+            break;
+
+        case 'o':
+            return trieMatch(word, length, 1, 1, "r", AVL_LOGICAL_OR);
+
+        case 'p':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'a':
+                        return trieMatch(word, length, 2, 2, "ss", AVL_PASS);
+
+                    case 'r':
+                        if (length > 2) {
+                            switch (word[2]) {
+                                case 'e':
+                                    return trieMatch(word, length, 3, 1, "v", AVL_PREV);
+
+                                case 'i':
+                                    return trieMatch(word, length, 3, 4, "vate", AVL_PRIVATE);
+                            }
+                        }
+                        break;
+
+                    case 't':
+                        return trieMatch(word, length, 2, 1, "r", AVL_PTR);
+
+                    case 'u':
+                        return trieMatch(word, length, 2, 4, "blic", AVL_PUBLIC);
+                }
+            }
+            break;
+
+        case 'r':
+            if (length > 1) {
+                switch (word[1]) {
+                    case 'e':
+                        if (length > 2) {
+                            switch (word[2]) {
+                                case 'f':
+                                    return trieMatch(word, length, 2, 1, "f", AVL_REF);
+
+                                case 't':
+                                    return trieMatch(word, length, 3, 3, "urn", AVL_RETURN);
+                            }
+                        }
+                        break;
+
+                    case 's':
+                        return trieMatch(word, length, 2, 1, "h", AVL_RIGHT_SHIFT);
+                }
+            }
+            break;
+
+        case 's':
+            return trieMatch(word, length, 1, 5, "witch", AVL_SWITCH);
+
+        case 't':
+            return trieMatch(word, length, 1, 3, "ype", AVL_TYPE);
+
+        case 'u':
+            return trieMatch(word, length, 1, 5, "nique", AVL_UNIQUE);
+
+        case 'v':
+            if (length <= 1 || word[1] != 'a')
+                return AVL_IDENTIFIER;
+
+            if (length > 2) {
+                switch (word[2]) {
+                    case 'r':
+                        return trieMatch(word, length, 2, 1, "r", AVL_VAR);
+
+                    case 'l':
+                        return trieMatch(word, length, 2, 1, "l", AVL_VAL);
+                }
+            }
+            break;
+
+        case 'w':
+            return trieMatch(word, length, 1, 4, "hile", AVL_WHILE);
+
+        case 'x':
+            return trieMatch(word, length, 1, 2, "or", AVL_BITWISE_XOR);
+    }
+
+    return AVL_IDENTIFIER;
+}
+
+
+static enum TokenType trieMatch(char const * word, size_t length, size_t start, size_t rest_length, char const * rest, enum TokenType type) {
+    if (length == start + rest_length && memcmp(word + start, rest, rest_length) == 0)
+        return type;
+
+    return AVL_IDENTIFIER;
+}
+
+
+/**
+ * Tells whether the word is a keyword the way the lexer does, with one hash and one comparison against the generated table.
+ *
+ * @param       word pointer to the first character of the word.
+ * @param       length the length of the word, at least one.
+ *
+ * @return      the type of the keyword, IDENTIFIER if the word is not a keyword.
+ */
+static enum TokenType hashLookup(char const * word, size_t length) {
+    if (length > KEYWORD_MAX_LENGTH)
+        return AVL_IDENTIFIER;
+
+    struct Keyword const * keyword = & keywords[keywordHash(word, length, KEYWORD_SEED, KEYWORD_BITS)];
+    if (keyword -> length == length && memcmp(keyword -> lexeme, word, length) == 0)
+        return (enum TokenType) keyword -> type;
+
+    return AVL_IDENTIFIER;
+}
+
+
+static bool lookupsAgree(char const * word, size_t length) {
+    enum TokenType trie = trieLookup(word, length);
+    enum TokenType hash = hashLookup(word, length);
+    if (trie == hash)
+        return true;
+
+    fprintf(stderr, "The keyword lookups disagree on <%.*s>: the trie finds %s, the perfect hash finds %s.\n", (int) length, word, tokenTypeToString(trie), tokenTypeToString(hash));
+    return false;
+}
@@ -0,0 +1,53 @@
+/*  This file is part of the Avalon programming language
+ *
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCH_KEYWORD_LOOKUP_H
+#define BENCH_KEYWORD_LOOKUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* The ways we tell keywords apart from identifiers. */
+enum KeywordLookup {
+    KEYWORD_LOOKUP_TRIE,    // the nested switch over the leading characters the lexer used before the perfect hash, kept as the baseline
+    KEYWORD_LOOKUP_HASH     // the generated perfect hash table the lexer uses
+};
+
+
+/**
+ * Finds every word of the source, that is every run of letters, digits and underscores, and tells whether it is a keyword using the given lookup.
+ *
+ * @param       source the null terminated source to find words in.
+ * @param       lookup the way keywords are told apart from identifiers.
+ *
+ * @return      the number of words found.
+ */
+size_t classifyWords(char const * source, enum KeywordLookup lookup);
+
+
+/**
+ * Checks that both lookups agree on every keyword, on every word of the source and on the words that are one character off a keyword.
+ * Disagreements are printed on the standard error.
+ *
+ * @param       source the null terminated source to find words in.
+ *
+ * @return      true if both lookups agree, false otherwise.
+ */
+bool keywordLookupsAgree(char const * source);
+
+#endif
@@ -0,0 +1,355 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/* Lexer throughput benchmarks.
+ * Every corpus shape is lexed through every variant and each measurement runs in its own process so the peak resident set size it reports belongs to that measurement alone.
+ * The keyword variants do not lex the corpus, they tell the words of the corpus apart from keywords through the trie the lexer used to have and through the perfect hash it uses now.
+ * Results are printed on the standard output as a JSON array with one object per measurement.
+ *
+ * Usage: bench [--size <MiB>] [--corpus <name>] [--repeat <count>]
+ *        bench --containers [--repeat <count>]
+ *
+ * With --containers, the vector and stack operations are timed instead of the lexer.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "common/token_buffer.h"
+#include "common/source_manager.h"
+#include "common/interner.h"
+#include "lexer/stream.h"
+#include "lexer/lexer.h"
+#include "lexer/scan.h"
+#include "utils/file.h"
+#include "keyword_lookup.h"
+#include "containers.h"
+#include "corpus.h"
+
+
+/* The ways we lex a corpus. */
+enum Variant {
+    VARIANT_PULL,           // lexToken() in a loop, best scanning kernels
+    VARIANT_PULL_SCALAR,    // lexToken() in a loop, scalar scanning kernels
+    VARIANT_PULL_INTERN,    // lexToken() in a loop interning identifiers as they come, what a parser pulling tokens would do
+    VARIANT_BATCH,          // lexTokens() into a token buffer
+    VARIANT_READ,           // loadFile() with LOAD_READ followed by lexTokens()
+    VARIANT_MAP,            // loadFile() with LOAD_MAP followed by lexTokens()
+    VARIANT_STREAM,         // streamToken() in a loop over the file read chunk by chunk
+    VARIANT_KEYWORDS_TRIE,  // every word of the corpus told apart from keywords by the trie the lexer used to have
+    VARIANT_KEYWORDS_HASH,  // every word of the corpus told apart from keywords by the perfect hash the lexer uses
+    VARIANTS_COUNT
+};
+
+static char const * const variant_names[] = {
+    "pull",
+    "pull-scalar",
+    "pull-intern",
+    "batch",
+    "read",
+    "map",
+    "stream",
+    "keywords-trie",
+    "keywords-hash"
+};
+
+struct Measurement {
+    size_t bytes;
+    size_t tokens;
+    double seconds;
+};
+
+static void runMeasurement(enum CorpusShape shape, enum Variant variant, char const * source, size_t length, char const * path, size_t repeat);
+static struct Measurement measure(enum Variant variant, char const * source, size_t length, char const * path);
+static size_t lexPull(struct SourceManager * const sources, uint16_t file, bool intern);
+static size_t lexBatch(struct SourceManager * const sources, uint16_t file);
+static size_t lexStream(char const * path);
+static size_t peakResidentSetSize(void);
+static double now(void);
+
+
+int main(int argc, char * argv[]) {
+    size_t size = 8;
+    size_t repeat = 3;
+    char const * only = NULL;
+    bool containers = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size = (size_t) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = (size_t) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else if (strcmp(argv[i], "--containers") == 0)
+            containers = true;
+        else {
+            fprintf(stderr, "Usage: bench [--size <MiB>] [--corpus <name>] [--repeat <count>]\n       bench --containers [--repeat <count>]\n");
+            return 64;
+        }
+    }
+
+    if (size == 0 || repeat == 0) {
+        fprintf(stderr, "The corpus size and the repeat count must be positive.\n");
+        return 64;
+    }
+
+    // A million elements each pushed, read and popped
+    if (containers) {
+        runContainerBenchmarks(1000000, repeat);
+        return 0;
+    }
+
+    char path[] = "/tmp/avalon-bench-XXXXXX";
+    bool first = true;
+
+    printf("[\n");
+    for (size_t shape = 0; shape < CORPUS_SHAPES_COUNT; shape++) {
+        if (only != NULL && strcmp(only, corpusName(shape)) != 0)
+            continue;
+
+        size_t length = 0;
+        char * source = generateCorpus(shape, size << 20, & length);
+
+        // The file based variants need the corpus on disk
+        int descriptor = mkstemp(path);
+        if (descriptor < 0 || write(descriptor, source, length) != (ssize_t) length) {
+            fprintf(stderr, "Failed to write the <%s> corpus to a temporary file.\n", corpusName(shape));
+            return 74;
+        }
+        close(descriptor);
+
+        for (size_t variant = 0; variant < VARIANTS_COUNT; variant++) {
+            printf("%s", first ? "" : ",\n");
+            fflush(stdout);
+            first = false;
+
+            runMeasurement(shape, variant, source, length, path, repeat);
+        }
+
+        unlink(path);
+        strcpy(path, "/tmp/avalon-bench-XXXXXX");
+        free(source);
+    }
+    printf("\n]\n");
+
+    return 0;
+}
+
+
+/**
+ * Runs one measurement in a child process and prints its result as a JSON object.
+ * We keep the best of the repeated runs since it is the least disturbed by whatever else the machine is doing.
+ */
+static void runMeasurement(enum CorpusShape shape, enum Variant variant, char const * source, size_t length, char const * path, size_t repeat) {
+    pid_t child = fork();
+    if (child < 0) {
+        fprintf(stderr, "Failed to start a benchmark process.\n");
+        exit(71);
+    }
+
+    if (child > 0) {
+        int status = 0;
+        waitpid(child, & status, 0);
+        if (WIFEXITED(status) == false || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "The <%s/%s> benchmark failed.\n", corpusName(shape), variant_names[variant]);
+            exit(70);
+        }
+        return;
+    }
+
+    selectScanKernel(variant == VARIANT_PULL_SCALAR ? SCAN_SCALAR : SCAN_BEST);
+
+    // Timing the trie against the perfect hash only means something if they find the same keywords
+    if (variant == VARIANT_KEYWORDS_TRIE && keywordLookupsAgree(source) == false)
+        exit(70);
+
+    struct Measurement best = measure(variant, source, length, path);
+    for (size_t run = 1; run < repeat; run++) {
+        struct Measurement measurement = measure(variant, source, length, path);
+        if (measurement.seconds < best.seconds)
+            best = measurement;
+    }
+
+    printf(
+        "  {\"corpus\": \"%s\", \"variant\": \"%s\", \"kernel\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.2f, \"tokens_per_s\": %.0f, \"peak_rss_kb\": %zu}",
+        corpusName(shape),
+        variant_names[variant],
+        currentScanKernel() == SCAN_SCALAR ? "scalar" : currentScanKernel() == SCAN_SSE2 ? "sse2" : "avx2",
+        best.bytes,
+        best.tokens,
+        best.seconds,
+        (double) best.bytes / (1 << 20) / best.seconds,
+        (double) best.tokens / best.seconds,
+        peakResidentSetSize()
+    );
+    // exit() and not _exit() so instrumented builds write their profile, stdout was flushed before forking so nothing is printed twice
+    exit(0);
+}
+
+
+/**
+ * Lexes the corpus once using the given variant.
+ */
+static struct Measurement measure(enum Variant variant, char const * source, size_t length, char const * path) {
+    struct Measurement measurement;
+    measurement.bytes = length;
+
+    double start = now();
+    struct SourceManager * sources = newSourceManager(variant == VARIANT_MAP ? LOAD_MAP : LOAD_READ, "Ran out of memory while loading the corpus.");
+    switch (variant) {
+        case VARIANT_PULL:
+        case VARIANT_PULL_SCALAR:
+        case VARIANT_PULL_INTERN:
+            measurement.tokens = lexPull(sources, addSource(sources, "bench", source, length), variant == VARIANT_PULL_INTERN);
+            break;
+
+        case VARIANT_BATCH:
+            measurement.tokens = lexBatch(sources, addSource(sources, "bench", source, length));
+            break;
+
+        case VARIANT_STREAM:
+            measurement.tokens = lexStream(path);
+            break;
+
+        case VARIANT_KEYWORDS_TRIE:
+            measurement.tokens = classifyWords(source, KEYWORD_LOOKUP_TRIE);
+            break;
+
+        case VARIANT_KEYWORDS_HASH:
+            measurement.tokens = classifyWords(source, KEYWORD_LOOKUP_HASH);
+            break;
+
+        default:
+            measurement.tokens = lexBatch(sources, loadSource(sources, path));
+            break;
+    }
+    deleteSourceManager(& sources);
+
+    // Every run interns the identifiers of the corpus from scratch instead of finding them interned by the previous run
+    deleteGlobalInterner();
+    measurement.seconds = now() - start;
+
+    return measurement;
+}
+
+
+static size_t lexPull(struct SourceManager * const sources, uint16_t file, bool intern) {
+    struct Lexer * lexer = newLexer(sources, file);
+    size_t tokens = 0;
+
+    for (;;) {
+        struct Token token = lexToken(lexer);
+        tokens++;
+
+        if (token.type == AVL_ERROR) {
+            fprintf(stderr, "Line %u: %s\n", (unsigned) sourcePosition(sources, file, token.offset).line, lexer -> error);
+            exit(65);
+        }
+
+        // Batch lexing interns identifiers so pulling them has to as well for the two to be compared
+        if (intern && token.type == AVL_IDENTIFIER)
+            internHashed(globalInterner(), lexer -> source + token.offset, token.length, lexer -> identifier_hash);
+
+        if (token.type == AVL_EOF)
+            break;
+    }
+
+    deleteLexer(& lexer);
+    return tokens;
+}
+
+
+static size_t lexBatch(struct SourceManager * const sources, uint16_t file) {
+    struct Lexer * lexer = newLexer(sources, file);
+    struct TokenBuffer * buffer = lexTokens(lexer);
+    size_t tokens = tokenBufferSize(buffer);
+
+    deleteTokenBuffer(& buffer);
+    deleteLexer(& lexer);
+    return tokens;
+}
+
+
+static size_t lexStream(char const * path) {
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) {
+        fprintf(stderr, "Failed to open file <%s>.\n", path);
+        exit(74);
+    }
+
+    struct StreamLexer * stream = newStreamLexer(descriptor, path, "Ran out of memory while streaming the corpus.");
+    size_t tokens = 0;
+
+    for (;;) {
+        struct Token token = streamToken(stream);
+        tokens++;
+
+        if (token.type == AVL_ERROR) {
+            fprintf(stderr, "Line %u: %s\n", (unsigned) streamPosition(stream, & token).line, stream -> lexer -> error);
+            exit(65);
+        }
+
+        if (token.type == AVL_EOF)
+            break;
+    }
+
+    // No line of the corpora comes close to the size of the window so a window that grew means the stream was held in memory
+    if (stream -> capacity > STREAM_CHUNKS * STREAM_CHUNK_SIZE) {
+        fprintf(stderr, "The stream window grew to %zu bytes.\n", stream -> capacity);
+        exit(70);
+    }
+
+    deleteStreamLexer(& stream);
+    close(descriptor);
+    return tokens;
+}
+
+
+/**
+ * Returns the peak resident set size of the current process in kilobytes.
+ */
+static size_t peakResidentSetSize(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, & usage);
+
+#if defined(__APPLE__)
+    // macOS reports bytes where Linux reports kilobytes
+    return (size_t) usage.ru_maxrss / 1024;
+#else
+    return (size_t) usage.ru_maxrss;
+#endif
+}
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, & time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
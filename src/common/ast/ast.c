@@ -0,0 +1,196 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "common/ast/ast.h"
+#include "utils/vector.h"
+
+
+_Static_assert(NODE_KINDS_COUNT <= UINT8_MAX, "Node kinds must fit in a single byte to be stored in a syntax tree.");
+
+static void astGrow(struct Ast * const ast);
+
+extern inline size_t astSize(struct Ast const * const ast);
+extern inline enum NodeKind astKind(struct Ast const * const ast, uint32_t node);
+extern inline uint32_t astToken(struct Ast const * const ast, uint32_t node);
+extern inline uint32_t astChildrenCount(struct Ast const * const ast, uint32_t node);
+extern inline uint32_t const * astChildren(struct Ast const * const ast, uint32_t node);
+
+static char const * const node_kinds[NODE_KINDS_COUNT] = {
+    [NODE_IMPORT]       = "NODE_IMPORT",
+    [NODE_VALUE]        = "NODE_VALUE",
+    [NODE_VARIABLE]     = "NODE_VARIABLE",
+    [NODE_LITERAL]      = "NODE_LITERAL",
+    [NODE_IDENTIFIER]   = "NODE_IDENTIFIER",
+    [NODE_UNARY]        = "NODE_UNARY",
+    [NODE_BINARY]       = "NODE_BINARY",
+    [NODE_CALL]         = "NODE_CALL",
+    [NODE_SUBSCRIPT]    = "NODE_SUBSCRIPT",
+};
+
+
+/**
+ * Initializes the syntax tree.
+ *
+ * @param       initial_capacity the number of nodes the tree can hold before growing.
+ * @param       message error message to display in case any operation on the tree fails.
+ *
+ * @return      the newly created syntax tree.
+ */
+struct Ast * newAst(size_t initial_capacity, char const * message) {
+    if (initial_capacity == 0)
+        goto exit;
+
+    struct Ast * ast = malloc(sizeof *ast);
+    if (ast == NULL)
+        goto exit;
+
+    ast -> kinds = malloc(initial_capacity * sizeof *ast -> kinds);
+    ast -> tokens = malloc(initial_capacity * sizeof *ast -> tokens);
+    ast -> first_child = malloc(initial_capacity * sizeof *ast -> first_child);
+    ast -> children_count = malloc(initial_capacity * sizeof *ast -> children_count);
+    if (ast -> kinds == NULL || ast -> tokens == NULL || ast -> first_child == NULL || ast -> children_count == NULL)
+        goto exit;
+    ast -> capacity = initial_capacity;
+    ast -> size = 0;
+
+    // Most nodes have one or two children
+    ast -> children = newUint32Vector(2 * initial_capacity, message);
+    ast -> message = message;
+
+    return ast;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newAst.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the syntax tree.
+ *
+ * @param       ast pointer to memory occupied by the syntax tree.
+ */
+void deleteAst(struct Ast ** const ast) {
+    if (ast == NULL)
+        return;
+
+    if (* ast == NULL)
+        return;
+
+    free((* ast) -> kinds);
+    free((* ast) -> tokens);
+    free((* ast) -> first_child);
+    free((* ast) -> children_count);
+    deleteUint32Vector(& (* ast) -> children);
+    free(* ast);
+    * ast = NULL;
+}
+
+
+/**
+ * Appends a new node to the syntax tree.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       kind the kind of the node.
+ * @param       token index in the token buffer of the token the node originates from.
+ * @param       children the indices of the children of the node, all of them already in the tree.
+ * @param       count the number of children.
+ *
+ * @return      the index of the new node.
+ */
+uint32_t astAppend(struct Ast * const ast, enum NodeKind kind, uint32_t token, uint32_t const * children, size_t count) {
+    char const * message = "The parameter <ast> cannot be NULL.";
+    if (ast == NULL)
+        goto exit;
+
+    // Node indices and child ranges are stored on 32 bits, with the largest index reserved for NO_NODE
+    if (ast -> size >= NO_NODE || uint32VectorSize(ast -> children) + count >= UINT32_MAX)
+        goto exit;
+
+    if (ast -> size == ast -> capacity)
+        astGrow(ast);
+
+    size_t node = ast -> size++;
+    ast -> kinds[node] = (uint8_t) kind;
+    ast -> tokens[node] = token;
+    ast -> first_child[node] = (uint32_t) uint32VectorSize(ast -> children);
+    ast -> children_count[node] = (uint32_t) count;
+    uint32VectorAppend(ast -> children, children, count);
+
+    return (uint32_t) node;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: astAppend.\nMessage: %s\n", __FILE__, __LINE__, ast ? ast -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the name of the given node kind.
+ *
+ * @param       kind the node kind.
+ *
+ * @return      the name of the node kind.
+ */
+char const * nodeKindToString(enum NodeKind kind) {
+    if (kind >= NODE_KINDS_COUNT)
+        return "NODE_UNKNOWN";
+
+    return node_kinds[kind];
+}
+
+
+/**
+ * Doubles the capacity of every node array of the syntax tree.
+ *
+ * @param       ast pointer to the syntax tree.
+ */
+static void astGrow(struct Ast * const ast) {
+    size_t new_capacity = 2 * ast -> capacity;
+
+    uint8_t * kinds = realloc(ast -> kinds, new_capacity * sizeof *kinds);
+    if (kinds == NULL)
+        goto exit;
+    ast -> kinds = kinds;
+
+    uint32_t * tokens = realloc(ast -> tokens, new_capacity * sizeof *tokens);
+    if (tokens == NULL)
+        goto exit;
+    ast -> tokens = tokens;
+
+    uint32_t * first_child = realloc(ast -> first_child, new_capacity * sizeof *first_child);
+    if (first_child == NULL)
+        goto exit;
+    ast -> first_child = first_child;
+
+    uint32_t * children_count = realloc(ast -> children_count, new_capacity * sizeof *children_count);
+    if (children_count == NULL)
+        goto exit;
+    ast -> children_count = children_count;
+
+    ast -> capacity = new_capacity;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: astGrow.\nMessage: %s\n", __FILE__, __LINE__, ast -> message);
+    exit(74);
+}
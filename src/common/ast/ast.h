@@ -0,0 +1,176 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_AST_AST_H
+#define COMMON_AST_AST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "utils/vector.h"
+
+
+/* Marks the absence of a node, such as the result of parsing nothing. Node indices start at 0 so the largest index is reserved. */
+#define NO_NODE UINT32_MAX
+
+/* The kinds of nodes of the syntax tree. */
+enum NodeKind {
+    /* declarations */
+    NODE_IMPORT = 0,            // import a.b.c: the children are the identifiers of the imported FQN
+    NODE_VALUE,                 // val name = expression: the children are the name and the initializer
+    NODE_VARIABLE,              // var name = expression: the children are the name and the initializer
+
+    /* expressions */
+    NODE_LITERAL,               // a string or a number
+    NODE_IDENTIFIER,            // a name
+    NODE_UNARY,                 // a prefix operator applied to its only child
+    NODE_BINARY,                // an infix operator, including member access, applied to its left then right children
+    NODE_CALL,                  // the first child is the callee and the others the arguments
+    NODE_SUBSCRIPT,             // the first child is the subscripted expression and the others the indices
+
+    NODE_KINDS_COUNT
+};
+
+/* The syntax tree of a program stored as a structure of arrays.
+ * A node is identified by its index and is made of its kind, the index of its main token in the token buffer of the program and a range of children.
+ * The children of a node are the node indices children[first_child[node]] to children[first_child[node] + children_count[node] - 1].
+ *
+ * Nodes refer to other nodes and to tokens by index only so the tree can be written out or mapped back in without fixing up any pointer.
+ * Nodes are appended after their children so walking the node arrays front to back visits the tree in post-order.
+ */
+struct Ast {
+    uint8_t * kinds;
+    uint32_t * tokens;
+    uint32_t * first_child;
+    uint32_t * children_count;
+    size_t capacity;
+    size_t size;
+
+    struct Uint32Vector * children;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes the syntax tree.
+ *
+ * @param       initial_capacity the number of nodes the tree can hold before growing.
+ * @param       message error message to display in case any operation on the tree fails.
+ *
+ * @return      the newly created syntax tree.
+ */
+struct Ast * newAst(size_t initial_capacity, char const * message);
+
+
+/**
+ * Frees the memory occupied by the syntax tree.
+ *
+ * @param       ast pointer to memory occupied by the syntax tree.
+ */
+void deleteAst(struct Ast ** const ast);
+
+
+/**
+ * Appends a new node to the syntax tree.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       kind the kind of the node.
+ * @param       token index in the token buffer of the token the node originates from.
+ * @param       children the indices of the children of the node, all of them already in the tree.
+ * @param       count the number of children.
+ *
+ * @return      the index of the new node.
+ */
+uint32_t astAppend(struct Ast * const ast, enum NodeKind kind, uint32_t token, uint32_t const * children, size_t count);
+
+
+/**
+ * Returns the name of the given node kind.
+ *
+ * @param       kind the node kind.
+ *
+ * @return      the name of the node kind.
+ */
+char const * nodeKindToString(enum NodeKind kind);
+
+
+/**
+ * Return the number of nodes in the syntax tree.
+ *
+ * @param       ast pointer to the syntax tree.
+ *
+ * @return      the number of nodes.
+ */
+inline size_t astSize(struct Ast const * const ast) {
+    return ast -> size;
+}
+
+
+/**
+ * Returns the kind of the given node.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       node index of the node.
+ *
+ * @return      the kind of the node.
+ */
+inline enum NodeKind astKind(struct Ast const * const ast, uint32_t node) {
+    return (enum NodeKind) ast -> kinds[node];
+}
+
+
+/**
+ * Returns the index of the token the given node originates from.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       node index of the node.
+ *
+ * @return      the index of the token in the token buffer of the program.
+ */
+inline uint32_t astToken(struct Ast const * const ast, uint32_t node) {
+    return ast -> tokens[node];
+}
+
+
+/**
+ * Returns the number of children of the given node.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       node index of the node.
+ *
+ * @return      the number of children.
+ */
+inline uint32_t astChildrenCount(struct Ast const * const ast, uint32_t node) {
+    return ast -> children_count[node];
+}
+
+
+/**
+ * Returns the children of the given node as a contiguous array of node indices.
+ * The array is invalidated by the next append to the tree.
+ *
+ * @param       ast pointer to the syntax tree.
+ * @param       node index of the node.
+ *
+ * @return      the indices of the children of the node.
+ */
+inline uint32_t const * astChildren(struct Ast const * const ast, uint32_t node) {
+    return uint32VectorData(ast -> children) + ast -> first_child[node];
+}
+
+#endif
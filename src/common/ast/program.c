@@ -17,9 +17,21 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 
+#include <stdint.h>
+#include <stddef.h>
+
 #include "common/ast/program.h"
+#include "common/token_buffer.h"
+#include "common/interner.h"
+#include "common/ast/ast.h"
+#include "utils/vector.h"
+
+
+/* Number of nodes the syntax tree of a program can hold before growing. */
+#define AST_INITIAL_CAPACITY 1024
 
 
 /**
@@ -36,7 +48,9 @@ struct Program * newProgram(char const * fqn_path, char const * message) {
         goto exit;
 
     program -> fqn = fqnFromPath(fqn_path, message);
-    program -> declarations = newVector(50, message);
+    program -> tokens = NULL;
+    program -> ast = newAst(AST_INITIAL_CAPACITY, message);
+    program -> declarations = newUint32Vector(0, message);
     program -> message = message;
     return program;
 
@@ -47,8 +61,7 @@ exit:
 
 
 /**
- * Free the memory used by a program and associated data structures.
- * It doesn't free the memory occupied by declarations contained in the program. If that is what you wish to do, please use deepDeleteProgram().
+ * Free the memory used by a program and associated data structures, including its tokens and its syntax tree.
  *
  * @param       program the program to free from memory.
  */
@@ -60,7 +73,9 @@ void deleteProgram(struct Program ** const program) {
         return;
 
     deleteFQN(& (* program) -> fqn);
-    deleteVector(& (* program) -> declarations);
+    deleteTokenBuffer(& (* program) -> tokens);
+    deleteAst(& (* program) -> ast);
+    deleteUint32Vector(& (* program) -> declarations);
     free(* program);
     * program = NULL;
 }
@@ -68,6 +83,7 @@ void deleteProgram(struct Program ** const program) {
 
 /**
  * Free the memory used the program, associated data structures and the memory occupied by all declarations contained within the program.
+ * Since declarations are nodes of the program syntax tree, this does not walk them: releasing the tree frees them all at once.
  *
  * @param       program the program to free from memory including the declarations it contains.
  */
@@ -78,15 +94,8 @@ void deepDeleteProgram(struct Program ** const program) {
     if (* program == NULL)
         return;
 
-    // Before deleting declarations, we make sure to free the memory held by each individual declaration
-    size_t declarations_count = vectorSize((* program) -> declarations);
-    while (declarations_count > 0)
-        ;
-
-    deleteFQN(& (* program) -> fqn);
-    deleteVector(& (* program) -> declarations);
-    free(* program);
-    * program = NULL;
+    // Declarations and everything below them live in the program syntax tree so we drop it as a whole instead of visiting each declaration
+    deleteProgram(program);
 }
 
 
@@ -130,3 +139,178 @@ exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setFQN.\nMessage: %s\n", __FILE__, __LINE__, program ? program -> message : message);
     exit(74);
 }
+
+
+/**
+ * Gives the token buffer the syntax tree of this program refers to, to the program.
+ * We return the old token buffer and expect the user to free the memory used by it.
+ *
+ * @param       program the program which tokens to set.
+ * @param       tokens the tokens of the source of the program, owned by the program from now on.
+ *
+ * @return      the old token buffer.
+ */
+struct TokenBuffer * setProgramTokens(struct Program * const program, struct TokenBuffer * const tokens) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    struct TokenBuffer * old_tokens = program -> tokens;
+    program -> tokens = tokens;
+    return old_tokens;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setProgramTokens.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the tokens of the source of this program.
+ *
+ * @param       program the program which tokens to return.
+ *
+ * @return      this program tokens, NULL if they were not set yet.
+ */
+struct TokenBuffer * programTokens(struct Program const * const program) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    return program -> tokens;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: programTokens.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the syntax tree of this program.
+ *
+ * @param       program the program which syntax tree to return.
+ *
+ * @return      this program syntax tree.
+ */
+struct Ast * programAst(struct Program const * const program) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    return program -> ast;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: programAst.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Appends a top level declaration to this program.
+ *
+ * @param       program the program to add the declaration to.
+ * @param       declaration the index of the declaration node in the program syntax tree.
+ */
+void addDeclaration(struct Program * const program, uint32_t declaration) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    // Only nodes of this program syntax tree can be declarations of this program
+    if (declaration >= astSize(program -> ast))
+        goto exit;
+
+    uint32VectorPushback(program -> declarations, declaration);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: addDeclaration.\nMessage: %s\n", __FILE__, __LINE__, program ? program -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of top level declarations of this program.
+ *
+ * @param       program the program which declarations to count.
+ *
+ * @return      the number of declarations.
+ */
+size_t declarationsCount(struct Program const * const program) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    return uint32VectorSize(program -> declarations);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: declarationsCount.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the top level declarations of this program as a contiguous array of node indices, in source order.
+ *
+ * @param       program the program which declarations to return.
+ *
+ * @return      the indices of the declarations in the program syntax tree.
+ */
+uint32_t const * programDeclarations(struct Program const * const program) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    return uint32VectorData(program -> declarations);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: programDeclarations.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the dotted name of the module imported by an import declaration of this program, such as a.b.c.
+ *
+ * @param       program the program the import declaration belongs to.
+ * @param       import the import declaration node, which children are the identifiers of the imported FQN.
+ *
+ * @return      the name of the imported module, to be freed by the caller.
+ */
+char * programImportName(struct Program const * const program, uint32_t import) {
+    char const * message = "The parameter <program> cannot be a null pointer";
+    if (program == NULL)
+        goto exit;
+
+    message = "The given node is not an import declaration.";
+    if (import >= astSize(program -> ast) || astKind(program -> ast, import) != NODE_IMPORT)
+        goto exit;
+
+    // We rebuild the dotted name of the module from the symbols of its identifiers
+    struct Interner * interner = globalInterner();
+    uint32_t const * names = astChildren(program -> ast, import);
+    uint32_t names_count = astChildrenCount(program -> ast, import);
+    size_t length = 0;
+    for (uint32_t i = 0; i < names_count; i++)
+        length += symbolLength(interner, tokenBufferSymbol(program -> tokens, astToken(program -> ast, names[i]))) + 1;
+
+    message = program -> message;
+    char * name = malloc(length > 0 ? length : 1);
+    if (name == NULL)
+        goto exit;
+
+    char * end = name;
+    * end = '\0';
+    for (uint32_t i = 0; i < names_count; i++) {
+        uint32_t symbol = tokenBufferSymbol(program -> tokens, astToken(program -> ast, names[i]));
+        memcpy(end, symbolString(interner, symbol), symbolLength(interner, symbol));
+        end += symbolLength(interner, symbol);
+        * end++ = i + 1 < names_count ? '.' : '\0';
+    }
+
+    return name;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: programImportName.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
@@ -19,6 +19,10 @@
 #ifndef COMMON_AST_PROGRAM_H
 #define COMMON_AST_PROGRAM_H
 
+#include <stdint.h>
+
+#include "common/token_buffer.h"
+#include "common/ast/ast.h"
 #include "utils/vector.h"
 #include "common/fqn.h"
 
@@ -27,8 +31,14 @@ struct Program {
     /* The FQN represents the fully qualified name of this program and allows us to derive the location of the source program from the file system. */
     struct FQN * fqn;
 
-    /* A vector of all the declarations in this program */
-    struct Vector * declarations;
+    /* The tokens of the source of this program, the syntax tree refers to them by index. */
+    struct TokenBuffer * tokens;
+
+    /* The syntax tree of this program, holding the declarations and every node below them. */
+    struct Ast * ast;
+
+    /* The indices in the syntax tree of the top level declarations of this program, in source order. */
+    struct Uint32Vector * declarations;
 
     /* The message to show in case an operation on this structure fails. */
     char const * message;
@@ -47,8 +57,7 @@ struct Program * newProgram(char const * fqn_path, char const * message);
 
 
 /**
- * Free the memory used by a program and associated data structures.
- * It doesn't free the memory occupied by declarations contained in the program. If that is what you wish to do, please use deepDeleteProgram().
+ * Free the memory used by a program and associated data structures, including its tokens and its syntax tree.
  *
  * @param       program the program to free from memory.
  */
@@ -57,6 +66,7 @@ void deleteProgram(struct Program ** const program);
 
 /**
  * Free the memory used the program, associated data structures and the memory occupied by all declarations contained within the program.
+ * Since declarations are nodes of the program syntax tree, this does not walk them: releasing the tree frees them all at once.
  *
  * @param       program the program to free from memory including the declarations it contains.
  */
@@ -82,4 +92,76 @@ struct FQN * setFQN(struct Program * const program, struct FQN * const fqn);
  */
 struct FQN * getFQN(struct Program const * const program);
 
+
+/**
+ * Gives the token buffer the syntax tree of this program refers to, to the program.
+ * We return the old token buffer and expect the user to free the memory used by it.
+ *
+ * @param       program the program which tokens to set.
+ * @param       tokens the tokens of the source of the program, owned by the program from now on.
+ *
+ * @return      the old token buffer.
+ */
+struct TokenBuffer * setProgramTokens(struct Program * const program, struct TokenBuffer * const tokens);
+
+
+/**
+ * Returns the tokens of the source of this program.
+ *
+ * @param       program the program which tokens to return.
+ *
+ * @return      this program tokens, NULL if they were not set yet.
+ */
+struct TokenBuffer * programTokens(struct Program const * const program);
+
+
+/**
+ * Returns the syntax tree of this program.
+ *
+ * @param       program the program which syntax tree to return.
+ *
+ * @return      this program syntax tree.
+ */
+struct Ast * programAst(struct Program const * const program);
+
+
+/**
+ * Appends a top level declaration to this program.
+ *
+ * @param       program the program to add the declaration to.
+ * @param       declaration the index of the declaration node in the program syntax tree.
+ */
+void addDeclaration(struct Program * const program, uint32_t declaration);
+
+
+/**
+ * Returns the number of top level declarations of this program.
+ *
+ * @param       program the program which declarations to count.
+ *
+ * @return      the number of declarations.
+ */
+size_t declarationsCount(struct Program const * const program);
+
+
+/**
+ * Returns the top level declarations of this program as a contiguous array of node indices, in source order.
+ *
+ * @param       program the program which declarations to return.
+ *
+ * @return      the indices of the declarations in the program syntax tree.
+ */
+uint32_t const * programDeclarations(struct Program const * const program);
+
+
+/**
+ * Returns the dotted name of the module imported by an import declaration of this program, such as a.b.c.
+ *
+ * @param       program the program the import declaration belongs to.
+ * @param       import the import declaration node, which children are the identifiers of the imported FQN.
+ *
+ * @return      the name of the imported module, to be freed by the caller.
+ */
+char * programImportName(struct Program const * const program, uint32_t import);
+
 #endif
@@ -0,0 +1,281 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/bitvector.h"
+
+
+static uint64_t readLimb(struct BitVector const * const bits, size_t from);
+
+extern inline size_t bitVectorLimbs(size_t width);
+extern inline struct BitVector bitVectorView(uint64_t * limbs, size_t width);
+extern inline bool bitVectorGet(struct BitVector const * const bits, size_t index);
+extern inline void bitVectorSet(struct BitVector * const bits, size_t index, bool value);
+
+
+/**
+ * Initializes a bit vector with all its bits cleared.
+ *
+ * @param       width the number of bits in the vector.
+ * @param       message error message to display in case any operation on the vector fails.
+ *
+ * @return      the newly created bit vector.
+ */
+struct BitVector * newBitVector(size_t width, char const * message) {
+    struct BitVector * bits = malloc(sizeof *bits);
+    if (bits == NULL)
+        goto exit;
+
+    // An empty vector still gets a limb so its limbs are never NULL
+    size_t count = bitVectorLimbs(width);
+    bits -> limbs = calloc(count > 0 ? count : 1, sizeof *bits -> limbs);
+    if (bits -> limbs == NULL)
+        goto exit;
+    bits -> width = width;
+    bits -> message = message;
+
+    return bits;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newBitVector.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by a bit vector created with newBitVector().
+ *
+ * @param       bits pointer to memory occupied by the bit vector.
+ */
+void deleteBitVector(struct BitVector ** const bits) {
+    if (bits == NULL)
+        return;
+
+    if (* bits == NULL)
+        return;
+
+    free((* bits) -> limbs);
+    free(* bits);
+    * bits = NULL;
+}
+
+
+/**
+ * Returns the number of bits set in the bit vector.
+ *
+ * @param       bits pointer to the bit vector.
+ *
+ * @return      the number of bits set.
+ */
+size_t bitVectorPopcount(struct BitVector const * const bits) {
+    char const * message = "The parameter <bits> cannot be NULL.";
+    if (bits == NULL)
+        goto exit;
+
+    size_t count = 0;
+    size_t limbs = bitVectorLimbs(bits -> width);
+    for (size_t i = 0; i < limbs; i++)
+        count += (size_t) __builtin_popcountll(bits -> limbs[i]);
+
+    return count;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorPopcount.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the parity of the bit vector.
+ *
+ * @param       bits pointer to the bit vector.
+ *
+ * @return      true if an odd number of bits are set, false otherwise.
+ */
+bool bitVectorParity(struct BitVector const * const bits) {
+    char const * message = "The parameter <bits> cannot be NULL.";
+    if (bits == NULL)
+        goto exit;
+
+    // The parity of the whole vector is the parity of the exclusive or of its limbs
+    uint64_t folded = 0;
+    size_t limbs = bitVectorLimbs(bits -> width);
+    for (size_t i = 0; i < limbs; i++)
+        folded ^= bits -> limbs[i];
+
+    return __builtin_parityll(folded) != 0;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorParity.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Copies a run of consecutive bits of a bit vector into another bit vector, which width tells how many bits are copied.
+ * Fails early if the run goes past the end of the source.
+ *
+ * @param       slice pointer to the bit vector to copy the bits into, it must not share limbs with the source.
+ * @param       bits pointer to the bit vector to copy the bits from.
+ * @param       from the index of the first bit to copy.
+ */
+void bitVectorSlice(struct BitVector * const slice, struct BitVector const * const bits, size_t from) {
+    char const * message = "The parameters <slice> and <bits> cannot be NULL.";
+    if (slice == NULL || bits == NULL)
+        goto exit;
+
+    // If the run is not within the source bounds, we fail early
+    message = bits -> message;
+    if (slice -> width > bits -> width || from > bits -> width - slice -> width)
+        goto exit;
+
+    size_t limbs = bitVectorLimbs(slice -> width);
+    for (size_t i = 0; i < limbs; i++)
+        slice -> limbs[i] = readLimb(bits, from + 64 * i);
+
+    // The source bits past the end of the run landed in the last limb and must be cleared
+    if (slice -> width % 64 != 0)
+        slice -> limbs[limbs - 1] &= (UINT64_C(1) << (slice -> width % 64)) - 1;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorSlice.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Writes the concatenation of two bit vectors into a third one, the bits of the low vector first then those of the high vector above them.
+ * Fails early if the width of the result is not the sum of the widths of the others.
+ *
+ * @param       result pointer to the bit vector to write the concatenation into, it must not share limbs with the others.
+ * @param       high pointer to the bit vector that makes the most significant bits of the result.
+ * @param       low pointer to the bit vector that makes the least significant bits of the result.
+ */
+void bitVectorConcat(struct BitVector * const result, struct BitVector const * const high, struct BitVector const * const low) {
+    char const * message = "The parameters <result>, <high> and <low> cannot be NULL.";
+    if (result == NULL || high == NULL || low == NULL)
+        goto exit;
+
+    message = result -> message;
+    if (high -> width > SIZE_MAX - low -> width || result -> width != high -> width + low -> width)
+        goto exit;
+
+    // The low vector is copied limb for limb, the bits of its last limb past its width are zero so the high vector is or-ed in above them
+    size_t limbs = bitVectorLimbs(result -> width);
+    size_t low_limbs = bitVectorLimbs(low -> width);
+    if (low_limbs > 0)
+        memcpy(result -> limbs, low -> limbs, low_limbs * sizeof *result -> limbs);
+    if (limbs > low_limbs)
+        memset(result -> limbs + low_limbs, 0, (limbs - low_limbs) * sizeof *result -> limbs);
+
+    size_t base = low -> width / 64;
+    unsigned shift = (unsigned) (low -> width % 64);
+    size_t high_limbs = bitVectorLimbs(high -> width);
+    for (size_t i = 0; i < high_limbs; i++) {
+        result -> limbs[base + i] |= high -> limbs[i] << shift;
+        if (shift > 0 && base + i + 1 < limbs)
+            result -> limbs[base + i + 1] |= high -> limbs[i] >> (64 - shift);
+    }
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorConcat.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Compares two bit vectors as unsigned integers, bit vectors with the same value are ordered by width.
+ *
+ * @param       left pointer to the first bit vector.
+ * @param       right pointer to the second bit vector.
+ *
+ * @return      a negative number, zero or a positive number if the first bit vector is less than, equal to or greater than the second.
+ */
+int bitVectorCompare(struct BitVector const * const left, struct BitVector const * const right) {
+    char const * message = "The parameters <left> and <right> cannot be NULL.";
+    if (left == NULL || right == NULL)
+        goto exit;
+
+    // The limbs a vector does not have are zero, as its value goes
+    size_t left_limbs = bitVectorLimbs(left -> width);
+    size_t right_limbs = bitVectorLimbs(right -> width);
+    for (size_t i = left_limbs > right_limbs ? left_limbs : right_limbs; i > 0; i--) {
+        uint64_t left_limb = i <= left_limbs ? left -> limbs[i - 1] : 0;
+        uint64_t right_limb = i <= right_limbs ? right -> limbs[i - 1] : 0;
+        if (left_limb != right_limb)
+            return left_limb < right_limb ? -1 : 1;
+    }
+
+    return (left -> width > right -> width) - (left -> width < right -> width);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorCompare.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Checks whether two bit vectors have the same width and the same bits.
+ *
+ * @param       left pointer to the first bit vector.
+ * @param       right pointer to the second bit vector.
+ *
+ * @return      true if the bit vectors are equal, false otherwise.
+ */
+bool bitVectorEqual(struct BitVector const * const left, struct BitVector const * const right) {
+    char const * message = "The parameters <left> and <right> cannot be NULL.";
+    if (left == NULL || right == NULL)
+        goto exit;
+
+    if (left -> width != right -> width)
+        return false;
+
+    size_t limbs = bitVectorLimbs(left -> width);
+    return limbs == 0 || memcmp(left -> limbs, right -> limbs, limbs * sizeof *left -> limbs) == 0;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: bitVectorEqual.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the 64 bits of a bit vector that begin at the given index, the bits past the last limb being zero.
+ *
+ * @param       bits pointer to the bit vector.
+ * @param       from the index of the first bit, which must be less than the width.
+ *
+ * @return      the bits, bit from being the least significant.
+ */
+static uint64_t readLimb(struct BitVector const * const bits, size_t from) {
+    size_t limb = from / 64;
+    unsigned shift = (unsigned) (from % 64);
+
+    uint64_t value = bits -> limbs[limb] >> shift;
+    if (shift > 0 && limb + 1 < bitVectorLimbs(bits -> width))
+        value |= bits -> limbs[limb + 1] << (64 - shift);
+
+    return value;
+}
@@ -0,0 +1,177 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_BITVECTOR_H
+#define COMMON_BITVECTOR_H
+
+#include <stdbool.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/* A bit pattern of any width, such as the value of a bitstring literal or the initial state of a quantum register.
+ *
+ * The bits are packed into 64 bits limbs, least significant limb first, and bit i is bit i % 64 of limb i / 64.
+ * The bits of the last limb beyond the width are always zero so limbs are counted, compared and copied whole, never bit by bit.
+ *
+ * A bit vector either owns its limbs, when created with newBitVector(), or views limbs that live elsewhere, when created with bitVectorView().
+ * Views let the values of literals be used where the lexer decoded them, in the word pool of a token buffer, they must not be deleted.
+ */
+struct BitVector {
+    uint64_t * limbs;
+    size_t width;
+    char const * message;
+};
+
+
+/**
+ * Initializes a bit vector with all its bits cleared.
+ *
+ * @param       width the number of bits in the vector.
+ * @param       message error message to display in case any operation on the vector fails.
+ *
+ * @return      the newly created bit vector.
+ */
+struct BitVector * newBitVector(size_t width, char const * message);
+
+
+/**
+ * Frees the memory occupied by a bit vector created with newBitVector().
+ *
+ * @param       bits pointer to memory occupied by the bit vector.
+ */
+void deleteBitVector(struct BitVector ** const bits);
+
+
+/**
+ * Returns the number of limbs it takes to hold the given number of bits.
+ *
+ * @param       width the number of bits.
+ *
+ * @return      the number of limbs.
+ */
+inline size_t bitVectorLimbs(size_t width) {
+    return width / 64 + (width % 64 != 0);
+}
+
+
+/**
+ * Returns a bit vector over limbs owned by someone else, which must outlive the view.
+ *
+ * @param       limbs the limbs, least significant first, with the bits beyond the width cleared.
+ * @param       width the number of bits in the vector.
+ *
+ * @return      the view, which must not be deleted.
+ */
+inline struct BitVector bitVectorView(uint64_t * limbs, size_t width) {
+    return (struct BitVector) { .limbs = limbs, .width = width, .message = "The bit vector view was used outside of its bounds." };
+}
+
+
+/**
+ * Returns the bit at the given index, without validating the index.
+ *
+ * @param       bits pointer to the bit vector.
+ * @param       index the index of the bit, which must be less than the width.
+ *
+ * @return      the bit.
+ */
+inline bool bitVectorGet(struct BitVector const * const bits, size_t index) {
+    assert(bits != NULL && index < bits -> width);
+    return (bits -> limbs[index / 64] >> (index % 64)) & 1;
+}
+
+
+/**
+ * Sets the bit at the given index, without validating the index.
+ *
+ * @param       bits pointer to the bit vector.
+ * @param       index the index of the bit, which must be less than the width.
+ * @param       value the new value of the bit.
+ */
+inline void bitVectorSet(struct BitVector * const bits, size_t index, bool value) {
+    assert(bits != NULL && index < bits -> width);
+    uint64_t mask = UINT64_C(1) << (index % 64);
+    bits -> limbs[index / 64] = value ? bits -> limbs[index / 64] | mask : bits -> limbs[index / 64] & ~mask;
+}
+
+
+/**
+ * Returns the number of bits set in the bit vector.
+ *
+ * @param       bits pointer to the bit vector.
+ *
+ * @return      the number of bits set.
+ */
+size_t bitVectorPopcount(struct BitVector const * const bits);
+
+
+/**
+ * Returns the parity of the bit vector.
+ *
+ * @param       bits pointer to the bit vector.
+ *
+ * @return      true if an odd number of bits are set, false otherwise.
+ */
+bool bitVectorParity(struct BitVector const * const bits);
+
+
+/**
+ * Copies a run of consecutive bits of a bit vector into another bit vector, which width tells how many bits are copied.
+ * Fails early if the run goes past the end of the source.
+ *
+ * @param       slice pointer to the bit vector to copy the bits into, it must not share limbs with the source.
+ * @param       bits pointer to the bit vector to copy the bits from.
+ * @param       from the index of the first bit to copy.
+ */
+void bitVectorSlice(struct BitVector * const slice, struct BitVector const * const bits, size_t from);
+
+
+/**
+ * Writes the concatenation of two bit vectors into a third one, the bits of the low vector first then those of the high vector above them.
+ * Fails early if the width of the result is not the sum of the widths of the others.
+ *
+ * @param       result pointer to the bit vector to write the concatenation into, it must not share limbs with the others.
+ * @param       high pointer to the bit vector that makes the most significant bits of the result.
+ * @param       low pointer to the bit vector that makes the least significant bits of the result.
+ */
+void bitVectorConcat(struct BitVector * const result, struct BitVector const * const high, struct BitVector const * const low);
+
+
+/**
+ * Compares two bit vectors as unsigned integers, bit vectors with the same value are ordered by width.
+ *
+ * @param       left pointer to the first bit vector.
+ * @param       right pointer to the second bit vector.
+ *
+ * @return      a negative number, zero or a positive number if the first bit vector is less than, equal to or greater than the second.
+ */
+int bitVectorCompare(struct BitVector const * const left, struct BitVector const * const right);
+
+
+/**
+ * Checks whether two bit vectors have the same width and the same bits.
+ *
+ * @param       left pointer to the first bit vector.
+ * @param       right pointer to the second bit vector.
+ *
+ * @return      true if the bit vectors are equal, false otherwise.
+ */
+bool bitVectorEqual(struct BitVector const * const left, struct BitVector const * const right);
+
+#endif
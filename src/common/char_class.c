@@ -0,0 +1,60 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/char_class.h"
+
+
+#define DIGIT           (CHAR_DIGIT | CHAR_HEX_DIGIT | CHAR_IDENT)
+#define LETTER          (CHAR_LETTER | CHAR_IDENT_START | CHAR_IDENT)
+#define HEX_LETTER      (LETTER | CHAR_HEX_DIGIT)
+#define UNDERSCORE      (CHAR_IDENT_START | CHAR_IDENT | CHAR_OPERATOR)
+#define OPERATOR        (CHAR_OPERATOR)
+
+
+/* The class of every byte value. Bytes outside of the ASCII range belong to no class. */
+uint16_t const char_classes[256] = {
+    ['0'] = DIGIT, ['1'] = DIGIT, ['2'] = DIGIT, ['3'] = DIGIT, ['4'] = DIGIT, ['5'] = DIGIT,
+    ['6'] = DIGIT, ['7'] = DIGIT, ['8'] = DIGIT, ['9'] = DIGIT,
+
+    ['a'] = LETTER, ['b'] = LETTER, ['c'] = LETTER, ['d'] = LETTER, ['e'] = LETTER, ['f'] = LETTER,
+    ['g'] = LETTER, ['h'] = LETTER, ['i'] = LETTER, ['j'] = LETTER, ['k'] = LETTER, ['l'] = LETTER,
+    ['m'] = LETTER, ['n'] = LETTER, ['o'] = LETTER, ['p'] = LETTER, ['q'] = LETTER, ['r'] = LETTER,
+    ['s'] = LETTER, ['t'] = LETTER, ['u'] = LETTER, ['v'] = LETTER, ['w'] = LETTER, ['x'] = LETTER,
+    ['y'] = LETTER, ['z'] = LETTER,
+
+    ['A'] = HEX_LETTER, ['B'] = HEX_LETTER, ['C'] = HEX_LETTER, ['D'] = HEX_LETTER, ['E'] = HEX_LETTER, ['F'] = HEX_LETTER,
+    ['G'] = LETTER, ['H'] = LETTER, ['I'] = LETTER, ['J'] = LETTER, ['K'] = LETTER, ['L'] = LETTER,
+    ['M'] = LETTER, ['N'] = LETTER, ['O'] = LETTER, ['P'] = LETTER, ['Q'] = LETTER, ['R'] = LETTER,
+    ['S'] = LETTER, ['T'] = LETTER, ['U'] = LETTER, ['V'] = LETTER, ['W'] = LETTER, ['X'] = LETTER,
+    ['Y'] = LETTER, ['Z'] = LETTER,
+
+    ['_'] = UNDERSCORE,
+    [' '] = CHAR_WHITESPACE, ['\t'] = CHAR_WHITESPACE, ['\r'] = CHAR_WHITESPACE,
+    ['.'] = OPERATOR | CHAR_DOT,
+    ['/'] = OPERATOR | CHAR_SLASH, ['\\'] = CHAR_SLASH,
+
+    ['!'] = OPERATOR, ['~'] = OPERATOR, ['^'] = OPERATOR, ['+'] = OPERATOR, ['-'] = OPERATOR, ['*'] = OPERATOR,
+    ['%'] = OPERATOR, ['\''] = OPERATOR, [','] = OPERATOR, [':'] = OPERATOR, ['='] = OPERATOR, ['<'] = OPERATOR,
+    ['>'] = OPERATOR, ['|'] = OPERATOR, ['&'] = OPERATOR, ['('] = OPERATOR, [')'] = OPERATOR, ['['] = OPERATOR,
+    [']'] = OPERATOR, ['{'] = OPERATOR, ['}'] = OPERATOR,
+};
+
+
+extern inline bool isCharClass(char c, uint16_t classes);
@@ -0,0 +1,55 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_CHAR_CLASS_H
+#define COMMON_CHAR_CLASS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Classes a character can belong to. A character may belong to several classes. */
+enum CharClass {
+    CHAR_DIGIT          = 1 << 0,   // 0-9
+    CHAR_HEX_DIGIT      = 1 << 1,   // 0-9 and A-F, lowercase letters are reserved for data formats such as <b> or <h>
+    CHAR_LETTER         = 1 << 2,   // a-z and A-Z
+    CHAR_IDENT_START    = 1 << 3,   // letters and underscore
+    CHAR_IDENT          = 1 << 4,   // letters, digits and underscore
+    CHAR_WHITESPACE     = 1 << 5,   // blank space, tabulation and carriage return
+    CHAR_OPERATOR       = 1 << 6,   // characters that begin an operator or a punctuation token
+    CHAR_DOT            = 1 << 7,   // the FQN name separator
+    CHAR_SLASH          = 1 << 8    // the FQN path separators, frontslash and backslash
+};
+
+
+/* The class of every byte value. Bytes outside of the ASCII range belong to no class. */
+extern uint16_t const char_classes[256];
+
+
+/**
+ * Returns true if the given character belongs to any of the given classes.
+ *
+ * @param       c the character to classify.
+ * @param       classes the classes to test, or-ed together.
+ *
+ * @return      true if the character belongs to at least one of the classes.
+ */
+inline bool isCharClass(char c, uint16_t classes) {
+    return (char_classes[(unsigned char) c] & classes) != 0;
+}
+
+#endif
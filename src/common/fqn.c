@@ -17,11 +17,14 @@
 
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
 
+#include "common/char_class.h"
+#include "common/interner.h"
 #include "common/fqn.h"
 
 static bool isAlpha(char c);
@@ -50,18 +53,20 @@ struct FQN * fqnFromName(char const * name, char const * message) {
     if (fqn == NULL)
         goto exit;
 
-    // Set up the FQN struct fields
+    // Set up the FQN struct fields, the path is built in a scratch buffer that we release once it is interned
     size_t length = strlen(name);
 
-    fqn -> name = malloc((1 + length) * sizeof *fqn -> name);
-    if (fqn -> name == NULL)
+    char * path = malloc((1 + length) * sizeof *path);
+    if (path == NULL)
         goto exit;
-    memcpy(fqn -> name, name, 1 + length);
+    pathFromName(path, name);
 
-    fqn -> path = malloc((1 + length) * sizeof *fqn -> path);
-    if (fqn -> path == NULL)
-        goto exit;
-    pathFromName(fqn -> path, name);
+    struct Interner * interner = globalInterner();
+    fqn -> name = internString(interner, name, length);
+    fqn -> path = internString(interner, path, length);
+    free(path);
+
+    return fqn;
 
 exit:
     fprintf(stderr, "%s\n", message);
@@ -86,18 +91,20 @@ struct FQN * fqnFromPath(char const * path, char const * message) {
     if (fqn == NULL)
         goto exit;
 
-    // Set up the FQN struct fields
+    // Set up the FQN struct fields, the name is built in a scratch buffer that we release once it is interned
     size_t length = strlen(path);
 
-    fqn -> name = malloc((1 + length) * sizeof *fqn -> name);
-    if (fqn -> name == NULL)
+    char * name = malloc((1 + length) * sizeof *name);
+    if (name == NULL)
         goto exit;
-    nameFromPath(fqn -> name, path);
+    nameFromPath(name, path);
 
-    fqn -> path = malloc((1 + length) * sizeof *fqn -> path);
-    if (fqn -> path == NULL)
-        goto exit;
-    memcpy(fqn -> path, path, 1 + length);
+    struct Interner * interner = globalInterner();
+    fqn -> name = internString(interner, name, length);
+    fqn -> path = internString(interner, path, length);
+    free(name);
+
+    return fqn;
 
 exit:
     fprintf(stderr, "%s\n", message);
@@ -105,6 +112,30 @@ exit:
 }
 
 
+/**
+ * Returns true if the given string can be turned into an FQN with fqnFromName, which fails on invalid names.
+ *
+ * @param       name fully qualified name.
+ *
+ * @return      true if the name contains only letters, underscores and dots.
+ */
+bool fqnIsValidName(char const * name) {
+    return isValidName(name);
+}
+
+
+/**
+ * Returns true if the given string can be turned into an FQN with fqnFromPath, which fails on invalid paths.
+ *
+ * @param       path file system path to the program.
+ *
+ * @return      true if the path contains only letters, underscores and slashes.
+ */
+bool fqnIsValidPath(char const * path) {
+    return isValidPath(path);
+}
+
+
 /**
  * Given an FQN, free the memory occupied by it and all associated structures.
  *
@@ -130,7 +161,7 @@ void deleteFQN(struct FQN ** const fqn) {
  * @return      the name of the FQN.
  */
 char const * fqnName(struct FQN const * const fqn) {
-    return fqn -> name;
+    return symbolString(globalInterner(), fqn -> name);
 }
 
 
@@ -142,6 +173,30 @@ char const * fqnName(struct FQN const * const fqn) {
  * @return      the path of the FQN.
  */
 char const * fqnPath(struct FQN const * const fqn) {
+    return symbolString(globalInterner(), fqn -> path);
+}
+
+
+/**
+ * Given the FQN struct, return the symbol its name was interned as.
+ *
+ * @param       fqn struct FQN from which to retrieve the name symbol.
+ *
+ * @return      the symbol of the name of the FQN.
+ */
+uint32_t fqnNameSymbol(struct FQN const * const fqn) {
+    return fqn -> name;
+}
+
+
+/**
+ * Given the FQN struct, return the symbol its path was interned as.
+ *
+ * @param       fqn struct FQN from which to retrieve the path symbol.
+ *
+ * @return      the symbol of the path of the FQN.
+ */
+uint32_t fqnPathSymbol(struct FQN const * const fqn) {
     return fqn -> path;
 }
 
@@ -154,7 +209,7 @@ char const * fqnPath(struct FQN const * const fqn) {
  * @return      true if the character is made of the English alphabet or an underscore, false otherwise.
  */
 static bool isAlpha(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    return isCharClass(c, CHAR_IDENT_START);
 }
 
 
@@ -166,7 +221,7 @@ static bool isAlpha(char c) {
  * @return      true if the given character is a dot.
  */
 static bool isDot(char c) {
-    return c == '.';
+    return isCharClass(c, CHAR_DOT);
 }
 
 
@@ -178,7 +233,7 @@ static bool isDot(char c) {
  * @return      true if the given character is a frontslash or a backlash.
  */
 static bool isSlash(char c) {
-    return c == '/' || c == '\\';
+    return isCharClass(c, CHAR_SLASH);
 }
 
 
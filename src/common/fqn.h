@@ -19,9 +19,14 @@
 #ifndef COMMON_FQN_H
 #define COMMON_FQN_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* The name and the path of a program are interned so FQNs are compared by symbol and repeated names share one copy. */
 struct FQN {
-    char * name;
-    char * path;
+    uint32_t name;
+    uint32_t path;
 };
 
 
@@ -47,6 +52,26 @@ struct FQN * fqnFromName(char const * name, char const * message);
 struct FQN * fqnFromPath(char const * path, char const * message);
 
 
+/**
+ * Returns true if the given string can be turned into an FQN with fqnFromName, which fails on invalid names.
+ *
+ * @param       name fully qualified name.
+ *
+ * @return      true if the name contains only letters, underscores and dots.
+ */
+bool fqnIsValidName(char const * name);
+
+
+/**
+ * Returns true if the given string can be turned into an FQN with fqnFromPath, which fails on invalid paths.
+ *
+ * @param       path file system path to the program.
+ *
+ * @return      true if the path contains only letters, underscores and slashes.
+ */
+bool fqnIsValidPath(char const * path);
+
+
 /**
  * Given an FQN, free the memory occupied by it and all associated structures.
  *
@@ -74,4 +99,24 @@ char const * fqnName(struct FQN const * const fqn);
  */
 char const * fqnPath(struct FQN const * const fqn);
 
+
+/**
+ * Given the FQN struct, return the symbol its name was interned as.
+ *
+ * @param       fqn struct FQN from which to retrieve the name symbol.
+ *
+ * @return      the symbol of the name of the FQN.
+ */
+uint32_t fqnNameSymbol(struct FQN const * const fqn);
+
+
+/**
+ * Given the FQN struct, return the symbol its path was interned as.
+ *
+ * @param       fqn struct FQN from which to retrieve the path symbol.
+ *
+ * @return      the symbol of the path of the FQN.
+ */
+uint32_t fqnPathSymbol(struct FQN const * const fqn);
+
 #endif
@@ -0,0 +1,436 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/interner.h"
+#include "utils/arena.h"
+
+
+/* Size of the arena blocks strings are copied into. Strings longer than this get a block of their own. */
+#define INTERNER_BLOCK_SIZE 65536
+
+static struct Interner * global_interner = NULL;
+static pthread_mutex_t global_interner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char const * internerStore(struct Interner * const interner, char const * string, size_t length);
+static void internerGrow(struct Interner * const interner);
+static void internerRehash(struct Interner * const interner);
+
+extern inline uint32_t symbolHash(char const * string, size_t length);
+
+
+/**
+ * Initializes the interner.
+ *
+ * @param       initial_capacity the number of symbols the interner can hold before growing.
+ * @param       message error message to display in case any operation on the interner fails.
+ *
+ * @return      the newly created interner, with the empty string already interned as NO_SYMBOL.
+ */
+struct Interner * newInterner(size_t initial_capacity, char const * message) {
+    if (initial_capacity == 0)
+        goto exit;
+
+    struct Interner * interner = malloc(sizeof *interner);
+    if (interner == NULL)
+        goto exit;
+
+    interner -> strings = malloc(initial_capacity * sizeof *interner -> strings);
+    interner -> lengths = malloc(initial_capacity * sizeof *interner -> lengths);
+    interner -> hashes = malloc(initial_capacity * sizeof *interner -> hashes);
+    if (interner -> strings == NULL || interner -> lengths == NULL || interner -> hashes == NULL)
+        goto exit;
+    interner -> capacity = initial_capacity;
+    interner -> size = 0;
+
+    // The table is kept at most half full so probe sequences stay short
+    interner -> slots_capacity = 16;
+    while (interner -> slots_capacity < 2 * initial_capacity)
+        interner -> slots_capacity *= 2;
+    interner -> slots = calloc(interner -> slots_capacity, sizeof *interner -> slots);
+    if (interner -> slots == NULL)
+        goto exit;
+
+    interner -> arena = newArena(INTERNER_BLOCK_SIZE, message);
+    interner -> message = message;
+
+    pthread_mutexattr_t attributes;
+    if (pthread_mutexattr_init(& attributes) != 0)
+        goto exit;
+    pthread_mutexattr_settype(& attributes, PTHREAD_MUTEX_RECURSIVE);
+    int error = pthread_mutex_init(& interner -> lock, & attributes);
+    pthread_mutexattr_destroy(& attributes);
+    if (error != 0)
+        goto exit;
+
+    // The empty string is symbol 0 and is never looked up through the table since NO_SYMBOL marks empty slots
+    interner -> strings[0] = "";
+    interner -> lengths[0] = 0;
+    interner -> hashes[0] = symbolHash("", 0);
+    interner -> size = 1;
+
+    return interner;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newInterner.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the interner and every string it holds.
+ *
+ * @param       interner pointer to memory occupied by the interner.
+ */
+void deleteInterner(struct Interner ** const interner) {
+    if (interner == NULL)
+        return;
+
+    if (* interner == NULL)
+        return;
+
+    pthread_mutex_destroy(& (* interner) -> lock);
+    deleteArena(& (* interner) -> arena);
+    free((* interner) -> strings);
+    free((* interner) -> lengths);
+    free((* interner) -> hashes);
+    free((* interner) -> slots);
+    free(* interner);
+    * interner = NULL;
+}
+
+
+/**
+ * Returns the interner shared by the entire compiler, creating it on first use.
+ * It can be called from any thread.
+ *
+ * @return      the global interner.
+ */
+struct Interner * globalInterner(void) {
+    pthread_mutex_lock(& global_interner_lock);
+    if (global_interner == NULL)
+        global_interner = newInterner(4096, "Ran out of memory while interning strings.");
+
+    struct Interner * interner = global_interner;
+    pthread_mutex_unlock(& global_interner_lock);
+    return interner;
+}
+
+
+/**
+ * Frees the global interner. Symbols obtained before this call must no longer be used.
+ * No other thread may use the global interner while it is freed.
+ */
+void deleteGlobalInterner(void) {
+    pthread_mutex_lock(& global_interner_lock);
+    deleteInterner(& global_interner);
+    pthread_mutex_unlock(& global_interner_lock);
+}
+
+
+/**
+ * Takes the lock of the interner so the calling thread can intern many strings in a row without contending for the lock on each of them.
+ * Every call must be matched by a call to unlockInterner().
+ *
+ * @param       interner pointer to the interner.
+ */
+void lockInterner(struct Interner * const interner) {
+    pthread_mutex_lock(& interner -> lock);
+}
+
+
+/**
+ * Releases the lock of the interner taken by lockInterner().
+ *
+ * @param       interner pointer to the interner.
+ */
+void unlockInterner(struct Interner * const interner) {
+    pthread_mutex_unlock(& interner -> lock);
+}
+
+
+/**
+ * Interns the given string.
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internString(struct Interner * const interner, char const * string, size_t length) {
+    return internHashed(interner, string, length, symbolHash(string, length));
+}
+
+
+/**
+ * Interns the given string which hash was already computed with symbolHash().
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ * @param       hash the hash of the string as returned by symbolHash().
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internHashed(struct Interner * const interner, char const * string, size_t length, uint32_t hash) {
+    char const * message = "The parameter <interner> cannot be NULL.";
+    if (interner == NULL)
+        goto exit;
+
+    pthread_mutex_lock(& interner -> lock);
+    uint32_t symbol = internLocked(interner, string, length, hash);
+    pthread_mutex_unlock(& interner -> lock);
+    return symbol;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: internHashed.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Interns the given string which hash was already computed with symbolHash(), the calling thread holding the lock taken by lockInterner().
+ * Interning many strings in a row this way saves locking the interner again for each of them.
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ * @param       hash the hash of the string as returned by symbolHash().
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internLocked(struct Interner * const interner, char const * string, size_t length, uint32_t hash) {
+    char const * message = "The parameter <interner> cannot be NULL.";
+    if (interner == NULL)
+        goto exit;
+
+    if (length == 0)
+        return NO_SYMBOL;
+
+    message = "Interned strings are limited to 4GiB.";
+    if (length > UINT32_MAX)
+        goto exit;
+
+    size_t mask = interner -> slots_capacity - 1;
+    size_t slot = hash & mask;
+    while (interner -> slots[slot] != NO_SYMBOL) {
+        uint32_t symbol = interner -> slots[slot];
+        if (interner -> hashes[symbol] == hash && interner -> lengths[symbol] == length && memcmp(interner -> strings[symbol], string, length) == 0)
+            return symbol;
+
+        slot = (slot + 1) & mask;
+    }
+
+    // The string was never seen, we copy it and give it the next symbol
+    message = "Ran out of symbols.";
+    if (interner -> size > UINT32_MAX)
+        goto exit;
+
+    if (interner -> size == interner -> capacity)
+        internerGrow(interner);
+
+    uint32_t symbol = (uint32_t) interner -> size++;
+    interner -> strings[symbol] = internerStore(interner, string, length);
+    interner -> lengths[symbol] = (uint32_t) length;
+    interner -> hashes[symbol] = hash;
+    interner -> slots[slot] = symbol;
+
+    if (2 * interner -> size > interner -> slots_capacity)
+        internerRehash(interner);
+
+    return symbol;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: internLocked.\nMessage: %s\n", __FILE__, __LINE__, interner ? interner -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the null terminated string a symbol stands for.
+ *
+ * @param       interner pointer to the interner.
+ * @param       symbol a symbol returned by this interner.
+ *
+ * @return      the interned string.
+ */
+char const * symbolString(struct Interner const * const interner, uint32_t symbol) {
+    char const * message = "The parameter <interner> cannot be NULL.";
+    if (interner == NULL)
+        goto exit;
+
+    // The arrays move when the interner grows so we read them under the lock
+    pthread_mutex_t * lock = (pthread_mutex_t *) & interner -> lock;
+    pthread_mutex_lock(lock);
+
+    message = "The given symbol does not belong to this interner.";
+    if (symbol >= interner -> size)
+        goto exit;
+
+    char const * value = interner -> strings[symbol];
+    pthread_mutex_unlock(lock);
+    return value;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: symbolString.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the length of the string a symbol stands for.
+ *
+ * @param       interner pointer to the interner.
+ * @param       symbol a symbol returned by this interner.
+ *
+ * @return      the length of the interned string.
+ */
+size_t symbolLength(struct Interner const * const interner, uint32_t symbol) {
+    char const * message = "The parameter <interner> cannot be NULL.";
+    if (interner == NULL)
+        goto exit;
+
+    // The arrays move when the interner grows so we read them under the lock
+    pthread_mutex_t * lock = (pthread_mutex_t *) & interner -> lock;
+    pthread_mutex_lock(lock);
+
+    message = "The given symbol does not belong to this interner.";
+    if (symbol >= interner -> size)
+        goto exit;
+
+    size_t value = interner -> lengths[symbol];
+    pthread_mutex_unlock(lock);
+    return value;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: symbolLength.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of symbols in the interner, the empty string included.
+ *
+ * @param       interner pointer to the interner.
+ *
+ * @return      the number of distinct strings interned.
+ */
+size_t internerSize(struct Interner const * const interner) {
+    char const * message = "The parameter <interner> cannot be NULL.";
+    if (interner == NULL)
+        goto exit;
+
+    pthread_mutex_t * lock = (pthread_mutex_t *) & interner -> lock;
+    pthread_mutex_lock(lock);
+    size_t size = interner -> size;
+    pthread_mutex_unlock(lock);
+    return size;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: internerSize.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Copies the given string into the interner arena and null terminates it.
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to copy.
+ * @param       length the number of characters to copy.
+ *
+ * @return      the stable copy of the string.
+ */
+static char const * internerStore(struct Interner * const interner, char const * string, size_t length) {
+    char * copy = arenaAllocAligned(interner -> arena, length + 1, 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+}
+
+
+/**
+ * Doubles the capacity of the symbol arrays.
+ *
+ * @param       interner pointer to the interner.
+ */
+static void internerGrow(struct Interner * const interner) {
+    size_t new_capacity = 2 * interner -> capacity;
+
+    char const ** strings = realloc(interner -> strings, new_capacity * sizeof *strings);
+    if (strings == NULL)
+        goto exit;
+    interner -> strings = strings;
+
+    uint32_t * lengths = realloc(interner -> lengths, new_capacity * sizeof *lengths);
+    if (lengths == NULL)
+        goto exit;
+    interner -> lengths = lengths;
+
+    uint32_t * hashes = realloc(interner -> hashes, new_capacity * sizeof *hashes);
+    if (hashes == NULL)
+        goto exit;
+    interner -> hashes = hashes;
+
+    interner -> capacity = new_capacity;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: internerGrow.\nMessage: %s\n", __FILE__, __LINE__, interner -> message);
+    exit(74);
+}
+
+
+/**
+ * Doubles the size of the hash table and reinserts every symbol using the hashes we kept.
+ *
+ * @param       interner pointer to the interner.
+ */
+static void internerRehash(struct Interner * const interner) {
+    size_t new_capacity = 2 * interner -> slots_capacity;
+    uint32_t * slots = calloc(new_capacity, sizeof *slots);
+    if (slots == NULL)
+        goto exit;
+
+    size_t mask = new_capacity - 1;
+    for (uint32_t symbol = 1; symbol < interner -> size; symbol++) {
+        size_t slot = interner -> hashes[symbol] & mask;
+        while (slots[slot] != NO_SYMBOL)
+            slot = (slot + 1) & mask;
+        slots[slot] = symbol;
+    }
+
+    free(interner -> slots);
+    interner -> slots = slots;
+    interner -> slots_capacity = new_capacity;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: internerRehash.\nMessage: %s\n", __FILE__, __LINE__, interner -> message);
+    exit(74);
+}
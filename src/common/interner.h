@@ -0,0 +1,201 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef COMMON_INTERNER_H
+#define COMMON_INTERNER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "utils/arena.h"
+
+/* The symbol of the empty string. Since no identifier is empty, it also stands for "no symbol" in tables indexed by token. */
+#define NO_SYMBOL 0
+
+
+/* Maps every distinct string to a 32-bit symbol.
+ * Two strings are equal if and only if their symbols are equal so later phases compare names with a single integer comparison.
+ *
+ * Symbols index the strings, lengths and hashes arrays.
+ * The slots array is an open addressing hash table (linear probing) which entries are symbols, NO_SYMBOL marking an empty slot.
+ * The characters live in an arena which blocks never move so the strings handed out remain valid for as long as the interner lives.
+ *
+ * Modules are lexed on several threads at once so every operation takes the lock of the interner.
+ * The lock is recursive: a thread about to intern many strings takes it once with lockInterner() and the operations it then calls take it again without contention.
+ */
+struct Interner {
+    char const ** strings;
+    uint32_t * lengths;
+    uint32_t * hashes;
+    size_t capacity;
+    size_t size;
+
+    uint32_t * slots;
+    size_t slots_capacity;
+
+    struct Arena * arena;
+
+    pthread_mutex_t lock;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes the interner.
+ *
+ * @param       initial_capacity the number of symbols the interner can hold before growing.
+ * @param       message error message to display in case any operation on the interner fails.
+ *
+ * @return      the newly created interner, with the empty string already interned as NO_SYMBOL.
+ */
+struct Interner * newInterner(size_t initial_capacity, char const * message);
+
+
+/**
+ * Frees the memory occupied by the interner and every string it holds.
+ *
+ * @param       interner pointer to memory occupied by the interner.
+ */
+void deleteInterner(struct Interner ** const interner);
+
+
+/**
+ * Returns the interner shared by the entire compiler, creating it on first use.
+ * It can be called from any thread.
+ *
+ * @return      the global interner.
+ */
+struct Interner * globalInterner(void);
+
+
+/**
+ * Frees the global interner. Symbols obtained before this call must no longer be used.
+ * No other thread may use the global interner while it is freed.
+ */
+void deleteGlobalInterner(void);
+
+
+/**
+ * Takes the lock of the interner so the calling thread can intern many strings in a row without contending for the lock on each of them.
+ * Every call must be matched by a call to unlockInterner().
+ *
+ * @param       interner pointer to the interner.
+ */
+void lockInterner(struct Interner * const interner);
+
+
+/**
+ * Releases the lock of the interner taken by lockInterner().
+ *
+ * @param       interner pointer to the interner.
+ */
+void unlockInterner(struct Interner * const interner);
+
+
+/**
+ * Returns the hash the interner uses for the given string.
+ * The lexer calls this while the identifier is still in cache so interning it later does not have to read it twice.
+ *
+ * @param       string the characters to hash.
+ * @param       length the number of characters to hash.
+ *
+ * @return      the 32-bit FNV-1a hash of the string.
+ */
+inline uint32_t symbolHash(char const * string, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t) string[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+/**
+ * Interns the given string.
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internString(struct Interner * const interner, char const * string, size_t length);
+
+
+/**
+ * Interns the given string which hash was already computed with symbolHash().
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ * @param       hash the hash of the string as returned by symbolHash().
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internHashed(struct Interner * const interner, char const * string, size_t length, uint32_t hash);
+
+
+/**
+ * Interns the given string which hash was already computed with symbolHash(), the calling thread holding the lock taken by lockInterner().
+ * Interning many strings in a row this way saves locking the interner again for each of them.
+ *
+ * @param       interner pointer to the interner.
+ * @param       string the characters to intern, they need not be null terminated.
+ * @param       length the number of characters to intern.
+ * @param       hash the hash of the string as returned by symbolHash().
+ *
+ * @return      the symbol of the string.
+ */
+uint32_t internLocked(struct Interner * const interner, char const * string, size_t length, uint32_t hash);
+
+
+/**
+ * Returns the null terminated string a symbol stands for.
+ *
+ * @param       interner pointer to the interner.
+ * @param       symbol a symbol returned by this interner.
+ *
+ * @return      the interned string.
+ */
+char const * symbolString(struct Interner const * const interner, uint32_t symbol);
+
+
+/**
+ * Returns the length of the string a symbol stands for.
+ *
+ * @param       interner pointer to the interner.
+ * @param       symbol a symbol returned by this interner.
+ *
+ * @return      the length of the interned string.
+ */
+size_t symbolLength(struct Interner const * const interner, uint32_t symbol);
+
+
+/**
+ * Returns the number of symbols in the interner, the empty string included.
+ *
+ * @param       interner pointer to the interner.
+ *
+ * @return      the number of distinct strings interned.
+ */
+size_t internerSize(struct Interner const * const interner);
+
+#endif
@@ -0,0 +1,128 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "common/line_table.h"
+#include "lexer/scan.h"
+
+
+/**
+ * Builds the line table of the given source.
+ *
+ * @param       source the null terminated source, offsets are relative to its beginning.
+ * @param       message error message to display in case any operation on the table fails.
+ *
+ * @return      the newly created line table.
+ */
+struct LineTable * newLineTable(char const * source, char const * message) {
+    if (source == NULL)
+        goto exit;
+
+    struct LineTable * table = malloc(sizeof *table);
+    if (table == NULL)
+        goto exit;
+
+    // The new lines are counted in a first pass so the second pass records where the lines begin straight into an array of the right size
+    table -> count = scanNewlines(source, source, NULL) + 1;
+    table -> starts = malloc(table -> count * sizeof *table -> starts);
+    if (table -> starts == NULL)
+        goto exit;
+
+    table -> starts[0] = 0;
+    scanNewlines(source, source, table -> starts + 1);
+
+    return table;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newLineTable.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the line table.
+ *
+ * @param       table pointer to memory occupied by the line table.
+ */
+void deleteLineTable(struct LineTable ** const table) {
+    if (table == NULL)
+        return;
+
+    if (* table == NULL)
+        return;
+
+    free((* table) -> starts);
+    free(* table);
+    * table = NULL;
+}
+
+
+/**
+ * Returns the number of lines in the table.
+ *
+ * @param       table the line table.
+ *
+ * @return      the number of lines.
+ */
+size_t lineTableSize(struct LineTable const * const table) {
+    char const * message = "The parameter <table> cannot be NULL.";
+    if (table == NULL)
+        goto exit;
+
+    return table -> count;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: lineTableSize.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the line and column of the byte at the given offset.
+ *
+ * @param       table the line table of the source the offset is relative to.
+ * @param       offset the offset of the byte.
+ *
+ * @return      the position of the byte.
+ */
+struct SourcePosition lineTablePosition(struct LineTable const * const table, uint32_t offset) {
+    char const * message = "The parameter <table> cannot be NULL.";
+    if (table == NULL)
+        goto exit;
+
+    // We look for the last line that begins at or before the offset, the first line begins at 0 so there always is one
+    uint32_t const * starts = table -> starts;
+    size_t low = 1;
+    size_t high = table -> count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (starts[middle] <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return (struct SourcePosition) { .line = (uint32_t) low, .column = offset - starts[low - 1] + 1 };
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: lineTablePosition.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
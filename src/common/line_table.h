@@ -0,0 +1,80 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_LINE_TABLE_H
+#define COMMON_LINE_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+
+/* Line and column of a byte in a source, both starting at 1. Columns count bytes. */
+struct SourcePosition {
+    uint32_t line;
+    uint32_t column;
+};
+
+/* The offset at which every line of a source begins, in increasing order.
+ * Tokens only record the offset of their lexeme so their line and column are recovered from this table when a diagnostic needs them.
+ */
+struct LineTable {
+    uint32_t * starts;
+    size_t count;
+};
+
+
+/**
+ * Builds the line table of the given source.
+ *
+ * @param       source the null terminated source, offsets are relative to its beginning.
+ * @param       message error message to display in case any operation on the table fails.
+ *
+ * @return      the newly created line table.
+ */
+struct LineTable * newLineTable(char const * source, char const * message);
+
+
+/**
+ * Frees the memory occupied by the line table.
+ *
+ * @param       table pointer to memory occupied by the line table.
+ */
+void deleteLineTable(struct LineTable ** const table);
+
+
+/**
+ * Returns the number of lines in the table.
+ *
+ * @param       table the line table.
+ *
+ * @return      the number of lines.
+ */
+size_t lineTableSize(struct LineTable const * const table);
+
+
+/**
+ * Returns the line and column of the byte at the given offset.
+ *
+ * @param       table the line table of the source the offset is relative to.
+ * @param       offset the offset of the byte.
+ *
+ * @return      the position of the byte.
+ */
+struct SourcePosition lineTablePosition(struct LineTable const * const table, uint32_t offset);
+
+#endif
@@ -0,0 +1,380 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/source_manager.h"
+#include "common/line_table.h"
+#include "utils/file.h"
+
+
+static uint16_t registerSource(struct SourceManager * const manager, char const * path, struct SourceFile * file, bool borrowed);
+static struct Source * sourceAt(struct SourceManager * const manager, uint16_t id);
+static struct LineTable const * sourceLines(struct SourceManager * const manager, uint16_t id);
+static void releaseContent(struct Source * const source);
+
+extern inline struct Source const * getSource(struct SourceManager const * const manager, uint16_t id);
+extern inline uint32_t sourceLocation(struct SourceManager const * const manager, uint16_t id, uint32_t offset);
+
+
+/**
+ * Initializes a source manager without any source.
+ *
+ * @param       load_mode how to bring the source files into memory.
+ * @param       message error message to display in case any operation on the source manager fails.
+ *
+ * @return      the newly created source manager.
+ */
+struct SourceManager * newSourceManager(enum LoadMode load_mode, char const * message) {
+    struct SourceManager * manager = malloc(sizeof *manager);
+    if (manager == NULL)
+        goto exit;
+
+    for (size_t i = 0; i < sizeof manager -> chunks / sizeof manager -> chunks[0]; i++)
+        manager -> chunks[i] = NULL;
+    manager -> count = 0;
+    manager -> next_base = 0;
+    manager -> load_mode = load_mode;
+    manager -> message = message;
+
+    if (pthread_mutex_init(& manager -> lock, NULL) != 0)
+        goto exit;
+
+    return manager;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newSourceManager.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the source manager and by every source it holds.
+ *
+ * @param       manager pointer to memory occupied by the source manager.
+ */
+void deleteSourceManager(struct SourceManager ** const manager) {
+    if (manager == NULL)
+        return;
+
+    if (* manager == NULL)
+        return;
+
+    for (uint32_t i = 0; i < (* manager) -> count; i++) {
+        struct Source * source = sourceAt(* manager, (uint16_t) i);
+        releaseContent(source);
+        deleteLineTable(& source -> lines);
+        free(source -> path);
+    }
+
+    for (size_t i = 0; i < sizeof (* manager) -> chunks / sizeof (* manager) -> chunks[0]; i++)
+        free((* manager) -> chunks[i]);
+
+    pthread_mutex_destroy(& (* manager) -> lock);
+    free(* manager);
+    * manager = NULL;
+}
+
+
+/**
+ * Loads the source file at the given path.
+ *
+ * @param       manager the source manager.
+ * @param       path the path to the source file, which is copied, STANDARD_INPUT_PATH for the standard input which goes by <stdin> in diagnostics.
+ *
+ * @return      the id of the source.
+ */
+uint16_t loadSource(struct SourceManager * const manager, char const * path) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    // The file is loaded before taking the lock so sources are loaded concurrently
+    struct SourceFile * file = loadFile(path, manager -> load_mode);
+    return registerSource(manager, strcmp(path, STANDARD_INPUT_PATH) == 0 ? "<stdin>" : path, file, false);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: loadSource.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Adds a source which content is already in memory, such as a generated source.
+ *
+ * @param       manager the source manager.
+ * @param       path the name the source goes by in diagnostics, which is copied.
+ * @param       content the null terminated content of the source, which must outlive the source manager.
+ * @param       length the length of the content.
+ *
+ * @return      the id of the source.
+ */
+uint16_t addSource(struct SourceManager * const manager, char const * path, char const * content, size_t length) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    struct SourceFile * file = malloc(sizeof *file);
+    if (file == NULL) {
+        message = manager -> message;
+        goto exit;
+    }
+
+    file -> path = NULL;
+    file -> content = content;
+    file -> length = length;
+    file -> mapped_size = 0;
+
+    return registerSource(manager, path, file, true);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: addSource.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Releases the content of a source that is no longer needed, positions in the source can still be looked up.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ */
+void unloadSource(struct SourceManager * const manager, uint16_t id) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    // Positions are found from the line table so it is built while we still have the content
+    sourceLines(manager, id);
+
+    pthread_mutex_lock(& manager -> lock);
+    releaseContent(sourceAt(manager, id));
+    pthread_mutex_unlock(& manager -> lock);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: unloadSource.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of sources added so far.
+ *
+ * @param       manager the source manager.
+ *
+ * @return      the number of sources.
+ */
+size_t sourcesCount(struct SourceManager * const manager) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    pthread_mutex_lock(& manager -> lock);
+    size_t count = manager -> count;
+    pthread_mutex_unlock(& manager -> lock);
+    return count;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sourcesCount.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the line and column of the byte at the given offset in a source.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ * @param       offset the offset of the byte in the source.
+ *
+ * @return      the position of the byte.
+ */
+struct SourcePosition sourcePosition(struct SourceManager * const manager, uint16_t id, uint32_t offset) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    return lineTablePosition(sourceLines(manager, id), offset);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sourcePosition.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the source, line and column of the byte at the given global offset.
+ *
+ * @param       manager the source manager.
+ * @param       location the global offset of the byte.
+ *
+ * @return      where the byte is.
+ */
+struct SourceLocation resolveLocation(struct SourceManager * const manager, uint32_t location) {
+    char const * message = "The parameter <manager> cannot be NULL.";
+    if (manager == NULL)
+        goto exit;
+
+    // Sources get increasing bases as they are added so we look for the last source that begins at or before the location
+    size_t low = 1;
+    size_t high = sourcesCount(manager);
+    message = "The location does not belong to any source.";
+    if (high == 0)
+        goto exit;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (getSource(manager, (uint16_t) middle) -> base <= location)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    uint16_t id = (uint16_t) (low - 1);
+    struct SourceLocation where = { .file = id, .position = sourcePosition(manager, id, location - getSource(manager, id) -> base) };
+    return where;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: resolveLocation.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Gives the next id and the next range of global offsets to a source.
+ *
+ * @param       manager the source manager.
+ * @param       path the path of the source, which is copied.
+ * @param       file the content of the source, which now belongs to the manager.
+ * @param       borrowed true if the content itself belongs to the caller.
+ *
+ * @return      the id of the source.
+ */
+static uint16_t registerSource(struct SourceManager * const manager, char const * path, struct SourceFile * file, bool borrowed) {
+    char * copy = strdup(path);
+    if (copy == NULL)
+        goto exit;
+
+    pthread_mutex_lock(& manager -> lock);
+    if (manager -> count >= SOURCES_MAX) {
+        fprintf(stderr, "Too many source files: a compilation is limited to %u files.\n", (unsigned) SOURCES_MAX);
+        exit(74);
+    }
+
+    // Every global offset must fit on 32 bits, the end of each source included
+    if (file -> length > UINT32_MAX || manager -> next_base + file -> length + 1 > (uint64_t) UINT32_MAX + 1) {
+        fprintf(stderr, "The file <%s> is too large: the sources of a compilation are limited to %lu bytes in total.\n", path, (unsigned long) UINT32_MAX);
+        exit(74);
+    }
+
+    uint16_t id = (uint16_t) manager -> count;
+    size_t chunk = id >> SOURCE_CHUNK_BITS;
+    if (manager -> chunks[chunk] == NULL) {
+        manager -> chunks[chunk] = malloc(SOURCE_CHUNK_SIZE * sizeof *manager -> chunks[chunk]);
+        if (manager -> chunks[chunk] == NULL)
+            goto exit;
+    }
+
+    struct Source * source = sourceAt(manager, id);
+    source -> path = copy;
+    source -> file = file;
+    source -> file -> path = copy;
+    source -> borrowed = borrowed;
+    source -> lines = NULL;
+    source -> base = (uint32_t) manager -> next_base;
+    source -> length = (uint32_t) file -> length;
+
+    manager -> next_base += file -> length + 1;
+    manager -> count++;
+    pthread_mutex_unlock(& manager -> lock);
+
+    return id;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: registerSource.\nMessage: %s\n", __FILE__, __LINE__, manager -> message);
+    exit(74);
+}
+
+
+/**
+ * Returns the source with the given id.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ *
+ * @return      the source.
+ */
+static struct Source * sourceAt(struct SourceManager * const manager, uint16_t id) {
+    return & manager -> chunks[id >> SOURCE_CHUNK_BITS][id & (SOURCE_CHUNK_SIZE - 1)];
+}
+
+
+/**
+ * Returns the line table of a source, building it the first time.
+ * The table is built outside of the lock so sources being unloaded at the same time do not wait on each other.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ *
+ * @return      the line table of the source.
+ */
+static struct LineTable const * sourceLines(struct SourceManager * const manager, uint16_t id) {
+    pthread_mutex_lock(& manager -> lock);
+    struct Source * source = sourceAt(manager, id);
+    struct LineTable * lines = source -> lines;
+    char const * content = lines == NULL ? source -> file -> content : NULL;
+    pthread_mutex_unlock(& manager -> lock);
+
+    if (lines != NULL)
+        return lines;
+
+    // Should another thread have built the table in the meantime, we keep theirs
+    lines = newLineTable(content, manager -> message);
+    pthread_mutex_lock(& manager -> lock);
+    if (source -> lines == NULL)
+        source -> lines = lines;
+    else
+        deleteLineTable(& lines);
+    lines = source -> lines;
+    pthread_mutex_unlock(& manager -> lock);
+
+    return lines;
+}
+
+
+/**
+ * Releases the content of a source unless it was already.
+ *
+ * @param       source the source.
+ */
+static void releaseContent(struct Source * const source) {
+    if (source -> borrowed)
+        free(source -> file);
+    else
+        unloadFile(& source -> file);
+
+    source -> file = NULL;
+}
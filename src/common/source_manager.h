@@ -0,0 +1,190 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_SOURCE_MANAGER_H
+#define COMMON_SOURCE_MANAGER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common/line_table.h"
+#include "utils/file.h"
+
+
+/* Sources are identified by 16 bits so at most SOURCES_MAX sources can be loaded, NO_SOURCE identifies none of them. */
+#define NO_SOURCE UINT16_MAX
+#define SOURCES_MAX UINT16_MAX
+
+/* Sources are stored in chunks that never move so a source can be read while other sources are being added. */
+#define SOURCE_CHUNK_BITS 8
+#define SOURCE_CHUNK_SIZE (1u << SOURCE_CHUNK_BITS)
+
+/* A source file known to the source manager. */
+struct Source {
+    char * path;
+
+    /* The content of the source, NULL once the source is unloaded. Borrowed content belongs to whoever added the source. */
+    struct SourceFile * file;
+    bool borrowed;
+
+    /* Built the first time a position in the source is looked up, kept when the source is unloaded. */
+    struct LineTable * lines;
+
+    /* The sources are laid end to end in a single range of global offsets, each source taking one more offset than it has bytes for its end.
+     * The global offset of a byte is the base of its source plus its offset in the source.
+     */
+    uint32_t base;
+    uint32_t length;
+};
+
+/* Where a byte of some source is. */
+struct SourceLocation {
+    uint16_t file;
+    struct SourcePosition position;
+};
+
+/* Owns every source taking part in a compilation.
+ * Each source gets a small integer id and a range of global offsets so a location in any source fits in 32 bits.
+ * Sources are added under lock, and once added a source can be read without it.
+ */
+struct SourceManager {
+    struct Source * chunks[SOURCES_MAX / SOURCE_CHUNK_SIZE + 1];
+    uint32_t count;
+    uint64_t next_base;
+
+    enum LoadMode load_mode;
+
+    pthread_mutex_t lock;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes a source manager without any source.
+ *
+ * @param       load_mode how to bring the source files into memory.
+ * @param       message error message to display in case any operation on the source manager fails.
+ *
+ * @return      the newly created source manager.
+ */
+struct SourceManager * newSourceManager(enum LoadMode load_mode, char const * message);
+
+
+/**
+ * Frees the memory occupied by the source manager and by every source it holds.
+ *
+ * @param       manager pointer to memory occupied by the source manager.
+ */
+void deleteSourceManager(struct SourceManager ** const manager);
+
+
+/**
+ * Loads the source file at the given path.
+ *
+ * @param       manager the source manager.
+ * @param       path the path to the source file, which is copied, STANDARD_INPUT_PATH for the standard input which goes by <stdin> in diagnostics.
+ *
+ * @return      the id of the source.
+ */
+uint16_t loadSource(struct SourceManager * const manager, char const * path);
+
+
+/**
+ * Adds a source which content is already in memory, such as a generated source.
+ *
+ * @param       manager the source manager.
+ * @param       path the name the source goes by in diagnostics, which is copied.
+ * @param       content the null terminated content of the source, which must outlive the source manager.
+ * @param       length the length of the content.
+ *
+ * @return      the id of the source.
+ */
+uint16_t addSource(struct SourceManager * const manager, char const * path, char const * content, size_t length);
+
+
+/**
+ * Releases the content of a source that is no longer needed, positions in the source can still be looked up.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ */
+void unloadSource(struct SourceManager * const manager, uint16_t id);
+
+
+/**
+ * Returns the number of sources added so far.
+ *
+ * @param       manager the source manager.
+ *
+ * @return      the number of sources.
+ */
+size_t sourcesCount(struct SourceManager * const manager);
+
+
+/**
+ * Returns the source with the given id.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source, which must have been returned by the manager.
+ *
+ * @return      the source.
+ */
+inline struct Source const * getSource(struct SourceManager const * const manager, uint16_t id) {
+    return & manager -> chunks[id >> SOURCE_CHUNK_BITS][id & (SOURCE_CHUNK_SIZE - 1)];
+}
+
+
+/**
+ * Returns the global offset of the byte at the given offset in a source.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ * @param       offset the offset of the byte in the source.
+ *
+ * @return      the global offset of the byte.
+ */
+inline uint32_t sourceLocation(struct SourceManager const * const manager, uint16_t id, uint32_t offset) {
+    return getSource(manager, id) -> base + offset;
+}
+
+
+/**
+ * Returns the line and column of the byte at the given offset in a source.
+ *
+ * @param       manager the source manager.
+ * @param       id the id of the source.
+ * @param       offset the offset of the byte in the source.
+ *
+ * @return      the position of the byte.
+ */
+struct SourcePosition sourcePosition(struct SourceManager * const manager, uint16_t id, uint32_t offset);
+
+
+/**
+ * Returns the source, line and column of the byte at the given global offset.
+ *
+ * @param       manager the source manager.
+ * @param       location the global offset of the byte.
+ *
+ * @return      where the byte is.
+ */
+struct SourceLocation resolveLocation(struct SourceManager * const manager, uint32_t location);
+
+#endif
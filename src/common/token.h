@@ -18,18 +18,18 @@
 #ifndef COMMON_TOKEN_H
 #define COMMON_TOKEN_H
 
-#include <stddef.h>
+#include <stdint.h>
 
 #include "common/token_type.h"
 
 
+/* A token only records where its lexeme lies in the source: its line and column are looked up in the line table of the source when a diagnostic needs them.
+ * Error tokens span the characters the lexer rejected, their message is kept by the token buffer.
+ */
 struct Token {
     enum TokenType type;
-    char const * file;
-    char const * start;
-    size_t length;
-    size_t line;
-    size_t column;
+    uint32_t offset;
+    uint32_t length;
 };
 
 #endif
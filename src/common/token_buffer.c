@@ -0,0 +1,385 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/token_buffer.h"
+#include "common/bitvector.h"
+#include "common/interner.h"
+#include "common/token_type.h"
+#include "common/token.h"
+#include "utils/vector.h"
+
+
+_Static_assert(AVL_ERROR <= UINT8_MAX, "Token types must fit in a single byte to be stored in a token buffer.");
+_Static_assert(sizeof(struct Token) == 12, "Tokens are made of their type, offset and length only.");
+
+VECTOR_DEFINE(TokenErrorVector, tokenErrorVector, struct TokenError, 4)
+VECTOR_DEFINE(LiteralVector, literalVector, struct Literal, 4)
+
+static void tokenBufferGrow(struct TokenBuffer * const buffer);
+
+extern inline enum TokenType tokenBufferType(struct TokenBuffer const * const buffer, size_t position);
+extern inline char const * tokenBufferLexeme(struct TokenBuffer const * const buffer, size_t position);
+extern inline uint32_t tokenBufferLocation(struct TokenBuffer const * const buffer, size_t position);
+extern inline uint32_t tokenBufferSymbol(struct TokenBuffer const * const buffer, size_t position);
+extern inline struct BitVector tokenBufferBits(struct TokenBuffer const * const buffer, struct Literal const * const literal);
+
+
+/**
+ * Initializes the token buffer.
+ *
+ * @param       file the id of the source the tokens come from.
+ * @param       base the global offset at which the source begins in its source manager.
+ * @param       source the source the token offsets are relative to.
+ * @param       initial_capacity the number of tokens the buffer can hold before growing.
+ * @param       message error message to display in case any operation on the buffer fails.
+ *
+ * @return      the newly created token buffer.
+ */
+struct TokenBuffer * newTokenBuffer(uint16_t file, uint32_t base, char const * source, size_t initial_capacity, char const * message) {
+    if (initial_capacity == 0)
+        goto exit;
+
+    struct TokenBuffer * buffer = malloc(sizeof *buffer);
+    if (buffer == NULL)
+        goto exit;
+
+    buffer -> file = file;
+    buffer -> base = base;
+    buffer -> source = source;
+    buffer -> types = malloc(initial_capacity * sizeof *buffer -> types);
+    buffer -> offsets = malloc(initial_capacity * sizeof *buffer -> offsets);
+    buffer -> lengths = malloc(initial_capacity * sizeof *buffer -> lengths);
+    buffer -> symbols = malloc(initial_capacity * sizeof *buffer -> symbols);
+    if (buffer -> types == NULL || buffer -> offsets == NULL || buffer -> lengths == NULL || buffer -> symbols == NULL)
+        goto exit;
+    buffer -> capacity = initial_capacity;
+    buffer -> size = 0;
+
+    buffer -> errors = newTokenErrorVector(0, message);
+    buffer -> literals = newLiteralVector(0, message);
+    buffer -> limbs = newUint64Vector(0, message);
+    buffer -> message = message;
+
+    return buffer;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newTokenBuffer.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the token buffer.
+ *
+ * @param       buffer pointer to memory occupied by the token buffer.
+ */
+void deleteTokenBuffer(struct TokenBuffer ** const buffer) {
+    if (buffer == NULL)
+        return;
+
+    if (* buffer == NULL)
+        return;
+
+    free((* buffer) -> types);
+    free((* buffer) -> offsets);
+    free((* buffer) -> lengths);
+    free((* buffer) -> symbols);
+    deleteTokenErrorVector(& (* buffer) -> errors);
+    deleteLiteralVector(& (* buffer) -> literals);
+    deleteUint64Vector(& (* buffer) -> limbs);
+    free(* buffer);
+    * buffer = NULL;
+}
+
+
+/**
+ * Return the number of tokens in the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ *
+ * @return      the number of tokens in the buffer.
+ */
+size_t tokenBufferSize(struct TokenBuffer const * const buffer) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    return buffer -> size;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferSize.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Appends the given token at the back of the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the token to append, which must not be an error token.
+ */
+void tokenBufferPush(struct TokenBuffer * const buffer, struct Token const * const token) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    if (buffer -> size == buffer -> capacity)
+        tokenBufferGrow(buffer);
+
+    size_t position = buffer -> size++;
+    buffer -> types[position] = (uint8_t) token -> type;
+    buffer -> offsets[position] = token -> offset;
+    buffer -> lengths[position] = token -> length;
+    buffer -> symbols[position] = NO_SYMBOL;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferPush.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Appends the given error token at the back of the buffer and records the message attached to it.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the error token to append.
+ * @param       message the description of the error, which must live as long as the buffer.
+ */
+void tokenBufferPushError(struct TokenBuffer * const buffer, struct Token const * const token, char const * message) {
+    char const * error = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // Only error tokens have a message attached to them
+    if (token -> type != AVL_ERROR)
+        goto exit;
+
+    tokenBufferPush(buffer, token);
+
+    struct TokenError token_error = { .token = (uint32_t) (buffer -> size - 1), .message = message };
+    tokenErrorVectorPushback(buffer -> errors, token_error);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferPushError.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : error);
+    exit(74);
+}
+
+
+/**
+ * Appends the given numeric literal token at the back of the buffer and records its value.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the numeric literal token to append.
+ * @param       literal the value of the literal, the limbs of bit patterns must already be in the limb pool of the buffer.
+ */
+void tokenBufferPushLiteral(struct TokenBuffer * const buffer, struct Token const * const token, struct Literal const * const literal) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // Only numeric literal tokens have a value attached to them
+    if (token -> type < AVL_CLASSICAL_INT || token -> type > AVL_QUANTUM_DEC)
+        goto exit;
+
+    tokenBufferPush(buffer, token);
+
+    // Literals are no identifiers so their symbol slot is free to point to their value
+    buffer -> symbols[buffer -> size - 1] = (uint32_t) literalVectorSize(buffer -> literals);
+    literalVectorPushback(buffer -> literals, * literal);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferPushLiteral.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the value of the numeric literal token at the given position.
+ * Fails early if the token at the given position is not a numeric literal.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the value decoded by the lexer.
+ */
+struct Literal tokenBufferLiteral(struct TokenBuffer const * const buffer, size_t position) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // If the position is not within the buffer bounds, we fail early
+    if (position >= buffer -> size)
+        goto exit;
+
+    if (buffer -> types[position] < AVL_CLASSICAL_INT || buffer -> types[position] > AVL_QUANTUM_DEC)
+        goto exit;
+
+    return * literalVectorAt(buffer -> literals, buffer -> symbols[position]);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferLiteral.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the token at the given position.
+ * Fails early if the given position is not within the buffer bounds.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the token rebuilt from the packed representation.
+ */
+struct Token tokenBufferAt(struct TokenBuffer const * const buffer, size_t position) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // If the position is not within the buffer bounds, we fail early
+    if (position >= buffer -> size)
+        goto exit;
+
+    struct Token token;
+    token.type = (enum TokenType) buffer -> types[position];
+    token.offset = buffer -> offsets[position];
+    token.length = buffer -> lengths[position];
+
+    return token;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferAt.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Records the symbol the lexeme of the token at the given position was interned as.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ * @param       symbol the interned symbol of the token lexeme.
+ */
+void tokenBufferSetSymbol(struct TokenBuffer * const buffer, size_t position, uint32_t symbol) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // If the position is not within the buffer bounds, we fail early
+    if (position >= buffer -> size)
+        goto exit;
+
+    buffer -> symbols[position] = symbol;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferSetSymbol.\nMessage: %s\n", __FILE__, __LINE__, buffer ? buffer -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Releases the capacity of the buffer beyond its last token.
+ * The buffer can still grow afterwards.
+ *
+ * @param       buffer pointer to the token buffer.
+ */
+void tokenBufferShrink(struct TokenBuffer * const buffer) {
+    char const * message = "The parameter <buffer> cannot be NULL.";
+    if (buffer == NULL)
+        goto exit;
+
+    // An empty buffer keeps one slot since the arrays cannot be empty
+    size_t new_capacity = buffer -> size > 0 ? buffer -> size : 1;
+    if (new_capacity == buffer -> capacity)
+        return;
+
+    message = buffer -> message;
+    uint8_t * types = realloc(buffer -> types, new_capacity * sizeof *types);
+    if (types == NULL)
+        goto exit;
+    buffer -> types = types;
+
+    uint32_t * offsets = realloc(buffer -> offsets, new_capacity * sizeof *offsets);
+    if (offsets == NULL)
+        goto exit;
+    buffer -> offsets = offsets;
+
+    uint32_t * lengths = realloc(buffer -> lengths, new_capacity * sizeof *lengths);
+    if (lengths == NULL)
+        goto exit;
+    buffer -> lengths = lengths;
+
+    uint32_t * symbols = realloc(buffer -> symbols, new_capacity * sizeof *symbols);
+    if (symbols == NULL)
+        goto exit;
+    buffer -> symbols = symbols;
+
+    buffer -> capacity = new_capacity;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferShrink.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Doubles the capacity of every token array in the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ */
+static void tokenBufferGrow(struct TokenBuffer * const buffer) {
+    size_t new_capacity = 2 * buffer -> capacity;
+
+    uint8_t * types = realloc(buffer -> types, new_capacity * sizeof *types);
+    if (types == NULL)
+        goto exit;
+    buffer -> types = types;
+
+    uint32_t * offsets = realloc(buffer -> offsets, new_capacity * sizeof *offsets);
+    if (offsets == NULL)
+        goto exit;
+    buffer -> offsets = offsets;
+
+    uint32_t * lengths = realloc(buffer -> lengths, new_capacity * sizeof *lengths);
+    if (lengths == NULL)
+        goto exit;
+    buffer -> lengths = lengths;
+
+    uint32_t * symbols = realloc(buffer -> symbols, new_capacity * sizeof *symbols);
+    if (symbols == NULL)
+        goto exit;
+    buffer -> symbols = symbols;
+
+    buffer -> capacity = new_capacity;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: tokenBufferGrow.\nMessage: %s\n", __FILE__, __LINE__, buffer -> message);
+    exit(74);
+}
+
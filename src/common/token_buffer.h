@@ -0,0 +1,249 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMMON_TOKEN_BUFFER_H
+#define COMMON_TOKEN_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common/bitvector.h"
+#include "common/token_type.h"
+#include "common/token.h"
+#include "utils/vector.h"
+
+
+/* Message attached to an ERROR token. Messages are static strings that have nothing to do with the source so we keep them on the side. */
+struct TokenError {
+    uint32_t token;
+    char const * message;
+};
+
+VECTOR_DECLARE(TokenErrorVector, tokenErrorVector, struct TokenError, 4)
+
+/* Value of a numeric literal token, decoded by the lexer as it scanned the literal.
+ * Integers are unsigned 64 bits integers, floating point and decimal numbers are the double nearest to the literal.
+ * Bitstrings, hexadecimal and octal literals are bit patterns of any width: 1, 4 and 3 bits per digit respectively, leading zeros included.
+ * Their bits are the limbs of a bit vector stored in the limb pool of the token buffer, from the index recorded here on.
+ * The width of integers and reals is zero.
+ */
+struct Literal {
+    uint32_t width;
+    union {
+        uint64_t integer;
+        double real;
+        uint32_t limbs;
+    } value;
+};
+
+VECTOR_DECLARE(LiteralVector, literalVector, struct Literal, 4)
+
+/* All the tokens of a source stored as a structure of arrays.
+ * A token is identified by its index and its lexeme is found at source + offsets[index] and spans lengths[index] bytes.
+ * Identifier tokens also carry the symbol their lexeme was interned as in symbols[index] and numeric literal tokens carry the index of their value among the literals.
+ * Other tokens have NO_SYMBOL.
+ * Lines and columns are only needed for diagnostics so they are not stored per token: the source manager finds them from the token global offset.
+ */
+struct TokenBuffer {
+    uint16_t file;
+    uint32_t base;
+    char const * source;
+
+    uint8_t * types;
+    uint32_t * offsets;
+    uint32_t * lengths;
+    uint32_t * symbols;
+    size_t capacity;
+    size_t size;
+
+    struct TokenErrorVector * errors;
+    struct LiteralVector * literals;
+    struct Uint64Vector * limbs;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes the token buffer.
+ *
+ * @param       file the id of the source the tokens come from.
+ * @param       base the global offset at which the source begins in its source manager.
+ * @param       source the source the token offsets are relative to.
+ * @param       initial_capacity the number of tokens the buffer can hold before growing.
+ * @param       message error message to display in case any operation on the buffer fails.
+ *
+ * @return      the newly created token buffer.
+ */
+struct TokenBuffer * newTokenBuffer(uint16_t file, uint32_t base, char const * source, size_t initial_capacity, char const * message);
+
+
+/**
+ * Frees the memory occupied by the token buffer.
+ *
+ * @param       buffer pointer to memory occupied by the token buffer.
+ */
+void deleteTokenBuffer(struct TokenBuffer ** const buffer);
+
+
+/**
+ * Return the number of tokens in the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ *
+ * @return      the number of tokens in the buffer.
+ */
+size_t tokenBufferSize(struct TokenBuffer const * const buffer);
+
+
+/**
+ * Appends the given token at the back of the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the token to append, which must not be an error token.
+ */
+void tokenBufferPush(struct TokenBuffer * const buffer, struct Token const * const token);
+
+
+/**
+ * Appends the given error token at the back of the buffer and records the message attached to it.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the error token to append.
+ * @param       message the description of the error, which must live as long as the buffer.
+ */
+void tokenBufferPushError(struct TokenBuffer * const buffer, struct Token const * const token, char const * message);
+
+
+/**
+ * Returns the token at the given position.
+ * Fails early if the given position is not within the buffer bounds.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the token rebuilt from the packed representation.
+ */
+struct Token tokenBufferAt(struct TokenBuffer const * const buffer, size_t position);
+
+
+/**
+ * Appends the given numeric literal token at the back of the buffer and records its value.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       token the numeric literal token to append.
+ * @param       literal the value of the literal, the limbs of bit patterns must already be in the limb pool of the buffer.
+ */
+void tokenBufferPushLiteral(struct TokenBuffer * const buffer, struct Token const * const token, struct Literal const * const literal);
+
+
+/**
+ * Returns the value of the numeric literal token at the given position.
+ * Fails early if the token at the given position is not a numeric literal.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the value decoded by the lexer.
+ */
+struct Literal tokenBufferLiteral(struct TokenBuffer const * const buffer, size_t position);
+
+
+/**
+ * Records the symbol the lexeme of the token at the given position was interned as.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ * @param       symbol the interned symbol of the token lexeme.
+ */
+void tokenBufferSetSymbol(struct TokenBuffer * const buffer, size_t position, uint32_t symbol);
+
+
+/**
+ * Releases the capacity of the buffer beyond its last token.
+ * The buffer can still grow afterwards.
+ *
+ * @param       buffer pointer to the token buffer.
+ */
+void tokenBufferShrink(struct TokenBuffer * const buffer);
+
+
+/**
+ * Returns the type of the token at the given position without rebuilding the entire token.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the type of the token.
+ */
+inline enum TokenType tokenBufferType(struct TokenBuffer const * const buffer, size_t position) {
+    return (enum TokenType) buffer -> types[position];
+}
+
+
+/**
+ * Returns the lexeme of the token at the given position, which spans as many characters as the length of the token.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      a pointer to the first character of the token in the source.
+ */
+inline char const * tokenBufferLexeme(struct TokenBuffer const * const buffer, size_t position) {
+    return buffer -> source + buffer -> offsets[position];
+}
+
+
+/**
+ * Returns the global offset at which the token at the given position begins, which the source manager resolves to a file, line and column.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the global offset of the first character of the token.
+ */
+inline uint32_t tokenBufferLocation(struct TokenBuffer const * const buffer, size_t position) {
+    return buffer -> base + buffer -> offsets[position];
+}
+
+
+/**
+ * Returns the symbol of the token at the given position.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       position index of the token within the buffer.
+ *
+ * @return      the interned symbol of the token lexeme if it is an identifier, NO_SYMBOL otherwise.
+ */
+inline uint32_t tokenBufferSymbol(struct TokenBuffer const * const buffer, size_t position) {
+    return buffer -> symbols[position];
+}
+
+
+/**
+ * Returns the bits of a bit pattern literal as a view over the limb pool of the buffer.
+ *
+ * @param       buffer pointer to the token buffer.
+ * @param       literal the value of a bitstring, hexadecimal or octal literal token of the buffer.
+ *
+ * @return      the bit vector of the literal, valid for as long as the buffer and which must not be deleted.
+ */
+inline struct BitVector tokenBufferBits(struct TokenBuffer const * const buffer, struct Literal const * const literal) {
+    return bitVectorView(uint64VectorData(buffer -> limbs) + literal -> value.limbs, literal -> width);
+}
+
+#endif
@@ -122,6 +122,52 @@ enum TokenType {
 };
 
 
+/* Every word the lexer recognizes as a keyword, with the token type it yields.
+ * This list is the single source of truth for keyword recognition: tools/keywords.c turns it into a perfect hash table at build time.
+ */
+#define AVL_KEYWORDS(KEYWORD)                   \
+    KEYWORD("and",          AVL_LOGICAL_AND)    \
+    KEYWORD("or",           AVL_LOGICAL_OR)     \
+    KEYWORD("not",          AVL_LOGICAL_NOT)    \
+    KEYWORD("band",         AVL_BITWISE_AND)    \
+    KEYWORD("bor",          AVL_BITWISE_OR)     \
+    KEYWORD("bnot",         AVL_BITWISE_NOT)    \
+    KEYWORD("xor",          AVL_BITWISE_XOR)    \
+    KEYWORD("lsh",          AVL_LEFT_SHIFT)     \
+    KEYWORD("rsh",          AVL_RIGHT_SHIFT)    \
+    KEYWORD("import",       AVL_IMPORT)         \
+    KEYWORD("namespace",    AVL_NAMESPACE)      \
+    KEYWORD("public",       AVL_PUBLIC)         \
+    KEYWORD("private",      AVL_PRIVATE)        \
+    KEYWORD("ptr",          AVL_PTR)            \
+    KEYWORD("ref",          AVL_REF)            \
+    KEYWORD("dref",         AVL_DREF)           \
+    KEYWORD("const",        AVL_CONST)          \
+    KEYWORD("type",         AVL_TYPE)           \
+    KEYWORD("def",          AVL_DEF)            \
+    KEYWORD("var",          AVL_VAR)            \
+    KEYWORD("val",          AVL_VAL)            \
+    KEYWORD("cast",         AVL_CAST)           \
+    KEYWORD("switch",       AVL_SWITCH)         \
+    KEYWORD("case",         AVL_CASE)           \
+    KEYWORD("default",      AVL_DEFAULT)        \
+    KEYWORD("if",           AVL_IF)             \
+    KEYWORD("elif",         AVL_ELIF)           \
+    KEYWORD("else",         AVL_ELSE)           \
+    KEYWORD("for",          AVL_FOR)            \
+    KEYWORD("empty",        AVL_EMPTY)          \
+    KEYWORD("while",        AVL_WHILE)          \
+    KEYWORD("continue",     AVL_CONTINUE)       \
+    KEYWORD("break",        AVL_BREAK)          \
+    KEYWORD("return",       AVL_RETURN)         \
+    KEYWORD("pass",         AVL_PASS)           \
+    KEYWORD("in",           AVL_IN)             \
+    KEYWORD("next",         AVL_NEXT)           \
+    KEYWORD("prev",         AVL_PREV)           \
+    KEYWORD("is",           AVL_IS)             \
+    KEYWORD("unique",       AVL_UNIQUE)
+
+
 /**
  * Returns the string representation of a token type
  *
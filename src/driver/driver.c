@@ -0,0 +1,1058 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "driver/interface_cache.h"
+#include "driver/search_path.h"
+#include "driver/fingerprint.h"
+#include "common/ast/program.h"
+#include "common/token_buffer.h"
+#include "common/source_manager.h"
+#include "common/interner.h"
+#include "driver/driver.h"
+#include "common/ast/ast.h"
+#include "parser/parser.h"
+#include "lexer/lexer.h"
+#include "common/fqn.h"
+#include "utils/work_deque.h"
+#include "utils/result.h"
+#include "utils/vector.h"
+#include "utils/arena.h"
+#include "utils/file.h"
+
+
+/* Size of the blocks error messages are allocated from. */
+#define MESSAGES_BLOCK_SIZE 4096
+
+/* The number of tasks a worker deque holds before growing. */
+#define WORKER_DEQUE_CAPACITY 64
+
+/* The state of a module during the depth first walk of the import graph. */
+enum VisitState {
+    UNVISITED = 0,
+    IN_PROGRESS,                // the module is on the walk stack: reaching it again means we went around a cycle
+    DONE                        // the module and every module it imports are scheduled
+};
+
+/* A module on the walk stack together with the index of the next import of it to follow. */
+struct Visit {
+    uint32_t module;
+    uint32_t next;
+};
+
+/* What a task does to its module. A task is the index of its module shifted left once, the low bit being its kind. */
+enum TaskKind {
+    TASK_PARSE = 0,             // load, lex and parse the module then find the modules it imports
+    TASK_COMPILE = 1            // run the phases after parsing, every module the module imports went through them
+};
+
+struct Pool;
+
+/* A thread of the pool with the deque of the tasks it found. */
+struct Worker {
+    struct Pool * pool;
+    struct WorkDeque * deque;
+    size_t id;
+    pthread_t thread;
+};
+
+/* The workers compiling the modules of a driver.
+ * A worker runs the tasks it pushed itself newest first then steals the oldest tasks of the others when it runs out.
+ * pending counts the tasks pushed and not yet finished: a task is counted before it is pushed and uncounted after the tasks it pushes are,
+ * so the workers can stop once it drops to zero.
+ *
+ * A worker that finds nothing to run or steal waits on idle until a task is pushed or pending drops to zero.
+ * pushes counts the tasks ever pushed so a worker does not wait for a task pushed while it was looking for one.
+ */
+struct Pool {
+    struct Driver * driver;
+    struct Worker * workers;
+    size_t count;
+    _Atomic size_t pending;
+    _Atomic size_t pushes;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle;
+};
+
+VECTOR_DEFINE(ImportVector, importVector, struct Import, 4)
+
+VECTOR_DECLARE(VisitVector, visitVector, struct Visit, 16)
+VECTOR_DEFINE(VisitVector, visitVector, struct Visit, 16)
+
+static uint32_t addModule(struct Driver * const driver, char const * fqn_path, char * path);
+static uint32_t findModule(struct Driver const * const driver, uint32_t name);
+static void runPool(struct Driver * const driver);
+static void * runWorker(void * argument);
+static bool stealTask(struct Worker * const worker, uint32_t * task);
+static void pushTask(struct Worker * const worker, uint32_t module, enum TaskKind kind);
+static void parseModule(struct Worker * const worker, uint32_t index);
+static void compileModule(struct Worker * const worker, uint32_t index);
+static void fingerprintModule(struct Driver * const driver, struct Module * const module);
+static bool parseSource(struct Module * const module, size_t limit, struct Driver * const driver);
+static bool resolveImport(struct Driver * const driver, uint32_t index, char const * name, uint32_t token, uint32_t * added);
+static uint32_t importLocation(struct Driver * const driver, struct Module const * const module, uint32_t token);
+static void reportCycle(struct Driver * const driver, struct VisitVector const * const stack, uint32_t imported);
+static void driverError(struct Driver * const driver, enum ErrorType type, struct Module * const module, uint32_t token, char const * message);
+static char const * formatMessage(struct Driver * const driver, char const * format, ...);
+static bool errorLimitReached(struct Driver const * const driver);
+
+
+/**
+ * Initializes a driver with an empty search path.
+ *
+ * @param       load_mode how to bring the source files into memory.
+ * @param       message error message to display in case any operation on the driver fails.
+ *
+ * @return      the newly created driver.
+ */
+struct Driver * newDriver(enum LoadMode load_mode, char const * message) {
+    struct Driver * driver = malloc(sizeof *driver);
+    if (driver == NULL)
+        goto exit;
+
+    driver -> search_path = newSearchPath(message);
+    driver -> cache = NULL;
+    driver -> modules = newVector(16, message);
+    driver -> modules_by_name = newUint32Vector(0, message);
+    driver -> incomplete = false;
+    driver -> order = newUint32Vector(0, message);
+    driver -> errors = newErrorVector(0, message);
+    driver -> error_limit = DEFAULT_ERROR_LIMIT;
+    driver -> sources = newSourceManager(load_mode, message);
+    driver -> jobs = 1;
+    driver -> arena = newArena(MESSAGES_BLOCK_SIZE, message);
+    driver -> message = message;
+    if (pthread_mutex_init(& driver -> lock, NULL) != 0)
+        goto exit;
+
+    return driver;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newDriver.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the driver and by every module it loaded.
+ *
+ * @param       driver pointer to memory occupied by the driver.
+ */
+void deleteDriver(struct Driver ** const driver) {
+    if (driver == NULL)
+        return;
+
+    if (* driver == NULL)
+        return;
+
+    struct Vector * modules = (* driver) -> modules;
+    for (size_t i = 0; i < vectorSize(modules); i++) {
+        struct Module * module = vectorAt(modules, i);
+        deleteProgram(& module -> program);
+        deleteInterface(& module -> interface);
+        deleteImportVector(& module -> imports);
+        deleteUint32Vector(& module -> dependents);
+        deleteUint32Vector(& module -> changed);
+        free(module -> path);
+        free(module);
+    }
+
+    deleteSourceManager(& (* driver) -> sources);
+    deleteSearchPath(& (* driver) -> search_path);
+    deleteInterfaceCache(& (* driver) -> cache);
+    deleteVector(& (* driver) -> modules);
+    deleteUint32Vector(& (* driver) -> modules_by_name);
+    deleteUint32Vector(& (* driver) -> order);
+    deleteErrorVector(& (* driver) -> errors);
+    deleteArena(& (* driver) -> arena);
+    pthread_mutex_destroy(& (* driver) -> lock);
+    free(* driver);
+    * driver = NULL;
+}
+
+
+/**
+ * Sets the number of errors after which the driver gives up.
+ *
+ * @param       driver the driver which error limit to set.
+ * @param       limit the maximum number of errors to collect, 0 to collect every error.
+ */
+void setDriverErrorLimit(struct Driver * const driver, size_t limit) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    driver -> error_limit = limit;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setDriverErrorLimit.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Sets the number of threads the driver compiles modules on.
+ *
+ * @param       driver the driver which number of threads to set.
+ * @param       jobs the number of threads, at least 1.
+ */
+void setDriverJobs(struct Driver * const driver, size_t jobs) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    message = "The driver needs at least one job.";
+    if (jobs == 0)
+        goto exit;
+
+    driver -> jobs = jobs;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setDriverJobs.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Makes the driver cache the interfaces of the modules it parses in the given directory,
+ * and use the cached interfaces of imported modules which source did not change instead of parsing them.
+ *
+ * @param       driver the driver which cache to set.
+ * @param       directory the path to the cache directory, created if it does not exist.
+ */
+void setDriverCache(struct Driver * const driver, char const * directory) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    deleteInterfaceCache(& driver -> cache);
+    driver -> cache = newInterfaceCache(directory, driver -> message);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setDriverCache.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Loads, lexes and parses the main module then every module it imports, directly or not.
+ * Imported modules are looked up in the search path of the driver and modules are parsed in parallel when the driver has several jobs.
+ *
+ * @param       driver the driver to load the modules into.
+ * @param       source_path the path to the source file of the main module, STANDARD_INPUT_PATH to read it from the standard input.
+ *
+ * @return      true if every module was found and parsed without errors, false otherwise.
+ *              When only syntax errors were found the import graph is whole and the modules can still be scheduled, see Driver.incomplete.
+ */
+bool loadModules(struct Driver * const driver, char const * source_path) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    // The name of the main module is the name of its source file without the directory and the extension, a main module read from the standard input or without a name is called main
+    char const * base = strcmp(source_path, STANDARD_INPUT_PATH) == 0 ? "main" : source_path;
+    for (char const * c = base; * c != '\0'; c++)
+        if (* c == '/' || * c == '\\')
+            base = c + 1;
+
+    char const * extension = strrchr(base, '.');
+    size_t name_length = extension == NULL ? strlen(base) : (size_t) (extension - base);
+
+    char * name = malloc(name_length + 1);
+    char * path = malloc(strlen(source_path) + 1);
+    if (name == NULL || path == NULL)
+        goto exit;
+
+    memcpy(name, base, name_length);
+    name[name_length] = '\0';
+    strcpy(path, source_path);
+
+    // Only imported names have to be valid module names, characters of the file name a module name cannot contain are replaced by underscores
+    for (size_t i = 0; i < name_length; i++)
+        if ((name[i] < 'a' || name[i] > 'z') && (name[i] < 'A' || name[i] > 'Z'))
+            name[i] = '_';
+
+    if (name_length == 0) {
+        free(name);
+        name = strdup("main");
+        if (name == NULL)
+            goto exit;
+    }
+
+    addModule(driver, name, path);
+    free(name);
+
+    // Modules are added as they are first imported and each one added is parsed once, by whichever worker gets to it
+    runPool(driver);
+
+    return errorVectorSize(driver -> errors) == 0;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: loadModules.\nMessage: %s\n", __FILE__, __LINE__, driver ? driver -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Orders the loaded modules so every module comes after the modules it imports.
+ * Import cycles make such an order impossible so they are reported as errors.
+ *
+ * This is a depth first walk of the import graph with an explicit stack, modules are scheduled once every module they import is.
+ * Each module and each import is visited once so scheduling takes time linear in the size of the graph.
+ *
+ * @param       driver the driver which modules to order.
+ *
+ * @return      true if the modules could be ordered, false if there is an import cycle.
+ */
+bool scheduleModules(struct Driver * const driver) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    size_t count = vectorSize(driver -> modules);
+    uint8_t * states = calloc(count > 0 ? count : 1, sizeof *states);
+    if (states == NULL)
+        goto exit;
+
+    struct VisitVector * stack = newVisitVector(0, driver -> message);
+    uint32VectorClear(driver -> order);
+    bool acyclic = true;
+
+    for (uint32_t root = 0; root < count; root++) {
+        if (states[root] != UNVISITED)
+            continue;
+
+        states[root] = IN_PROGRESS;
+        visitVectorPushback(stack, (struct Visit) { .module = root, .next = 0 });
+
+        while (visitVectorSize(stack) > 0) {
+            struct Visit * visit = visitVectorData(stack) + visitVectorSize(stack) - 1;
+            struct Module * module = vectorAt(driver -> modules, visit -> module);
+
+            // Every import was followed so the module can be compiled once the modules it imports are
+            if (visit -> next == importVectorSize(module -> imports)) {
+                states[visit -> module] = DONE;
+                uint32VectorPushback(driver -> order, visit -> module);
+                visitVectorPopback(stack);
+                continue;
+            }
+
+            // We move past the import before following it since pushing on the stack may move the visit
+            uint32_t imported = importVectorData(module -> imports)[visit -> next++].module;
+            if (states[imported] == IN_PROGRESS) {
+                reportCycle(driver, stack, imported);
+                acyclic = false;
+            }
+            else if (states[imported] == UNVISITED) {
+                states[imported] = IN_PROGRESS;
+                visitVectorPushback(stack, (struct Visit) { .module = imported, .next = 0 });
+            }
+        }
+    }
+
+    deleteVisitVector(& stack);
+    free(states);
+    return acyclic;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: scheduleModules.\nMessage: %s\n", __FILE__, __LINE__, driver ? driver -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of modules loaded.
+ *
+ * @param       driver the driver which modules to count.
+ *
+ * @return      the number of modules.
+ */
+size_t modulesCount(struct Driver const * const driver) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    return vectorSize(driver -> modules);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: modulesCount.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the module at the given index, the main module being at index 0.
+ *
+ * @param       driver the driver which module to return.
+ * @param       index the index of the module.
+ *
+ * @return      the module.
+ */
+struct Module * driverModule(struct Driver const * const driver, size_t index) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    return vectorAt(driver -> modules, index);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: driverModule.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the indices of the modules in compilation order, as set by scheduleModules.
+ *
+ * @param       driver the driver which modules order to return.
+ *
+ * @return      modulesCount indices of modules, every module after the modules it imports.
+ */
+uint32_t const * compilationOrder(struct Driver const * const driver) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    return uint32VectorData(driver -> order);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: compilationOrder.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Prints every error found in every module on the standard error, ordered by file then by position.
+ *
+ * @param       driver the driver which errors to print.
+ *
+ * @return      the number of errors printed.
+ */
+size_t reportDriverErrors(struct Driver * const driver) {
+    char const * message = "The parameter <driver> cannot be NULL.";
+    if (driver == NULL)
+        goto exit;
+
+    size_t count = errorVectorSize(driver -> errors);
+    printErrors(driver -> sources, errorVectorData(driver -> errors), count);
+    if (errorLimitReached(driver))
+        fprintf(stderr, "Too many errors, stopped after %zu.\n", count);
+
+    return count;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: reportDriverErrors.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Creates a module for the given source file, to be parsed later, and registers it under its name.
+ * While the workers run, the caller must hold the lock of the driver.
+ *
+ * @param       driver the driver to add the module to.
+ * @param       fqn_path the path form of the FQN of the module, such as a/b/c.
+ * @param       path the path to the source file, owned by the module from now on.
+ *
+ * @return      the index of the new module.
+ */
+static uint32_t addModule(struct Driver * const driver, char const * fqn_path, char * path) {
+    struct Module * module = malloc(sizeof *module);
+    if (module == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: addModule.\nMessage: %s\n", __FILE__, __LINE__, driver -> message);
+        exit(74);
+    }
+
+    module -> path = path;
+    module -> source = NO_SOURCE;
+    module -> program = newProgram(fqn_path, driver -> message);
+    module -> interface = NULL;
+    module -> imports = newImportVector(0, driver -> message);
+    module -> waiting = 0;
+    module -> compiled = false;
+    module -> dependents = newUint32Vector(0, driver -> message);
+    module -> fingerprint = 0;
+    module -> changed = newUint32Vector(0, driver -> message);
+
+    uint32_t index = (uint32_t) vectorSize(driver -> modules);
+    vectorPushback(driver -> modules, module);
+
+    uint32_t name = fqnNameSymbol(getFQN(module -> program));
+    while (uint32VectorSize(driver -> modules_by_name) <= name)
+        uint32VectorPushback(driver -> modules_by_name, 0);
+    uint32VectorData(driver -> modules_by_name)[name] = index + 1;
+
+    return index;
+}
+
+
+/**
+ * Returns the index of the module with the given name.
+ *
+ * @param       driver the driver to look the module up in.
+ * @param       name the symbol of the name of the module.
+ *
+ * @return      the index of the module, UINT32_MAX if no module has the name.
+ */
+static uint32_t findModule(struct Driver const * const driver, uint32_t name) {
+    if (name >= uint32VectorSize(driver -> modules_by_name))
+        return UINT32_MAX;
+
+    // Names that are not modules map to zero, which wraps around to UINT32_MAX
+    return uint32VectorData(driver -> modules_by_name)[name] - 1;
+}
+
+
+/**
+ * Compiles the modules of the driver on jobs threads, starting from the main module, until no worker has anything left to do.
+ * The calling thread is the first worker.
+ *
+ * @param       driver the driver which modules to compile.
+ */
+static void runPool(struct Driver * const driver) {
+    struct Pool pool;
+    pool.driver = driver;
+    pool.count = driver -> jobs;
+    pool.workers = malloc(pool.count * sizeof *pool.workers);
+    if (pool.workers == NULL)
+        goto exit;
+
+    atomic_init(& pool.pending, 0);
+    atomic_init(& pool.pushes, 0);
+    if (pthread_mutex_init(& pool.idle_lock, NULL) != 0 || pthread_cond_init(& pool.idle, NULL) != 0)
+        goto exit;
+
+    for (size_t i = 0; i < pool.count; i++) {
+        pool.workers[i].pool = & pool;
+        pool.workers[i].deque = newWorkDeque(WORKER_DEQUE_CAPACITY, driver -> message);
+        pool.workers[i].id = i;
+    }
+
+    // The other workers steal from the first one until parsing the main module gives them more to do
+    pushTask(& pool.workers[0], 0, TASK_PARSE);
+    for (size_t i = 1; i < pool.count; i++)
+        if (pthread_create(& pool.workers[i].thread, NULL, runWorker, & pool.workers[i]) != 0)
+            goto exit;
+
+    runWorker(& pool.workers[0]);
+    for (size_t i = 1; i < pool.count; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+
+    for (size_t i = 0; i < pool.count; i++)
+        deleteWorkDeque(& pool.workers[i].deque);
+    free(pool.workers);
+    pthread_cond_destroy(& pool.idle);
+    pthread_mutex_destroy(& pool.idle_lock);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: runPool.\nMessage: %s\n", __FILE__, __LINE__, driver -> message);
+    exit(74);
+}
+
+
+/**
+ * Runs tasks, its own first then stolen ones, until every task of the pool is done.
+ *
+ * @param       argument the worker.
+ *
+ * @return      NULL.
+ */
+static void * runWorker(void * argument) {
+    struct Worker * worker = argument;
+    struct Pool * pool = worker -> pool;
+
+    uint32_t task;
+    for (;;) {
+        size_t pushes = atomic_load_explicit(& pool -> pushes, memory_order_acquire);
+        if (workDequeTake(worker -> deque, & task) || stealTask(worker, & task)) {
+            if ((task & 1) == TASK_PARSE)
+                parseModule(worker, task >> 1);
+            else
+                compileModule(worker, task >> 1);
+
+            // The last task done wakes every idle worker up so they can stop
+            if (atomic_fetch_sub_explicit(& pool -> pending, 1, memory_order_acq_rel) == 1) {
+                pthread_mutex_lock(& pool -> idle_lock);
+                pthread_cond_broadcast(& pool -> idle);
+                pthread_mutex_unlock(& pool -> idle_lock);
+            }
+            continue;
+        }
+
+        // Nothing to steal but a running task may still push more so we only stop once every task is done
+        // Until then we wait for a task to be pushed, unless one was pushed since we started looking
+        pthread_mutex_lock(& pool -> idle_lock);
+        bool done = atomic_load_explicit(& pool -> pending, memory_order_acquire) == 0;
+        if (done == false && atomic_load_explicit(& pool -> pushes, memory_order_acquire) == pushes)
+            pthread_cond_wait(& pool -> idle, & pool -> idle_lock);
+        pthread_mutex_unlock(& pool -> idle_lock);
+
+        if (done)
+            break;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Steals a task from the other workers, trying each of them in turn starting with the next one.
+ *
+ * @param       worker the worker looking for a task.
+ * @param       task set to the stolen task on success.
+ *
+ * @return      true if a task was stolen, false if no other worker had one.
+ */
+static bool stealTask(struct Worker * const worker, uint32_t * task) {
+    struct Pool * pool = worker -> pool;
+    for (size_t i = 1; i < pool -> count; i++) {
+        struct Worker * victim = & pool -> workers[(worker -> id + i) % pool -> count];
+
+        // An abort means another thief won the race, the victim may still have tasks
+        enum StealResult result;
+        while ((result = workDequeSteal(victim -> deque, task)) == STEAL_ABORT)
+            ;
+
+        if (result == STEAL_SUCCESS)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * Pushes a task on the deque of the worker and wakes an idle worker up to steal it.
+ *
+ * @param       worker the worker that found the task.
+ * @param       module the index of the module the task is about.
+ * @param       kind what the task does to the module.
+ */
+static void pushTask(struct Worker * const worker, uint32_t module, enum TaskKind kind) {
+    struct Pool * pool = worker -> pool;
+    atomic_fetch_add_explicit(& pool -> pending, 1, memory_order_acq_rel);
+    workDequePush(worker -> deque, module << 1 | kind);
+
+    // An idle worker can steal the task
+    pthread_mutex_lock(& pool -> idle_lock);
+    atomic_fetch_add_explicit(& pool -> pushes, 1, memory_order_acq_rel);
+    pthread_cond_signal(& pool -> idle);
+    pthread_mutex_unlock(& pool -> idle_lock);
+}
+
+
+/**
+ * Loads, lexes and parses a module then resolves its imports, adding the modules it imports to the driver and pushing a task to parse each new one.
+ * Imported modules which interface is cached are not lexed nor parsed, their imports are read from the interface.
+ * Once parsed, the module waits for the modules it imports to be compiled, unless they all are already.
+ *
+ * @param       worker the worker parsing the module.
+ * @param       index the index of the module.
+ */
+static void parseModule(struct Worker * const worker, uint32_t index) {
+    struct Driver * driver = worker -> pool -> driver;
+
+    // Other workers may be adding modules so the vector of modules is only read under lock, the module itself is ours
+    pthread_mutex_lock(& driver -> lock);
+    struct Module * module = vectorAt(driver -> modules, index);
+    bool stopped = errorLimitReached(driver);
+    if (stopped)
+        driver -> incomplete = true;
+    size_t limit = driver -> error_limit > 0 ? driver -> error_limit - errorVectorSize(driver -> errors) : 0;
+    pthread_mutex_unlock(& driver -> lock);
+
+    if (stopped)
+        return;
+
+    module -> source = loadSource(driver -> sources, module -> path);
+    struct SourceFile const * file = getSource(driver -> sources, module -> source) -> file;
+
+    // The main module is always parsed since it is the one being compiled
+    uint64_t key = 0;
+    if (driver -> cache != NULL) {
+        key = interfaceKey(file);
+        if (index > 0)
+            module -> interface = loadInterface(driver -> cache, key, file);
+    }
+
+    // Everything the driver needs from a module loaded from the cache is in its interface so its source is not kept around
+    bool failed = false;
+    if (module -> interface == NULL) {
+        failed = parseSource(module, limit, driver);
+        if (failed == false && driver -> cache != NULL)
+            storeInterface(driver -> cache, key, file, module -> program);
+    }
+    else {
+        unloadSource(driver -> sources, module -> source);
+    }
+
+    uint32_t imports_count = module -> interface != NULL ? interfaceImportsCount(module -> interface) : (uint32_t) declarationsCount(module -> program);
+    for (uint32_t i = 0; i < imports_count; i++) {
+        char * name = NULL;
+        uint32_t token = i;
+        if (module -> interface != NULL) {
+            struct InterfaceImport const * import = & module -> interface -> imports[i];
+            name = malloc(import -> length + 1);
+            if (name == NULL)
+                goto exit;
+
+            memcpy(name, interfaceString(module -> interface, import -> name), import -> length);
+            name[import -> length] = '\0';
+        }
+        else {
+            uint32_t declaration = programDeclarations(module -> program)[i];
+            if (astKind(programAst(module -> program), declaration) != NODE_IMPORT)
+                continue;
+
+            name = programImportName(module -> program, declaration);
+            token = astToken(programAst(module -> program), declaration);
+        }
+
+        uint32_t added = UINT32_MAX;
+        if (resolveImport(driver, index, name, token, & added) == false)
+            failed = true;
+        if (added != UINT32_MAX)
+            pushTask(worker, added, TASK_PARSE);
+        free(name);
+    }
+
+    // A module with errors never gets compiled, nor do the modules that import it
+    if (failed)
+        return;
+
+    pthread_mutex_lock(& driver -> lock);
+    for (size_t i = 0; i < importVectorSize(module -> imports); i++) {
+        uint32_t imported = importVectorData(module -> imports)[i].module;
+        struct Module * dependency = vectorAt(driver -> modules, imported);
+        if (dependency -> compiled == false) {
+            module -> waiting++;
+            uint32VectorPushback(dependency -> dependents, index);
+        }
+    }
+
+    bool ready = module -> waiting == 0;
+    pthread_mutex_unlock(& driver -> lock);
+
+    if (ready)
+        pushTask(worker, index, TASK_COMPILE);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: parseModule.\nMessage: %s\n", __FILE__, __LINE__, driver -> message);
+    exit(74);
+}
+
+
+/**
+ * Lexes and parses the source of a module into its program and records the errors found.
+ *
+ * @param       module the module to parse, which file is loaded.
+ * @param       limit the number of errors left before the error limit of the driver is reached, 0 for no limit.
+ * @param       driver the driver which collects the errors.
+ *
+ * @return      true if the source has errors, false otherwise.
+ */
+static bool parseSource(struct Module * const module, size_t limit, struct Driver * const driver) {
+    // The parser gets whatever is left of the error limit so the limit holds across modules
+    struct Lexer * lexer = newLexer(driver -> sources, module -> source);
+    struct Parser * parser = newParser(lexer, module -> program);
+    setErrorLimit(parser, limit);
+    parse(parser);
+
+    // Modules parsed at the same time may each have used up what was left of the limit so we only keep as many errors as it still allows
+    pthread_mutex_lock(& driver -> lock);
+    size_t errors_count = errorVectorSize(parser -> errors);
+    if (driver -> error_limit > 0 && errors_count > driver -> error_limit - errorVectorSize(driver -> errors))
+        errors_count = driver -> error_limit - errorVectorSize(driver -> errors);
+    errorVectorAppend(driver -> errors, errorVectorData(parser -> errors), errors_count);
+    pthread_mutex_unlock(& driver -> lock);
+
+    bool failed = errorVectorSize(parser -> errors) > 0;
+    deleteParser(& parser);
+    deleteLexer(& lexer);
+    return failed;
+}
+
+
+/**
+ * Runs the phases after parsing on a module which imports all went through them, then releases the modules that were waiting on it.
+ * Parsing is the last phase of the front-end for now so all there is to do is to find the declarations later phases will have to check again.
+ * Modules caught in an import cycle wait on each other forever: they are never compiled and scheduleModules() reports the cycle.
+ *
+ * @param       worker the worker compiling the module.
+ * @param       index the index of the module.
+ */
+static void compileModule(struct Worker * const worker, uint32_t index) {
+    struct Driver * driver = worker -> pool -> driver;
+
+    pthread_mutex_lock(& driver -> lock);
+    struct Module * module = vectorAt(driver -> modules, index);
+    pthread_mutex_unlock(& driver -> lock);
+
+    fingerprintModule(driver, module);
+
+    pthread_mutex_lock(& driver -> lock);
+    module -> compiled = true;
+    uint32_t const * dependents = uint32VectorData(module -> dependents);
+    for (size_t i = 0; i < uint32VectorSize(module -> dependents); i++) {
+        struct Module * dependent = vectorAt(driver -> modules, dependents[i]);
+        if (--dependent -> waiting == 0)
+            pushTask(worker, dependents[i], TASK_COMPILE);
+    }
+    pthread_mutex_unlock(& driver -> lock);
+}
+
+
+/**
+ * Fingerprints the declarations of a module and compares them with those of the previous compilation, found in the cache, to find the declarations to check again.
+ * The modules it imports are compiled so their interface fingerprints are known.
+ *
+ * @param       driver the driver the module belongs to.
+ * @param       module the module to fingerprint.
+ */
+static void fingerprintModule(struct Driver * const driver, struct Module * const module) {
+    uint32VectorClear(module -> changed);
+    if (driver -> cache == NULL) {
+        for (uint32_t i = 0; i < declarationsCount(module -> program); i++)
+            uint32VectorPushback(module -> changed, i);
+        return;
+    }
+
+    // A module loaded from the cache has the source it had when it was cached so none of its declarations changed, its interface tells what it offers
+    struct Interface const * interface = module -> interface;
+    if (interface != NULL) {
+        uint64_t fingerprint = FINGERPRINT_SEED;
+        for (uint32_t i = 0; i < interfaceImportsCount(interface); i++)
+            fingerprint = fingerprintSignature(fingerprint, NODE_IMPORT, interfaceString(interface, interface -> imports[i].name), interface -> imports[i].length);
+        for (uint32_t i = 0; i < interfaceBindingsCount(interface); i++)
+            fingerprint = fingerprintSignature(fingerprint, interface -> bindings[i].kind, interfaceString(interface, interface -> bindings[i].name), interface -> bindings[i].length);
+
+        module -> fingerprint = fingerprint;
+        return;
+    }
+
+    struct FingerprintVector * prints = newFingerprintVector(0, driver -> message);
+    struct FingerprintVector * previous = newFingerprintVector(0, driver -> message);
+    struct Uint32Vector * references = newUint32Vector(0, driver -> message);
+    struct Uint32Vector * offsets = newUint32Vector(0, driver -> message);
+    module -> fingerprint = fingerprintProgram(module -> program, prints, references, offsets);
+
+    // An import changes when the interface of the imported module does
+    pthread_mutex_lock(& driver -> lock);
+    struct Fingerprint * data = fingerprintVectorData(prints);
+    for (size_t i = 0; i < fingerprintVectorSize(prints); i++) {
+        if (data[i].kind == NODE_IMPORT) {
+            struct Module const * imported = vectorAt(driver -> modules, findModule(driver, data[i].name));
+            data[i].value = imported -> fingerprint;
+        }
+    }
+    pthread_mutex_unlock(& driver -> lock);
+
+    if (loadFingerprints(driver -> cache, module -> path, previous))
+        changedDeclarations(prints, references, offsets, previous, module -> changed);
+    else
+        for (uint32_t i = 0; i < fingerprintVectorSize(prints); i++)
+            uint32VectorPushback(module -> changed, i);
+
+    // The fingerprints on disk are left alone when the module has the same declarations as the last time
+    if (uint32VectorSize(module -> changed) > 0 || fingerprintVectorSize(prints) != fingerprintVectorSize(previous))
+        storeFingerprints(driver -> cache, module -> path, prints);
+    deleteUint32Vector(& offsets);
+    deleteUint32Vector(& references);
+    deleteFingerprintVector(& previous);
+    deleteFingerprintVector(& prints);
+}
+
+
+/**
+ * Finds the module imported by an import declaration, adding it to the driver the first time it is imported.
+ *
+ * @param       driver the driver the importing module belongs to.
+ * @param       index the index of the importing module.
+ * @param       name the dotted name of the imported module.
+ * @param       token where errors about the import are reported, see struct Import.
+ * @param       added set to the index of the imported module if this import added it to the driver, left untouched otherwise.
+ *
+ * @return      true if the imported module was found, false if an error was reported.
+ */
+static bool resolveImport(struct Driver * const driver, uint32_t index, char const * name, uint32_t token, uint32_t * added) {
+    pthread_mutex_lock(& driver -> lock);
+    struct Module * module = vectorAt(driver -> modules, index);
+    bool valid = fqnIsValidName(name);
+    if (valid == false) {
+        driverError(driver, IMPORTER_ERROR, module, token, formatMessage(driver, "Invalid module name <%s>: module names can only contain letters, underscores and dots.", name));
+        driver -> incomplete = true;
+    }
+    pthread_mutex_unlock(& driver -> lock);
+
+    if (valid == false)
+        return false;
+
+    // The lookup and the addition happen under the same lock so two workers importing the same module do not both add it
+    struct FQN * fqn = fqnFromName(name, driver -> message);
+    pthread_mutex_lock(& driver -> lock);
+    uint32_t imported = findModule(driver, fqnNameSymbol(fqn));
+    if (imported == UINT32_MAX) {
+        char * path = searchPathResolve(driver -> search_path, fqn);
+        if (path == NULL) {
+            driverError(driver, IMPORTER_ERROR, module, token, formatMessage(driver, "Module <%s> was not found in the search path.", name));
+            driver -> incomplete = true;
+        }
+        else
+            imported = * added = addModule(driver, fqnPath(fqn), path);
+    }
+    pthread_mutex_unlock(& driver -> lock);
+
+    deleteFQN(& fqn);
+    if (imported == UINT32_MAX)
+        return false;
+
+    // Importing a module twice does not make it more imported
+    for (size_t i = 0; i < importVectorSize(module -> imports); i++)
+        if (importVectorData(module -> imports)[i].module == imported)
+            return true;
+
+    importVectorPushback(module -> imports, (struct Import) { .module = imported, .token = token });
+    return true;
+}
+
+
+/**
+ * Reports the import cycle closed by the import of the given module by the module on top of the walk stack.
+ * The cycle is made of the modules on the stack from the imported module up.
+ *
+ * @param       driver the driver the modules belong to.
+ * @param       stack the walk stack, its top module being the importing module.
+ * @param       imported the index of the imported module, which is on the stack.
+ */
+static void reportCycle(struct Driver * const driver, struct VisitVector const * const stack, uint32_t imported) {
+    struct Visit const * visits = visitVectorData(stack);
+    size_t top = visitVectorSize(stack) - 1;
+    size_t first = top;
+    while (visits[first].module != imported)
+        first--;
+
+    // The cycle reads a imports b imports ... imports a
+    size_t length = 0;
+    for (size_t i = first; i <= top + 1; i++) {
+        struct Module const * module = vectorAt(driver -> modules, i <= top ? visits[i].module : imported);
+        length += strlen(fqnName(getFQN(module -> program))) + strlen(" imports ");
+    }
+
+    char * cycle = arenaAlloc(driver -> arena, length + 1);
+    char * end = cycle;
+    for (size_t i = first; i <= top + 1; i++) {
+        struct Module const * module = vectorAt(driver -> modules, i <= top ? visits[i].module : imported);
+        end += sprintf(end, i <= top ? "%s imports " : "%s", fqnName(getFQN(module -> program)));
+    }
+
+    // The error is reported at the import that closes the cycle, the one the top module was following
+    struct Module * importer = vectorAt(driver -> modules, visits[top].module);
+    uint32_t token = importVectorData(importer -> imports)[visits[top].next - 1].token;
+    driverError(driver, IMPORTER_ERROR, importer, token, formatMessage(driver, "Import cycle: %s.", cycle));
+}
+
+
+/**
+ * Records an error found in a module unless the error limit was already reached.
+ * While the workers run, the caller must hold the lock of the driver.
+ *
+ * @param       driver the driver that found the error.
+ * @param       type the kind of error.
+ * @param       module the module in which the error was found.
+ * @param       token the import at which the error was found, see struct Import.
+ * @param       message the description of the error, which must live as long as the driver.
+ */
+static void driverError(struct Driver * const driver, enum ErrorType type, struct Module * const module, uint32_t token, char const * message) {
+    if (errorLimitReached(driver))
+        return;
+
+    errorVectorPushback(driver -> errors, createError(type, importLocation(driver, module, token), message));
+}
+
+
+/**
+ * Returns the global offset of the import keyword of an import of a module, found from the position the interface recorded when the module was loaded from the cache.
+ *
+ * @param       driver the driver which source manager holds the source of the module.
+ * @param       module the importing module.
+ * @param       token the import, see struct Import.
+ *
+ * @return      the global offset of the import keyword.
+ */
+static uint32_t importLocation(struct Driver * const driver, struct Module const * const module, uint32_t token) {
+    if (module -> interface == NULL)
+        return tokenBufferLocation(programTokens(module -> program), token);
+
+    return sourceLocation(driver -> sources, module -> source, module -> interface -> imports[token].offset);
+}
+
+
+/**
+ * Formats an error message into the arena of the driver so it lives as long as the driver.
+ * While the workers run, the caller must hold the lock of the driver.
+ *
+ * @param       driver the driver which arena to format the message into.
+ * @param       format the printf format of the message.
+ *
+ * @return      the formatted message.
+ */
+static char const * formatMessage(struct Driver * const driver, char const * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (length < 0) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: formatMessage.\nMessage: %s\n", __FILE__, __LINE__, driver -> message);
+        exit(74);
+    }
+
+    char * message = arenaAlloc(driver -> arena, (size_t) length + 1);
+    va_start(arguments, format);
+    vsnprintf(message, (size_t) length + 1, format, arguments);
+    va_end(arguments);
+
+    return message;
+}
+
+
+/**
+ * Returns true if the driver collected as many errors as it is allowed to.
+ *
+ * @param       driver the driver which errors to count.
+ *
+ * @return      true if the error limit is reached, false otherwise or if there is no limit.
+ */
+static bool errorLimitReached(struct Driver const * const driver) {
+    return driver -> error_limit > 0 && errorVectorSize(driver -> errors) >= driver -> error_limit;
+}
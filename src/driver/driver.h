@@ -0,0 +1,239 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef DRIVER_DRIVER_H
+#define DRIVER_DRIVER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "driver/interface_cache.h"
+#include "driver/search_path.h"
+#include "common/source_manager.h"
+#include "common/ast/program.h"
+#include "utils/result.h"
+#include "utils/vector.h"
+#include "utils/arena.h"
+#include "utils/file.h"
+
+
+/* An import of a module by another module. */
+struct Import {
+    /* The index of the imported module in the driver. */
+    uint32_t module;
+
+    /* Where errors about the import are reported: the index of the import keyword in the tokens of the importing module,
+     * or the index of the import in the interface of the importing module when it was loaded from the cache.
+     */
+    uint32_t token;
+};
+
+VECTOR_DECLARE(ImportVector, importVector, struct Import, 4)
+
+/* A source file taking part in the compilation, together with what the compiler knows about it so far. */
+struct Module {
+    /* The path to the source file, as given on the command line for the main module and as found on the search path for the others. */
+    char * path;
+
+    /* The id of the source file in the source manager of the driver, NO_SOURCE until the module is loaded. */
+    uint16_t source;
+
+    /* The program holds the FQN of the module, its tokens and its syntax tree. */
+    struct Program * program;
+
+    /* The interface of the module when it was found in the cache, in which case the module was neither lexed nor parsed and its program only has a FQN. */
+    struct Interface * interface;
+
+    /* The modules this module imports, each module appears once. */
+    struct ImportVector * imports;
+
+    /* A module is ready for the phases after parsing once every module it imports went through them.
+     * waiting counts the imported modules that did not yet, dependents lists the modules waiting on this one.
+     */
+    uint32_t waiting;
+    bool compiled;
+    struct Uint32Vector * dependents;
+
+    /* Set once the module is compiled when the driver has a cache.
+     * The interface fingerprint changes whenever what the module offers to the modules importing it does.
+     * The declarations to check again are given by their position in the declarations of the program: those which changed since the previous compilation and those depending on them.
+     * Without a cache there is nothing to compare with so every declaration is to be checked.
+     */
+    uint64_t fingerprint;
+    struct Uint32Vector * changed;
+};
+
+/* The compilation of a module and of every module it imports, directly or not.
+ * Modules are loaded starting from the main module by following import declarations through the search path.
+ * Once every module is loaded, they are scheduled so each module comes after the modules it imports.
+ *
+ * Modules are lexed and parsed by a pool of jobs workers, each module is handed to the phases after parsing as soon as the modules it imports are done with them.
+ * The workers share the modules, the errors and the arena under lock.
+ */
+struct Driver {
+    struct SearchPath * search_path;
+
+    /* Where the interfaces of imported modules are cached, NULL to always parse them. */
+    struct InterfaceCache * cache;
+
+    /* Every module loaded so far, the main module first. */
+    struct Vector * modules;
+
+    /* Maps the symbol of the name of each module to its index plus one, zero for names that are not modules. Symbols are small integers so a plain array does. */
+    struct Uint32Vector * modules_by_name;
+
+    /* Set while loading when an import names no module of the search path or when the error limit stops modules from being parsed.
+     * The import graph then misses modules so it is not scheduled.
+     */
+    bool incomplete;
+
+    /* Module indices in compilation order: every module comes after the modules it imports. */
+    struct Uint32Vector * order;
+
+    /* Errors found in every module, compilation stops once there are error_limit of them (0 means no limit). */
+    struct ErrorVector * errors;
+    size_t error_limit;
+
+    /* Owns the source file of every module, the sources of modules loaded from the cache are released once their interface is. */
+    struct SourceManager * sources;
+
+    /* The number of threads modules are compiled on. */
+    size_t jobs;
+
+    pthread_mutex_t lock;
+
+    /* Error messages built while compiling live here until the driver is released. */
+    struct Arena * arena;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes a driver with an empty search path.
+ *
+ * @param       load_mode how to bring the source files into memory.
+ * @param       message error message to display in case any operation on the driver fails.
+ *
+ * @return      the newly created driver.
+ */
+struct Driver * newDriver(enum LoadMode load_mode, char const * message);
+
+
+/**
+ * Frees the memory occupied by the driver and by every module it loaded.
+ *
+ * @param       driver pointer to memory occupied by the driver.
+ */
+void deleteDriver(struct Driver ** const driver);
+
+
+/**
+ * Sets the number of errors after which the driver gives up.
+ *
+ * @param       driver the driver which error limit to set.
+ * @param       limit the maximum number of errors to collect, 0 to collect every error.
+ */
+void setDriverErrorLimit(struct Driver * const driver, size_t limit);
+
+
+/**
+ * Sets the number of threads the driver compiles modules on.
+ *
+ * @param       driver the driver which number of threads to set.
+ * @param       jobs the number of threads, at least 1.
+ */
+void setDriverJobs(struct Driver * const driver, size_t jobs);
+
+
+/**
+ * Makes the driver cache the interfaces of the modules it parses in the given directory,
+ * and use the cached interfaces of imported modules which source did not change instead of parsing them.
+ *
+ * @param       driver the driver which cache to set.
+ * @param       directory the path to the cache directory, created if it does not exist.
+ */
+void setDriverCache(struct Driver * const driver, char const * directory);
+
+
+/**
+ * Loads, lexes and parses the main module then every module it imports, directly or not.
+ * Imported modules are looked up in the search path of the driver and modules are parsed in parallel when the driver has several jobs.
+ *
+ * @param       driver the driver to load the modules into.
+ * @param       source_path the path to the source file of the main module, STANDARD_INPUT_PATH to read it from the standard input.
+ *
+ * @return      true if every module was found and parsed without errors, false otherwise.
+ *              When only syntax errors were found the import graph is whole and the modules can still be scheduled, see Driver.incomplete.
+ */
+bool loadModules(struct Driver * const driver, char const * source_path);
+
+
+/**
+ * Orders the loaded modules so every module comes after the modules it imports.
+ * Import cycles make such an order impossible so they are reported as errors.
+ *
+ * @param       driver the driver which modules to order.
+ *
+ * @return      true if the modules could be ordered, false if there is an import cycle.
+ */
+bool scheduleModules(struct Driver * const driver);
+
+
+/**
+ * Returns the number of modules loaded.
+ *
+ * @param       driver the driver which modules to count.
+ *
+ * @return      the number of modules.
+ */
+size_t modulesCount(struct Driver const * const driver);
+
+
+/**
+ * Returns the module at the given index, the main module being at index 0.
+ *
+ * @param       driver the driver which module to return.
+ * @param       index the index of the module.
+ *
+ * @return      the module.
+ */
+struct Module * driverModule(struct Driver const * const driver, size_t index);
+
+
+/**
+ * Returns the indices of the modules in compilation order, as set by scheduleModules.
+ *
+ * @param       driver the driver which modules order to return.
+ *
+ * @return      modulesCount indices of modules, every module after the modules it imports.
+ */
+uint32_t const * compilationOrder(struct Driver const * const driver);
+
+
+/**
+ * Prints every error found in every module on the standard error, ordered by file then by position.
+ *
+ * @param       driver the driver which errors to print.
+ *
+ * @return      the number of errors printed.
+ */
+size_t reportDriverErrors(struct Driver * const driver);
+
+#endif
@@ -0,0 +1,530 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "driver/interface_cache.h"
+#include "driver/fingerprint.h"
+#include "common/ast/program.h"
+#include "common/token_buffer.h"
+#include "common/token_type.h"
+#include "common/interner.h"
+#include "common/version.h"
+#include "common/ast/ast.h"
+#include "utils/vector.h"
+#include "utils/file.h"
+
+
+/* Maps the names of the bindings of a module to their position, an open addressing table keyed by symbol. */
+struct NameTable {
+    uint32_t * names;
+    uint32_t * positions;
+    size_t mask;
+};
+
+VECTOR_DEFINE(FingerprintVector, fingerprintVector, struct Fingerprint, 8)
+
+extern inline uint64_t fingerprintBytes(uint64_t hash, void const * bytes, size_t length);
+
+static void newNameTable(struct NameTable * const table, size_t count);
+static void deleteNameTable(struct NameTable * const table);
+static void nameTableAdd(struct NameTable * const table, uint32_t name, uint32_t position);
+static uint32_t nameTableFind(struct NameTable const * const table, uint32_t name);
+static bool importsChanged(struct FingerprintVector const * const prints, struct FingerprintVector const * const previous);
+static uint64_t fingerprintsKey(char const * path);
+
+
+/**
+ * Folds the kind and the name of a declaration into the interface fingerprint of its module.
+ * The interface fingerprint folds the imports in source order then the bindings in source order,
+ * which can be done from the syntax tree of the module as well as from its cached interface.
+ *
+ * @param       hash the interface fingerprint so far, FINGERPRINT_SEED to start a new one.
+ * @param       kind the kind of the declaration.
+ * @param       name the name of the declaration.
+ * @param       length the length of the name.
+ *
+ * @return      the interface fingerprint including the declaration.
+ */
+uint64_t fingerprintSignature(uint64_t hash, uint32_t kind, char const * name, size_t length) {
+    uint64_t size = length;
+    hash = fingerprintBytes(hash, & kind, sizeof kind);
+    hash = fingerprintBytes(hash, & size, sizeof size);
+    return fingerprintBytes(hash, name, length);
+}
+
+
+/**
+ * Fingerprints every top level declaration of a program parsed without errors and records the names each binding refers to.
+ * Imports get the fingerprint of their name, the caller replaces it with the interface fingerprint of the imported module.
+ *
+ * Nodes are appended after their children so the nodes of a declaration are the ones between the previous declaration and itself, in post-order.
+ * Hashing them in that order, with the number of children of each, is enough to tell two trees apart.
+ *
+ * @param       program the program which declarations to fingerprint.
+ * @param       prints receives one fingerprint per declaration, in source order.
+ * @param       references receives the symbols of the names referred to by each declaration, one after the other.
+ * @param       offsets receives where the references of each declaration start in references, followed by the total number of references.
+ *
+ * @return      the interface fingerprint of the program.
+ */
+uint64_t fingerprintProgram(struct Program const * const program, struct FingerprintVector * const prints, struct Uint32Vector * const references, struct Uint32Vector * const offsets) {
+    char const * message = "The parameters cannot be NULL.";
+    if (program == NULL || prints == NULL || references == NULL || offsets == NULL)
+        goto exit;
+
+    struct TokenBuffer const * tokens = programTokens(program);
+    struct Ast const * ast = programAst(program);
+    uint32_t const * declarations = programDeclarations(program);
+    size_t count = declarationsCount(program);
+    struct Interner * interner = globalInterner();
+
+    fingerprintVectorClear(prints);
+    uint32VectorClear(references);
+    uint32VectorClear(offsets);
+
+    uint32_t first = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t declaration = declarations[i];
+        uint32_t kind = astKind(ast, declaration);
+        uint32VectorPushback(offsets, (uint32_t) uint32VectorSize(references));
+
+        uint32_t name = NO_SYMBOL;
+        if (kind == NODE_IMPORT) {
+            char * dotted = programImportName(program, declaration);
+            name = internString(interner, dotted, strlen(dotted));
+            free(dotted);
+        }
+        else {
+            name = tokenBufferSymbol(tokens, astToken(ast, astChildren(ast, declaration)[0]));
+        }
+
+        // The name of a binding is one of its nodes but the binding does not refer to itself through it
+        uint32_t name_node = kind == NODE_IMPORT ? NO_NODE : astChildren(ast, declaration)[0];
+        uint64_t hash = FINGERPRINT_SEED;
+        for (uint32_t node = first; node <= declaration; node++) {
+            uint32_t token_index = astToken(ast, node);
+            struct Token token = tokenBufferAt(tokens, token_index);
+            uint8_t node_kind = astKind(ast, node);
+            uint8_t type = token.type;
+            uint32_t children = astChildrenCount(ast, node);
+            hash = fingerprintBytes(hash, & node_kind, sizeof node_kind);
+            hash = fingerprintBytes(hash, & type, sizeof type);
+            hash = fingerprintBytes(hash, & children, sizeof children);
+
+            // Operators are told apart by their type alone so "and" and "&&" fingerprint the same, names and literals need their spelling
+            if (token.type >= AVL_IDENTIFIER && token.type <= AVL_QUANTUM_DEC) {
+                uint64_t length = token.length;
+                hash = fingerprintBytes(hash, & length, sizeof length);
+                hash = fingerprintBytes(hash, tokenBufferLexeme(tokens, token_index), token.length);
+            }
+
+            if (node_kind == NODE_IDENTIFIER && node != name_node && kind != NODE_IMPORT)
+                uint32VectorPushback(references, tokenBufferSymbol(tokens, token_index));
+        }
+
+        fingerprintVectorPushback(prints, (struct Fingerprint) { .value = hash, .name = name, .kind = kind });
+        first = declaration + 1;
+    }
+    uint32VectorPushback(offsets, (uint32_t) uint32VectorSize(references));
+
+    // The interface folds the imports first then the bindings, as the cached interface stores them
+    uint64_t interface = FINGERPRINT_SEED;
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            struct Fingerprint print = fingerprintVectorData(prints)[i];
+            if ((print.kind == NODE_IMPORT) == (pass == 0))
+                interface = fingerprintSignature(interface, print.kind, symbolString(interner, print.name), symbolLength(interner, print.name));
+        }
+    }
+
+    return interface;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: fingerprintProgram.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Finds the declarations that must be checked again since the previous compilation:
+ * the declarations which fingerprint changed, the new ones and every binding that refers, directly or not, to one of them or to a removed binding.
+ * When an import changed, what every name refers to may have changed so every declaration must be checked again.
+ *
+ * @param       prints the fingerprints of the declarations, as filled by fingerprintProgram().
+ * @param       references the names the declarations refer to, as filled by fingerprintProgram().
+ * @param       offsets where the references of each declaration start, as filled by fingerprintProgram().
+ * @param       previous the fingerprints of the previous compilation.
+ * @param       changed receives the positions in prints of the declarations to check again, in increasing order.
+ */
+void changedDeclarations(struct FingerprintVector const * const prints, struct Uint32Vector const * const references, struct Uint32Vector const * const offsets, struct FingerprintVector const * const previous, struct Uint32Vector * const changed) {
+    char const * message = "The parameters cannot be NULL.";
+    if (prints == NULL || references == NULL || offsets == NULL || previous == NULL || changed == NULL)
+        goto exit;
+
+    uint32VectorClear(changed);
+    size_t count = fingerprintVectorSize(prints);
+    struct Fingerprint const * current = fingerprintVectorData(prints);
+    if (importsChanged(prints, previous)) {
+        for (uint32_t i = 0; i < count; i++)
+            uint32VectorPushback(changed, i);
+        return;
+    }
+
+    // Bindings are matched by name across compilations
+    struct NameTable bindings;
+    struct NameTable before;
+    newNameTable(& bindings, count);
+    newNameTable(& before, fingerprintVectorSize(previous));
+    for (uint32_t i = 0; i < count; i++)
+        if (current[i].kind != NODE_IMPORT)
+            nameTableAdd(& bindings, current[i].name, i);
+    for (uint32_t i = 0; i < fingerprintVectorSize(previous); i++)
+        if (fingerprintVectorData(previous)[i].kind != NODE_IMPORT)
+            nameTableAdd(& before, fingerprintVectorData(previous)[i].name, i);
+
+    message = "Ran out of memory while comparing fingerprints.";
+    size_t references_count = uint32VectorSize(references);
+    bool * marked = calloc(count > 0 ? count : 1, sizeof *marked);
+    uint32_t * pending = malloc((count > 0 ? count : 1) * sizeof *pending);
+    uint32_t * dependents_start = calloc(count + 1, sizeof *dependents_start);
+    uint32_t * dependents = malloc((references_count > 0 ? references_count : 1) * sizeof *dependents);
+    if (marked == NULL || pending == NULL || dependents_start == NULL || dependents == NULL)
+        goto exit;
+
+    // The bindings that changed, the new ones and those which refer to a binding that no longer exists are checked again first
+    size_t pending_count = 0;
+    uint32_t const * names = uint32VectorData(references);
+    uint32_t const * starts = uint32VectorData(offsets);
+    for (uint32_t i = 0; i < count; i++) {
+        if (current[i].kind == NODE_IMPORT)
+            continue;
+
+        uint32_t position = nameTableFind(& before, current[i].name);
+        bool seed = position == UINT32_MAX || fingerprintVectorData(previous)[position].value != current[i].value;
+        for (uint32_t j = starts[i]; j < starts[i + 1] && seed == false; j++)
+            seed = nameTableFind(& bindings, names[j]) == UINT32_MAX && nameTableFind(& before, names[j]) != UINT32_MAX;
+
+        if (seed) {
+            marked[i] = true;
+            pending[pending_count++] = i;
+        }
+    }
+
+    // The references are reversed so each binding lists the bindings that refer to it, from dependents[dependents_start[k]] to dependents[dependents_start[k + 1] - 1] for binding k
+    // We count the dependents of each binding, turn the counts into the ends of the ranges then fill each range backwards, which leaves its start behind
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t j = starts[i]; j < starts[i + 1]; j++) {
+            uint32_t referred = nameTableFind(& bindings, names[j]);
+            if (referred != UINT32_MAX)
+                dependents_start[referred]++;
+        }
+    }
+
+    for (uint32_t i = 1; i < count; i++)
+        dependents_start[i] += dependents_start[i - 1];
+    dependents_start[count] = count > 0 ? dependents_start[count - 1] : 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t j = starts[i]; j < starts[i + 1]; j++) {
+            uint32_t referred = nameTableFind(& bindings, names[j]);
+            if (referred != UINT32_MAX)
+                dependents[--dependents_start[referred]] = i;
+        }
+    }
+
+    // Then every binding referring to a binding checked again is checked again too, each binding being queued once
+    while (pending_count > 0) {
+        uint32_t binding = pending[--pending_count];
+        for (uint32_t j = dependents_start[binding]; j < dependents_start[binding + 1]; j++) {
+            uint32_t dependent = dependents[j];
+            if (marked[dependent] == false) {
+                marked[dependent] = true;
+                pending[pending_count++] = dependent;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+        if (marked[i])
+            uint32VectorPushback(changed, i);
+
+    free(dependents);
+    free(dependents_start);
+    free(pending);
+    free(marked);
+    deleteNameTable(& before);
+    deleteNameTable(& bindings);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: changedDeclarations.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Loads the fingerprints the previous compilation of a source file left in the cache.
+ *
+ * @param       cache the cache the fingerprints are stored in.
+ * @param       path the path to the source file.
+ * @param       prints receives the fingerprints, their names interned in the global interner.
+ *
+ * @return      true if fingerprints were found, false if the file was never compiled with this cache and this compiler.
+ */
+bool loadFingerprints(struct InterfaceCache const * const cache, char const * path, struct FingerprintVector * const prints) {
+    char const * message = "The parameters cannot be NULL.";
+    if (cache == NULL || path == NULL || prints == NULL)
+        goto exit;
+
+    fingerprintVectorClear(prints);
+    char * prints_path = cacheFilePath(cache, fingerprintsKey(path), FINGERPRINTS_EXTENSION);
+    if (fileExists(prints_path) == false) {
+        free(prints_path);
+        return false;
+    }
+
+    struct SourceFile * file = loadFile(prints_path, LOAD_MAP);
+    struct FingerprintsHeader const * header = (struct FingerprintsHeader const *) file -> content;
+    struct FingerprintRecord const * records = (struct FingerprintRecord const *) (header + 1);
+
+    // Files that are truncated or were written by another compiler are ignored, the next store replaces them
+    char version[sizeof header -> version] = { 0 };
+    strncpy(version, AVALON_VERSION, sizeof version);
+    bool valid = file -> length >= sizeof *header
+        && header -> magic == FINGERPRINTS_MAGIC && header -> format == FINGERPRINTS_FORMAT && memcmp(header -> version, version, sizeof version) == 0
+        && file -> length == sizeof *header + (uint64_t) header -> count * sizeof *records + header -> strings_size;
+
+    if (valid) {
+        char const * strings = (char const *) (records + header -> count);
+        struct Interner * interner = globalInterner();
+        lockInterner(interner);
+        for (uint32_t i = 0; i < header -> count && valid; i++) {
+            valid = (uint64_t) records[i].name + records[i].length <= header -> strings_size;
+            if (valid)
+                fingerprintVectorPushback(prints, (struct Fingerprint) { .value = records[i].value, .name = internString(interner, strings + records[i].name, records[i].length), .kind = records[i].kind });
+        }
+        unlockInterner(interner);
+    }
+
+    if (valid == false)
+        fingerprintVectorClear(prints);
+
+    unloadFile(& file);
+    free(prints_path);
+    return valid;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: loadFingerprints.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Stores the fingerprints of the declarations of a source file in the cache, for the next compilation to compare against.
+ * Failing to write them is not an error, the next compilation simply checks every declaration.
+ *
+ * @param       cache the cache to store the fingerprints in.
+ * @param       path the path to the source file.
+ * @param       prints the fingerprints of the declarations.
+ *
+ * @return      true if the fingerprints were stored, false otherwise.
+ */
+bool storeFingerprints(struct InterfaceCache const * const cache, char const * path, struct FingerprintVector const * const prints) {
+    char const * message = "The parameters cannot be NULL.";
+    if (cache == NULL || path == NULL || prints == NULL)
+        goto exit;
+
+    struct Interner * interner = globalInterner();
+    size_t count = fingerprintVectorSize(prints);
+    struct Fingerprint const * data = fingerprintVectorData(prints);
+    size_t strings_size = 0;
+    for (size_t i = 0; i < count; i++)
+        strings_size += symbolLength(interner, data[i].name);
+
+    message = cache -> message;
+    size_t size = sizeof (struct FingerprintsHeader) + count * sizeof (struct FingerprintRecord) + strings_size;
+    unsigned char * content = calloc(1, size);
+    if (content == NULL)
+        goto exit;
+
+    // The header is written as is so every byte of it, padding of the version included, must be set
+    struct FingerprintsHeader * header = (struct FingerprintsHeader *) content;
+    struct FingerprintRecord * records = (struct FingerprintRecord *) (header + 1);
+    char * strings = (char *) (records + count);
+    header -> magic = FINGERPRINTS_MAGIC;
+    header -> format = FINGERPRINTS_FORMAT;
+    strncpy(header -> version, AVALON_VERSION, sizeof header -> version);
+    header -> count = (uint32_t) count;
+    header -> strings_size = (uint32_t) strings_size;
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t length = (uint32_t) symbolLength(interner, data[i].name);
+        memcpy(strings + offset, symbolString(interner, data[i].name), length);
+        records[i] = (struct FingerprintRecord) { .value = data[i].value, .name = offset, .length = length, .kind = data[i].kind, .reserved = 0 };
+        offset += length;
+    }
+
+    char * prints_path = cacheFilePath(cache, fingerprintsKey(path), FINGERPRINTS_EXTENSION);
+    bool stored = cacheWriteFile(cache, prints_path, content, size);
+    free(prints_path);
+    free(content);
+    return stored;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: storeFingerprints.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Initializes an empty name table that can hold the given number of names.
+ *
+ * @param       table the table to initialize.
+ * @param       count the number of names the table will hold.
+ */
+static void newNameTable(struct NameTable * const table, size_t count) {
+    // The table is kept at most half full so probe sequences stay short
+    size_t capacity = 16;
+    while (capacity < 2 * count)
+        capacity *= 2;
+
+    table -> names = malloc(capacity * sizeof *table -> names);
+    table -> positions = malloc(capacity * sizeof *table -> positions);
+    table -> mask = capacity - 1;
+    if (table -> names == NULL || table -> positions == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newNameTable.\nMessage: Ran out of memory while comparing fingerprints.\n", __FILE__, __LINE__);
+        exit(74);
+    }
+
+    for (size_t i = 0; i < capacity; i++)
+        table -> names[i] = NO_SYMBOL;
+}
+
+
+/**
+ * Frees the memory occupied by the name table.
+ *
+ * @param       table the table to free.
+ */
+static void deleteNameTable(struct NameTable * const table) {
+    free(table -> names);
+    free(table -> positions);
+}
+
+
+/**
+ * Records the position of a name, a name added twice keeps its first position.
+ *
+ * @param       table the table to add the name to.
+ * @param       name the symbol of the name.
+ * @param       position the position of the declaration with the name.
+ */
+static void nameTableAdd(struct NameTable * const table, uint32_t name, uint32_t position) {
+    size_t slot = name & table -> mask;
+    while (table -> names[slot] != NO_SYMBOL) {
+        if (table -> names[slot] == name)
+            return;
+
+        slot = (slot + 1) & table -> mask;
+    }
+
+    table -> names[slot] = name;
+    table -> positions[slot] = position;
+}
+
+
+/**
+ * Returns the position recorded for a name.
+ *
+ * @param       table the table to look the name up in.
+ * @param       name the symbol of the name.
+ *
+ * @return      the position of the declaration with the name, UINT32_MAX if there is none.
+ */
+static uint32_t nameTableFind(struct NameTable const * const table, uint32_t name) {
+    size_t slot = name & table -> mask;
+    while (table -> names[slot] != NO_SYMBOL) {
+        if (table -> names[slot] == name)
+            return table -> positions[slot];
+
+        slot = (slot + 1) & table -> mask;
+    }
+
+    return UINT32_MAX;
+}
+
+
+/**
+ * Tells whether the imports of a module changed since the previous compilation, either because the module imports other modules or because the interface of one of them changed.
+ *
+ * @param       prints the fingerprints of the declarations of the module.
+ * @param       previous the fingerprints of the previous compilation.
+ *
+ * @return      true if the imports changed, false otherwise.
+ */
+static bool importsChanged(struct FingerprintVector const * const prints, struct FingerprintVector const * const previous) {
+    size_t current_imports = 0;
+    size_t previous_imports = 0;
+    for (size_t i = 0; i < fingerprintVectorSize(previous); i++)
+        if (fingerprintVectorData(previous)[i].kind == NODE_IMPORT)
+            previous_imports++;
+
+    // Modules import a handful of modules so a linear search does
+    for (size_t i = 0; i < fingerprintVectorSize(prints); i++) {
+        struct Fingerprint const * print = & fingerprintVectorData(prints)[i];
+        if (print -> kind != NODE_IMPORT)
+            continue;
+
+        current_imports++;
+        bool found = false;
+        for (size_t j = 0; j < fingerprintVectorSize(previous) && found == false; j++) {
+            struct Fingerprint const * before = & fingerprintVectorData(previous)[j];
+            found = before -> kind == NODE_IMPORT && before -> name == print -> name && before -> value == print -> value;
+        }
+
+        if (found == false)
+            return true;
+    }
+
+    return current_imports != previous_imports;
+}
+
+
+/**
+ * Returns the key the fingerprints of a source file are stored under: the hash of its absolute path, so a module keeps its fingerprints whatever the directory the compiler runs from.
+ *
+ * @param       path the path to the source file.
+ *
+ * @return      the key of the fingerprints.
+ */
+static uint64_t fingerprintsKey(char const * path) {
+    char * absolute = realpath(path, NULL);
+    char const * key = absolute != NULL ? absolute : path;
+    uint64_t hash = fingerprintBytes(FINGERPRINT_SEED, key, strlen(key));
+    free(absolute);
+    return hash;
+}
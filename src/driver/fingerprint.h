@@ -0,0 +1,159 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef DRIVER_FINGERPRINT_H
+#define DRIVER_FINGERPRINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "driver/interface_cache.h"
+#include "common/ast/program.h"
+#include "utils/vector.h"
+
+
+/* Extension of the files holding the fingerprints of the declarations of a module. */
+#define FINGERPRINTS_EXTENSION ".avf"
+
+/* Identifies fingerprint files and the layout of their content, which must change whenever the layout does. */
+#define FINGERPRINTS_MAGIC 0x46564141u
+#define FINGERPRINTS_FORMAT 1
+
+/* The starting value of fingerprints, the 64-bit FNV-1a offset basis. */
+#define FINGERPRINT_SEED 14695981039346656037u
+
+/* The fingerprint of a top level declaration.
+ * Declarations are told apart across compilations by their kind and their name: the name of a binding or the dotted name of the imported module.
+ *
+ * The fingerprint of a binding hashes its syntax tree, so edits to the layout, the comments or the position of the binding leave it unchanged.
+ * The fingerprint of an import is the interface fingerprint of the imported module, so it changes whenever what the import brings in does.
+ */
+struct Fingerprint {
+    uint64_t value;
+    uint32_t name;
+    uint32_t kind;
+};
+
+VECTOR_DECLARE(FingerprintVector, fingerprintVector, struct Fingerprint, 8)
+
+/* The start of a fingerprints file, followed by count records then by the strings the records name. */
+struct FingerprintsHeader {
+    uint32_t magic;
+    uint32_t format;
+    char version[16];
+    uint32_t count;
+    uint32_t strings_size;
+};
+
+/* A fingerprint as stored on disk, the name spanning length bytes from name in the strings. */
+struct FingerprintRecord {
+    uint64_t value;
+    uint32_t name;
+    uint32_t length;
+    uint32_t kind;
+    uint32_t reserved;
+};
+
+
+/**
+ * Folds bytes into a fingerprint.
+ *
+ * @param       hash the fingerprint so far, FINGERPRINT_SEED to start a new one.
+ * @param       bytes the bytes to fold in.
+ * @param       length the number of bytes.
+ *
+ * @return      the 64-bit FNV-1a hash of the bytes, continuing from the given hash.
+ */
+inline uint64_t fingerprintBytes(uint64_t hash, void const * bytes, size_t length) {
+    unsigned char const * data = bytes;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211u;
+    }
+    return hash;
+}
+
+
+/**
+ * Folds the kind and the name of a declaration into the interface fingerprint of its module.
+ * The interface fingerprint folds the imports in source order then the bindings in source order,
+ * which can be done from the syntax tree of the module as well as from its cached interface.
+ *
+ * @param       hash the interface fingerprint so far, FINGERPRINT_SEED to start a new one.
+ * @param       kind the kind of the declaration.
+ * @param       name the name of the declaration.
+ * @param       length the length of the name.
+ *
+ * @return      the interface fingerprint including the declaration.
+ */
+uint64_t fingerprintSignature(uint64_t hash, uint32_t kind, char const * name, size_t length);
+
+
+/**
+ * Fingerprints every top level declaration of a program parsed without errors and records the names each binding refers to.
+ * Imports get the fingerprint of their name, the caller replaces it with the interface fingerprint of the imported module.
+ *
+ * @param       program the program which declarations to fingerprint.
+ * @param       prints receives one fingerprint per declaration, in source order.
+ * @param       references receives the symbols of the names referred to by each declaration, one after the other.
+ * @param       offsets receives where the references of each declaration start in references, followed by the total number of references.
+ *
+ * @return      the interface fingerprint of the program.
+ */
+uint64_t fingerprintProgram(struct Program const * const program, struct FingerprintVector * const prints, struct Uint32Vector * const references, struct Uint32Vector * const offsets);
+
+
+/**
+ * Finds the declarations that must be checked again since the previous compilation:
+ * the declarations which fingerprint changed, the new ones and every binding that refers, directly or not, to one of them or to a removed binding.
+ * When an import changed, what every name refers to may have changed so every declaration must be checked again.
+ *
+ * @param       prints the fingerprints of the declarations, as filled by fingerprintProgram().
+ * @param       references the names the declarations refer to, as filled by fingerprintProgram().
+ * @param       offsets where the references of each declaration start, as filled by fingerprintProgram().
+ * @param       previous the fingerprints of the previous compilation.
+ * @param       changed receives the positions in prints of the declarations to check again, in increasing order.
+ */
+void changedDeclarations(struct FingerprintVector const * const prints, struct Uint32Vector const * const references, struct Uint32Vector const * const offsets, struct FingerprintVector const * const previous, struct Uint32Vector * const changed);
+
+
+/**
+ * Loads the fingerprints the previous compilation of a source file left in the cache.
+ *
+ * @param       cache the cache the fingerprints are stored in.
+ * @param       path the path to the source file.
+ * @param       prints receives the fingerprints, their names interned in the global interner.
+ *
+ * @return      true if fingerprints were found, false if the file was never compiled with this cache and this compiler.
+ */
+bool loadFingerprints(struct InterfaceCache const * const cache, char const * path, struct FingerprintVector * const prints);
+
+
+/**
+ * Stores the fingerprints of the declarations of a source file in the cache, for the next compilation to compare against.
+ * Failing to write them is not an error, the next compilation simply checks every declaration.
+ *
+ * @param       cache the cache to store the fingerprints in.
+ * @param       path the path to the source file.
+ * @param       prints the fingerprints of the declarations.
+ *
+ * @return      true if the fingerprints were stored, false otherwise.
+ */
+bool storeFingerprints(struct InterfaceCache const * const cache, char const * path, struct FingerprintVector const * const prints);
+
+#endif
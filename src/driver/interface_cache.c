@@ -0,0 +1,448 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "driver/interface_cache.h"
+#include "driver/fingerprint.h"
+#include "common/ast/program.h"
+#include "common/token_buffer.h"
+#include "common/interner.h"
+#include "common/version.h"
+#include "common/ast/ast.h"
+#include "utils/file.h"
+
+
+extern inline uint32_t interfaceImportsCount(struct Interface const * const interface);
+extern inline uint32_t interfaceBindingsCount(struct Interface const * const interface);
+extern inline char const * interfaceString(struct Interface const * const interface, uint32_t offset);
+
+static void fillHeader(struct InterfaceHeader * const header, uint64_t key, struct SourceFile const * const source);
+static bool validInterface(struct Interface const * const interface, uint64_t key, struct SourceFile const * const source);
+static bool writeAll(int descriptor, void const * data, size_t size);
+
+
+/**
+ * Initializes a cache stored in the given directory, creating the directory if it does not exist.
+ *
+ * @param       directory the path to the cache directory.
+ * @param       message error message to display in case any operation on the cache fails.
+ *
+ * @return      the newly created cache.
+ */
+struct InterfaceCache * newInterfaceCache(char const * directory, char const * message) {
+    if (directory == NULL)
+        goto exit;
+
+    struct InterfaceCache * cache = malloc(sizeof *cache);
+    if (cache == NULL)
+        goto exit;
+
+    // The root directory keeps its slash, trailing slashes are dropped from every other directory
+    size_t length = strlen(directory);
+    while (length > 1 && directory[length - 1] == '/')
+        length--;
+
+    cache -> directory = malloc(length + 1);
+    if (cache -> directory == NULL)
+        goto exit;
+
+    memcpy(cache -> directory, directory, length);
+    cache -> directory[length] = '\0';
+    cache -> message = message;
+
+    // If the directory cannot be created, every store fails and the cache behaves as if it were always empty
+    mkdir(cache -> directory, 0777);
+    return cache;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newInterfaceCache.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the cache. The cached files are left in place.
+ *
+ * @param       cache pointer to memory occupied by the cache.
+ */
+void deleteInterfaceCache(struct InterfaceCache ** const cache) {
+    if (cache == NULL)
+        return;
+
+    if (* cache == NULL)
+        return;
+
+    free((* cache) -> directory);
+    free(* cache);
+    * cache = NULL;
+}
+
+
+/**
+ * Returns the hash interfaces derived from the given source are cached under.
+ * It covers the compiler version as well so interfaces cached by another compiler are never used.
+ *
+ * @param       source the source file.
+ *
+ * @return      the 64-bit FNV-1a hash of the compiler version followed by the source.
+ */
+uint64_t interfaceKey(struct SourceFile const * const source) {
+    if (source == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: interfaceKey.\nMessage: The parameter <source> cannot be NULL.\n", __FILE__, __LINE__);
+        exit(74);
+    }
+
+    // The null byte ending the version keeps "1.0" followed by "0..." apart from "1.00" followed by "..."
+    char const version[] = AVALON_VERSION;
+    uint64_t hash = fingerprintBytes(FINGERPRINT_SEED, version, sizeof version);
+    return fingerprintBytes(hash, source -> content, source -> length);
+}
+
+
+/**
+ * Maps the interface cached for the given source, if any.
+ * Files that are truncated or were written by another compiler are ignored.
+ *
+ * @param       cache the cache to look the interface up in.
+ * @param       key the key of the source as returned by interfaceKey().
+ * @param       source the source file the interface must be derived from.
+ *
+ * @return      the interface, to be freed with deleteInterface(), NULL if the cache has none for the source.
+ */
+struct Interface * loadInterface(struct InterfaceCache const * const cache, uint64_t key, struct SourceFile const * const source) {
+    char const * message = "The parameters <cache> and <source> cannot be NULL.";
+    if (cache == NULL || source == NULL)
+        goto exit;
+
+    char * path = cacheFilePath(cache, key, INTERFACE_EXTENSION);
+    if (fileExists(path) == false) {
+        free(path);
+        return NULL;
+    }
+
+    message = cache -> message;
+    struct Interface * interface = malloc(sizeof *interface);
+    if (interface == NULL)
+        goto exit;
+
+    // The sections are read in place so loading an interface costs a mapping and a few checks
+    interface -> path = path;
+    interface -> file = loadFile(path, LOAD_MAP);
+    interface -> header = (struct InterfaceHeader const *) interface -> file -> content;
+    interface -> imports = (struct InterfaceImport const *) (interface -> header + 1);
+    interface -> bindings = NULL;
+    interface -> strings = NULL;
+
+    if (validInterface(interface, key, source) == false) {
+        deleteInterface(& interface);
+        return NULL;
+    }
+
+    interface -> bindings = (struct InterfaceBinding const *) (interface -> imports + interface -> header -> imports_count);
+    interface -> strings = (char const *) (interface -> bindings + interface -> header -> bindings_count);
+    return interface;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: loadInterface.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Stores the interface of a program parsed without errors in the cache.
+ * Failing to write the cache is not an error, the module is simply parsed again next time.
+ *
+ * @param       cache the cache to store the interface in.
+ * @param       key the key of the source as returned by interfaceKey().
+ * @param       source the source file the program was parsed from.
+ * @param       program the program which interface to store.
+ *
+ * @return      true if the interface was stored, false otherwise.
+ */
+bool storeInterface(struct InterfaceCache const * const cache, uint64_t key, struct SourceFile const * const source, struct Program const * const program) {
+    char const * message = "The parameters <cache>, <source> and <program> cannot be NULL.";
+    if (cache == NULL || source == NULL || program == NULL)
+        goto exit;
+
+    struct TokenBuffer const * tokens = programTokens(program);
+    struct Ast const * ast = programAst(program);
+    uint32_t const * declarations = programDeclarations(program);
+    size_t declarations_count = declarationsCount(program);
+    struct Interner * interner = globalInterner();
+
+    // The whole file is built in memory then written at once: the sections are sized first and the names gathered as we go
+    struct InterfaceHeader header;
+    fillHeader(& header, key, source);
+
+    message = cache -> message;
+    char ** names = malloc((declarations_count > 0 ? declarations_count : 1) * sizeof *names);
+    if (names == NULL)
+        goto exit;
+
+    size_t strings_size = 0;
+    for (size_t i = 0; i < declarations_count; i++) {
+        names[i] = NULL;
+        switch (astKind(ast, declarations[i])) {
+            case NODE_IMPORT:
+                names[i] = programImportName(program, declarations[i]);
+                strings_size += strlen(names[i]);
+                header.imports_count++;
+                break;
+
+            case NODE_VALUE:
+            case NODE_VARIABLE:
+                strings_size += symbolLength(interner, tokenBufferSymbol(tokens, astToken(ast, astChildren(ast, declarations[i])[0])));
+                header.bindings_count++;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    header.strings_size = (uint32_t) strings_size;
+    size_t imports_size = header.imports_count * sizeof (struct InterfaceImport);
+    size_t bindings_size = header.bindings_count * sizeof (struct InterfaceBinding);
+    size_t size = sizeof header + imports_size + bindings_size + strings_size;
+    unsigned char * content = malloc(size);
+    if (content == NULL)
+        goto exit;
+
+    struct InterfaceImport * imports = (struct InterfaceImport *) (content + sizeof header);
+    struct InterfaceBinding * bindings = (struct InterfaceBinding *) (content + sizeof header + imports_size);
+    char * strings = (char *) (content + sizeof header + imports_size + bindings_size);
+    memcpy(content, & header, sizeof header);
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < declarations_count; i++) {
+        uint32_t declaration = declarations[i];
+        if (astKind(ast, declaration) == NODE_IMPORT) {
+            struct Token token = tokenBufferAt(tokens, astToken(ast, declaration));
+            uint32_t length = (uint32_t) strlen(names[i]);
+            memcpy(strings + offset, names[i], length);
+            * imports++ = (struct InterfaceImport) { .name = offset, .length = length, .offset = token.offset, .reserved = 0 };
+            offset += length;
+            free(names[i]);
+        }
+        else if (astKind(ast, declaration) == NODE_VALUE || astKind(ast, declaration) == NODE_VARIABLE) {
+            uint32_t name = astToken(ast, astChildren(ast, declaration)[0]);
+            uint32_t symbol = tokenBufferSymbol(tokens, name);
+            uint32_t length = (uint32_t) symbolLength(interner, symbol);
+            memcpy(strings + offset, symbolString(interner, symbol), length);
+            * bindings++ = (struct InterfaceBinding) { .name = offset, .length = length, .kind = astKind(ast, declaration), .offset = tokenBufferAt(tokens, name).offset };
+            offset += length;
+        }
+    }
+    free(names);
+
+    char * path = cacheFilePath(cache, key, INTERFACE_EXTENSION);
+    bool stored = cacheWriteFile(cache, path, content, size);
+    free(path);
+    free(content);
+    return stored;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: storeInterface.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the path to the file of the cache with the given key and extension.
+ *
+ * @param       cache the cache.
+ * @param       key the key of the file.
+ * @param       extension the extension of the file, which tells what it holds.
+ *
+ * @return      the path, to be freed by the caller.
+ */
+char * cacheFilePath(struct InterfaceCache const * const cache, uint64_t key, char const * extension) {
+    char const * message = "The parameters <cache> and <extension> cannot be NULL.";
+    if (cache == NULL || extension == NULL)
+        goto exit;
+
+    message = cache -> message;
+    size_t length = strlen(cache -> directory) + 1 + 16 + strlen(extension);
+    char * path = malloc(length + 1);
+    if (path == NULL)
+        goto exit;
+
+    snprintf(path, length + 1, "%s/%016llx%s", cache -> directory, (unsigned long long) key, extension);
+    return path;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: cacheFilePath.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Writes a file of the cache at once: the content goes to a temporary file which is then renamed,
+ * so readers, which may be other compilers, find either the previous file or the complete new one.
+ *
+ * @param       cache the cache.
+ * @param       path the path to the file, as returned by cacheFilePath().
+ * @param       content the content of the file.
+ * @param       size the number of bytes of content.
+ *
+ * @return      true if the file was written, false otherwise.
+ */
+bool cacheWriteFile(struct InterfaceCache const * const cache, char const * path, void const * content, size_t size) {
+    char const * message = "The parameters <cache> and <path> cannot be NULL.";
+    if (cache == NULL || path == NULL)
+        goto exit;
+
+    message = cache -> message;
+    char * temporary = malloc(strlen(path) + strlen(".XXXXXX") + 1);
+    if (temporary == NULL)
+        goto exit;
+
+    strcpy(temporary, path);
+    strcat(temporary, ".XXXXXX");
+    int descriptor = mkstemp(temporary);
+
+    // Temporary files are only readable by their owner but the cache may be shared
+    bool written = descriptor >= 0 && fchmod(descriptor, 0644) == 0 && writeAll(descriptor, content, size);
+    if (descriptor >= 0 && close(descriptor) != 0)
+        written = false;
+    if (written)
+        written = rename(temporary, path) == 0;
+    if (written == false && descriptor >= 0)
+        unlink(temporary);
+
+    free(temporary);
+    return written;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: cacheWriteFile.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Unmaps the interface and frees the memory it occupies.
+ *
+ * @param       interface pointer to memory occupied by the interface.
+ */
+void deleteInterface(struct Interface ** const interface) {
+    if (interface == NULL)
+        return;
+
+    if (* interface == NULL)
+        return;
+
+    unloadFile(& (* interface) -> file);
+    free((* interface) -> path);
+    free(* interface);
+    * interface = NULL;
+}
+
+
+/**
+ * Fills the header of an interface derived from the given source, with empty sections.
+ *
+ * @param       header the header to fill.
+ * @param       key the key of the source.
+ * @param       source the source file.
+ */
+static void fillHeader(struct InterfaceHeader * const header, uint64_t key, struct SourceFile const * const source) {
+    // The header is written as is so every byte of it, padding of the version included, must be set
+    memset(header, 0, sizeof *header);
+    header -> magic = INTERFACE_MAGIC;
+    header -> format = INTERFACE_FORMAT;
+    header -> source_hash = key;
+    header -> source_length = source -> length;
+    strncpy(header -> version, AVALON_VERSION, sizeof header -> version);
+}
+
+
+/**
+ * Checks that a mapped interface file is complete and was derived from the given source by this compiler.
+ *
+ * @param       interface the interface which header and imports are set.
+ * @param       key the key of the source.
+ * @param       source the source file.
+ *
+ * @return      true if the interface can be used, false otherwise.
+ */
+static bool validInterface(struct Interface const * const interface, uint64_t key, struct SourceFile const * const source) {
+    struct InterfaceHeader expected;
+    fillHeader(& expected, key, source);
+
+    struct InterfaceHeader const * header = interface -> header;
+    size_t length = interface -> file -> length;
+    if (length < sizeof *header)
+        return false;
+
+    if (header -> magic != expected.magic || header -> format != expected.format || header -> source_hash != expected.source_hash || header -> source_length != expected.source_length)
+        return false;
+
+    if (memcmp(header -> version, expected.version, sizeof expected.version) != 0)
+        return false;
+
+    uint64_t size = sizeof *header + (uint64_t) header -> imports_count * sizeof (struct InterfaceImport) + (uint64_t) header -> bindings_count * sizeof (struct InterfaceBinding) + header -> strings_size;
+    if (size != length)
+        return false;
+
+    // Names must lie within the strings section
+    struct InterfaceImport const * imports = interface -> imports;
+    struct InterfaceBinding const * bindings = (struct InterfaceBinding const *) (imports + header -> imports_count);
+    for (uint32_t i = 0; i < header -> imports_count; i++)
+        if ((uint64_t) imports[i].name + imports[i].length > header -> strings_size)
+            return false;
+
+    for (uint32_t i = 0; i < header -> bindings_count; i++)
+        if ((uint64_t) bindings[i].name + bindings[i].length > header -> strings_size)
+            return false;
+
+    return true;
+}
+
+
+/**
+ * Writes the whole buffer to the file, however many writes it takes.
+ *
+ * @param       descriptor the file to write to.
+ * @param       data the bytes to write.
+ * @param       size the number of bytes to write.
+ *
+ * @return      true if every byte was written, false otherwise.
+ */
+static bool writeAll(int descriptor, void const * data, size_t size) {
+    unsigned char const * bytes = data;
+    while (size > 0) {
+        ssize_t written = write(descriptor, bytes, size);
+        if (written <= 0)
+            return false;
+
+        bytes += written;
+        size -= (size_t) written;
+    }
+
+    return true;
+}
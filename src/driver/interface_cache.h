@@ -0,0 +1,223 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef DRIVER_INTERFACE_CACHE_H
+#define DRIVER_INTERFACE_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common/ast/program.h"
+#include "utils/file.h"
+
+
+/* Extension of the files holding the cached interfaces. */
+#define INTERFACE_EXTENSION ".avi"
+
+/* Identifies interface files and the layout of their content, which must change whenever the layout does. */
+#define INTERFACE_MAGIC 0x49564141u
+#define INTERFACE_FORMAT 2
+
+/* The start of an interface file, which says what source the interface was derived from and how large each section is.
+ * The sections follow the header in order: the imports, the bindings then the strings the imports and the bindings name.
+ * Every field is naturally aligned so the file can be read in place once mapped.
+ */
+struct InterfaceHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t source_hash;
+    uint64_t source_length;
+    char version[16];
+    uint32_t imports_count;
+    uint32_t bindings_count;
+    uint32_t strings_size;
+    uint32_t reserved;
+};
+
+/* A module imported by the module, the dotted name of which spans length bytes from name in the strings. */
+struct InterfaceImport {
+    uint32_t name;
+    uint32_t length;
+
+    /* The offset of the import keyword in the source of the module, to report errors about the import without the source being parsed. */
+    uint32_t offset;
+    uint32_t reserved;
+};
+
+/* A top level declaration of the module, visible to the modules importing it. */
+struct InterfaceBinding {
+    uint32_t name;
+    uint32_t length;
+
+    /* NODE_VALUE or NODE_VARIABLE. */
+    uint32_t kind;
+
+    /* The offset of the name of the binding in the source of the module. */
+    uint32_t offset;
+};
+
+/* The public interface of a module as found in the cache, read in place from the mapped interface file. */
+struct Interface {
+    char * path;
+    struct SourceFile * file;
+
+    struct InterfaceHeader const * header;
+    struct InterfaceImport const * imports;
+    struct InterfaceBinding const * bindings;
+    char const * strings;
+};
+
+/* A content addressed directory of module interfaces.
+ * The interface of a module is stored under a name derived from the hash of its source and of the compiler version,
+ * so an unchanged module compiled by the same compiler finds its interface without being lexed nor parsed, whatever the project it is part of.
+ * Interface files are written to a temporary file then renamed so compilers sharing the cache never see a partial file.
+ */
+struct InterfaceCache {
+    char * directory;
+    char const * message;
+};
+
+
+/**
+ * Initializes a cache stored in the given directory, creating the directory if it does not exist.
+ *
+ * @param       directory the path to the cache directory.
+ * @param       message error message to display in case any operation on the cache fails.
+ *
+ * @return      the newly created cache.
+ */
+struct InterfaceCache * newInterfaceCache(char const * directory, char const * message);
+
+
+/**
+ * Frees the memory occupied by the cache. The cached files are left in place.
+ *
+ * @param       cache pointer to memory occupied by the cache.
+ */
+void deleteInterfaceCache(struct InterfaceCache ** const cache);
+
+
+/**
+ * Returns the hash interfaces derived from the given source are cached under.
+ * It covers the compiler version as well so interfaces cached by another compiler are never used.
+ *
+ * @param       source the source file.
+ *
+ * @return      the 64-bit FNV-1a hash of the compiler version followed by the source.
+ */
+uint64_t interfaceKey(struct SourceFile const * const source);
+
+
+/**
+ * Maps the interface cached for the given source, if any.
+ * Files that are truncated or were written by another compiler are ignored.
+ *
+ * @param       cache the cache to look the interface up in.
+ * @param       key the key of the source as returned by interfaceKey().
+ * @param       source the source file the interface must be derived from.
+ *
+ * @return      the interface, to be freed with deleteInterface(), NULL if the cache has none for the source.
+ */
+struct Interface * loadInterface(struct InterfaceCache const * const cache, uint64_t key, struct SourceFile const * const source);
+
+
+/**
+ * Stores the interface of a program parsed without errors in the cache.
+ * Failing to write the cache is not an error, the module is simply parsed again next time.
+ *
+ * @param       cache the cache to store the interface in.
+ * @param       key the key of the source as returned by interfaceKey().
+ * @param       source the source file the program was parsed from.
+ * @param       program the program which interface to store.
+ *
+ * @return      true if the interface was stored, false otherwise.
+ */
+bool storeInterface(struct InterfaceCache const * const cache, uint64_t key, struct SourceFile const * const source, struct Program const * const program);
+
+
+/**
+ * Returns the path to the file of the cache with the given key and extension.
+ *
+ * @param       cache the cache.
+ * @param       key the key of the file.
+ * @param       extension the extension of the file, which tells what it holds.
+ *
+ * @return      the path, to be freed by the caller.
+ */
+char * cacheFilePath(struct InterfaceCache const * const cache, uint64_t key, char const * extension);
+
+
+/**
+ * Writes a file of the cache at once: the content goes to a temporary file which is then renamed,
+ * so readers, which may be other compilers, find either the previous file or the complete new one.
+ *
+ * @param       cache the cache.
+ * @param       path the path to the file, as returned by cacheFilePath().
+ * @param       content the content of the file.
+ * @param       size the number of bytes of content.
+ *
+ * @return      true if the file was written, false otherwise.
+ */
+bool cacheWriteFile(struct InterfaceCache const * const cache, char const * path, void const * content, size_t size);
+
+
+/**
+ * Unmaps the interface and frees the memory it occupies.
+ *
+ * @param       interface pointer to memory occupied by the interface.
+ */
+void deleteInterface(struct Interface ** const interface);
+
+
+/**
+ * Returns the number of modules the module of the interface imports.
+ *
+ * @param       interface the interface.
+ *
+ * @return      the number of imports.
+ */
+inline uint32_t interfaceImportsCount(struct Interface const * const interface) {
+    return interface -> header -> imports_count;
+}
+
+
+/**
+ * Returns the number of top level declarations of the module of the interface.
+ *
+ * @param       interface the interface.
+ *
+ * @return      the number of bindings.
+ */
+inline uint32_t interfaceBindingsCount(struct Interface const * const interface) {
+    return interface -> header -> bindings_count;
+}
+
+
+/**
+ * Returns a string of the interface, which is not null terminated.
+ *
+ * @param       interface the interface.
+ * @param       offset the offset of the string, such as the name of an import or of a binding.
+ *
+ * @return      the first character of the string.
+ */
+inline char const * interfaceString(struct Interface const * const interface, uint32_t offset) {
+    return interface -> strings + offset;
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "driver/search_path.h"
+#include "common/fqn.h"
+#include "utils/vector.h"
+#include "utils/file.h"
+
+
+/**
+ * Initializes an empty search path.
+ *
+ * @param       message error message to display in case any operation on the search path fails.
+ *
+ * @return      the newly created search path.
+ */
+struct SearchPath * newSearchPath(char const * message) {
+    struct SearchPath * search_path = malloc(sizeof *search_path);
+    if (search_path == NULL)
+        goto exit;
+
+    search_path -> directories = newVector(8, message);
+    search_path -> message = message;
+    return search_path;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newSearchPath.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the search path and the directories it holds.
+ *
+ * @param       search_path pointer to memory occupied by the search path.
+ */
+void deleteSearchPath(struct SearchPath ** const search_path) {
+    if (search_path == NULL)
+        return;
+
+    if (* search_path == NULL)
+        return;
+
+    struct Vector * directories = (* search_path) -> directories;
+    for (size_t i = 0; i < vectorSize(directories); i++)
+        free(vectorAt(directories, i));
+
+    deleteVector(& (* search_path) -> directories);
+    free(* search_path);
+    * search_path = NULL;
+}
+
+
+/**
+ * Appends a directory to the search path. Empty directories and directories already in the search path are ignored.
+ *
+ * @param       search_path the search path to append the directory to.
+ * @param       directory the directory, which need not be null terminated.
+ * @param       length the length of the directory.
+ */
+void searchPathAdd(struct SearchPath * const search_path, char const * directory, size_t length) {
+    char const * message = "The parameter <search_path> cannot be NULL.";
+    if (search_path == NULL)
+        goto exit;
+
+    // A trailing separator would double the one we add when joining the directory with a module path
+    while (length > 1 && (directory[length - 1] == '/' || directory[length - 1] == '\\'))
+        length--;
+
+    if (length == 0)
+        return;
+
+    // Looking up a module twice in the same directory can only fail twice
+    struct Vector * directories = search_path -> directories;
+    for (size_t i = 0; i < vectorSize(directories); i++) {
+        char const * existing = vectorAt(directories, i);
+        if (strlen(existing) == length && memcmp(existing, directory, length) == 0)
+            return;
+    }
+
+    char * copy = malloc(length + 1);
+    if (copy == NULL)
+        goto exit;
+
+    memcpy(copy, directory, length);
+    copy[length] = '\0';
+    vectorPushback(directories, copy);
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: searchPathAdd.\nMessage: %s\n", __FILE__, __LINE__, search_path ? search_path -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Appends every directory of a list of directories separated by SEARCH_PATH_SEPARATOR to the search path.
+ *
+ * @param       search_path the search path to append the directories to.
+ * @param       list the list of directories, NULL is the same as the empty list.
+ */
+void searchPathAddList(struct SearchPath * const search_path, char const * list) {
+    if (list == NULL)
+        return;
+
+    for (;;) {
+        char const * separator = strchr(list, SEARCH_PATH_SEPARATOR);
+        if (separator == NULL) {
+            searchPathAdd(search_path, list, strlen(list));
+            return;
+        }
+
+        searchPathAdd(search_path, list, (size_t) (separator - list));
+        list = separator + 1;
+    }
+}
+
+
+/**
+ * Looks for the source file of the module with the given FQN in the directories of the search path.
+ * The module a.b.c is found in the first directory that contains a/b/c.avl.
+ *
+ * @param       search_path the search path to look into.
+ * @param       fqn the FQN of the module.
+ *
+ * @return      the path to the source file, to be freed by the caller, or NULL if no directory contains it.
+ */
+char * searchPathResolve(struct SearchPath const * const search_path, struct FQN const * const fqn) {
+    char const * message = "The parameter <search_path> cannot be NULL.";
+    if (search_path == NULL)
+        goto exit;
+
+    char const * module_path = fqnPath(fqn);
+    size_t module_length = strlen(module_path);
+    size_t extension_length = strlen(SOURCE_EXTENSION);
+
+    struct Vector * directories = search_path -> directories;
+    for (size_t i = 0; i < vectorSize(directories); i++) {
+        char const * directory = vectorAt(directories, i);
+        size_t directory_length = strlen(directory);
+
+        // <directory>/<module path><extension>
+        char * path = malloc(directory_length + 1 + module_length + extension_length + 1);
+        if (path == NULL)
+            goto exit;
+
+        memcpy(path, directory, directory_length);
+        path[directory_length] = '/';
+        memcpy(path + directory_length + 1, module_path, module_length);
+        memcpy(path + directory_length + 1 + module_length, SOURCE_EXTENSION, extension_length + 1);
+
+        if (fileExists(path))
+            return path;
+
+        free(path);
+    }
+
+    return NULL;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: searchPathResolve.\nMessage: %s\n", __FILE__, __LINE__, search_path ? search_path -> message : message);
+    exit(74);
+}
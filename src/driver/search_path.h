@@ -0,0 +1,93 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef DRIVER_SEARCH_PATH_H
+#define DRIVER_SEARCH_PATH_H
+
+#include <stddef.h>
+
+#include "common/fqn.h"
+#include "utils/vector.h"
+
+
+/* Extension of Avalon source files. */
+#define SOURCE_EXTENSION ".avl"
+
+/* Separator of the directories listed in AVALON_PATH, the same as the one of PATH on the host. */
+#if defined(_WIN32)
+    #define SEARCH_PATH_SEPARATOR ';'
+#else
+    #define SEARCH_PATH_SEPARATOR ':'
+#endif
+
+/* The directories imported modules are looked up in, in the order they are searched. */
+struct SearchPath {
+    struct Vector * directories;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes an empty search path.
+ *
+ * @param       message error message to display in case any operation on the search path fails.
+ *
+ * @return      the newly created search path.
+ */
+struct SearchPath * newSearchPath(char const * message);
+
+
+/**
+ * Frees the memory occupied by the search path and the directories it holds.
+ *
+ * @param       search_path pointer to memory occupied by the search path.
+ */
+void deleteSearchPath(struct SearchPath ** const search_path);
+
+
+/**
+ * Appends a directory to the search path. Empty directories and directories already in the search path are ignored.
+ *
+ * @param       search_path the search path to append the directory to.
+ * @param       directory the directory, which need not be null terminated.
+ * @param       length the length of the directory.
+ */
+void searchPathAdd(struct SearchPath * const search_path, char const * directory, size_t length);
+
+
+/**
+ * Appends every directory of a list of directories separated by SEARCH_PATH_SEPARATOR to the search path.
+ *
+ * @param       search_path the search path to append the directories to.
+ * @param       list the list of directories, NULL is the same as the empty list.
+ */
+void searchPathAddList(struct SearchPath * const search_path, char const * list);
+
+
+/**
+ * Looks for the source file of the module with the given FQN in the directories of the search path.
+ * The module a.b.c is found in the first directory that contains a/b/c.avl.
+ *
+ * @param       search_path the search path to look into.
+ * @param       fqn the FQN of the module.
+ *
+ * @return      the path to the source file, to be freed by the caller, or NULL if no directory contains it.
+ */
+char * searchPathResolve(struct SearchPath const * const search_path, struct FQN const * const fqn);
+
+#endif
@@ -0,0 +1,50 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LEXER_KEYWORD_HASH_H
+#define LEXER_KEYWORD_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/* An entry of the keyword table generated by tools/keywords.c. Empty slots have a zero length. */
+struct Keyword {
+    char const * lexeme;
+    uint8_t length;
+    uint8_t type;
+};
+
+
+/**
+ * Hashes a lexeme into a keyword table slot.
+ * No two keywords share the same first character, last character and length so those three are all we mix.
+ * The generator searches for the seed that makes this hash collision-free over the keyword set.
+ *
+ * @param       lexeme pointer to the first character of the lexeme.
+ * @param       length the length of the lexeme, at least one.
+ * @param       seed the seed found by the generator.
+ * @param       bits the base two logarithm of the size of the keyword table.
+ *
+ * @return      the slot where the lexeme would be found if it were a keyword.
+ */
+static inline uint32_t keywordHash(char const * lexeme, size_t length, uint32_t seed, unsigned bits) {
+    uint32_t key = (uint32_t) (unsigned char) lexeme[0] | (uint32_t) (unsigned char) lexeme[length - 1] << 8 | (uint32_t) length << 16;
+    return ((key ^ seed) * 0x9E3779B1u) >> (32 - bits);
+}
+
+#endif
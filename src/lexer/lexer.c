@@ -16,44 +16,74 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
+#include "common/source_manager.h"
+#include "common/token_buffer.h"
+#include "common/char_class.h"
+#include "common/interner.h"
 #include "common/token_type.h"
 #include "common/token.h"
+#include "lexer/keywords.h"
+#include "lexer/literal.h"
 #include "lexer/lexer.h"
+#include "lexer/scan.h"
 
 
 static struct Token number(struct Lexer * const lexer);
 static struct Token identifier(struct Lexer * const lexer);
-static struct Token handleKeyword(struct Lexer * const lexer, size_t start, size_t length, char const * rest, enum TokenType type);
 static struct Token handleWhitespace(struct Lexer * const lexer, bool is_space, size_t whitespace_size);
-static void skipWhitespace(struct Lexer * const lexer);
+static bool skipWhitespace(struct Lexer * const lexer);
+static bool skipBlankLine(struct Lexer * const lexer);
 static void skipSingleComment(struct Lexer * const lexer);
-static void skipMultiComment(struct Lexer * const lexer);
+static bool skipMultiComment(struct Lexer * const lexer);
 static bool isAtStart(struct Lexer const * const lexer);
 static bool isAtEnd(struct Lexer const * const lexer);
 static char advance(struct Lexer * const lexer);
+static void skipTo(struct Lexer * const lexer, char const * end);
 static bool match(struct Lexer * const lexer, char expected);
 static char peek(struct Lexer const * const lexer);
 static char peekNext(struct Lexer const * const lexer);
 static char peekBack(struct Lexer const * const lexer);
 static bool isDigit(char c);
+static bool isHexDigit(char c);
 static bool isLetter(char c);
 static bool isAlpha(char c);
 static struct Token makeToken(struct Lexer const * const lexer, enum TokenType type);
-static struct Token errorToken(struct Lexer const * const lexer, char const * message);
+static struct Token errorToken(struct Lexer * const lexer, char const * message);
+static struct Token unterminatedComment(struct Lexer * const lexer);
+static struct Token literalToken(struct Lexer * const lexer, enum TokenType type, char const * digits, char const * end);
 
 
 /**
  * Initializes the lexer by allocate memory for it and setting up the Lexer struct fields.
  *
- * @param       file pointer to the file name which is used to show meaningful error messages.
- * @param       source pointer to the string containing the entirety of the source code contained in the source file.
+ * @param       sources the source manager holding the source to lex.
+ * @param       file the id of the source to lex, which must be loaded.
  */
-struct Lexer * newLexer(char const * file, char const * source) {
+struct Lexer * newLexer(struct SourceManager * const sources, uint16_t file) {
+    struct Source const * source = getSource(sources, file);
+    struct Lexer * lexer = newWindowLexer(source -> file -> content);
+    lexer -> sources = sources;
+    lexer -> file = file;
+    lexer -> length = source -> length;
+    lexer -> complete = true;
+
+    return lexer;
+}
+
+
+/**
+ * Initializes a lexer over a buffer that only holds the beginning of a source, such as the window of a streaming lexer.
+ * Such a lexer is driven with lexToken() and moved along its source with moveLexer(), it cannot be used with lexTokens().
+ *
+ * @param       window the null terminated buffer holding the beginning of the source.
+ */
+struct Lexer * newWindowLexer(char const * window) {
     struct Lexer * lexer = malloc(sizeof *lexer);
 
     if (lexer == NULL) {
@@ -61,26 +91,50 @@ struct Lexer * newLexer(char const * file, char const * source) {
         exit(74);
     }
 
-    lexer -> file = file;
-    lexer -> source = source;
-    lexer -> start = source;
-    lexer -> current = source;
-    lexer -> line = 1;
-    lexer -> column = 1;
-
-    lexer -> ignore_whitespace = true;
+    lexer -> sources = NULL;
+    lexer -> file = NO_SOURCE;
+    lexer -> source = window;
+    lexer -> length = 0;
+    lexer -> complete = false;
+    lexer -> start = window;
+    lexer -> current = window;
+    lexer -> error = NULL;
+
+    lexer -> ignore_whitespace = false;
+    lexer -> first_line = true;
+    lexer -> line_indentation = '\0';
+    lexer -> line_indentation_size = 0;
+    lexer -> comment_depth = 0;
+    lexer -> comment_distance = 0;
     lexer -> first_indentation_found = false;
     lexer -> is_first_indentation_space = false;
-    lexer -> first_indentation_line = 0;
-    lexer -> first_indentation_size = 0;
-    lexer -> last_indentation_size = 0;
-    lexer -> dedentation_count = 0;
-    lexer -> indentation_count = 0;
+    lexer -> first_indentation_offset = 0;
+    lexer -> indentations = newSizeTStack(16, "Ran out of memory while tracking indentation levels.");
+    lexer -> pending_dedents = 0;
+    lexer -> identifier_hash = 0;
+    lexer -> limbs = newUint64Vector(0, "Ran out of memory while decoding numeric literals.");
 
     return lexer;
 }
 
 
+/**
+ * Moves the lexer to another buffer holding what is left of its source, the lexer keeps track of indentation as if the source had not moved.
+ * Token offsets are relative to the new buffer from now on.
+ *
+ * @param       lexer pointer to the lexer.
+ * @param       source the null terminated buffer holding the rest of the source, the character before the current one included.
+ * @param       current where the lexer resumes in the buffer.
+ * @param       complete true if the buffer holds the end of the source, false if the source goes on past the buffer.
+ */
+void moveLexer(struct Lexer * const lexer, char const * source, char const * current, bool complete) {
+    lexer -> source = source;
+    lexer -> start = current;
+    lexer -> current = current;
+    lexer -> complete = complete;
+}
+
+
 /**
  * Frees the memory occupied by the lexer and associated structures.
  *
@@ -93,6 +147,8 @@ void deleteLexer(struct Lexer ** const lexer) {
     if (* lexer == NULL)
         return;
 
+    deleteSizeTStack(& (* lexer) -> indentations);
+    deleteUint64Vector(& (* lexer) -> limbs);
     free(* lexer);
     * lexer = NULL;
 }
@@ -111,77 +167,98 @@ struct Token lexToken(struct Lexer * const lexer) {
         exit(74);
     }
 
-    // We take care to issue dedentations that match indentations inside declarations
-    // This case is encountered when the number of whitespaces at the current line is less than the number of whitespaces the line before and the difference between those number of whitespaces is greater than the first indentation number of whitespace
-    while (lexer -> dedentation_count > 0) {
-        lexer -> dedentation_count--;
-        lexer -> indentation_count--;
-        return makeToken(lexer, AVL_DEDENT);
-    }
+    // Lines are read from their beginning so we know their indentation, the beginning of the source being the beginning of its first line
+    for (;;) {
+        // We take care to issue the remaining dedentations of a line that closed several indentation levels at once
+        if (lexer -> pending_dedents > 0) {
+            lexer -> start = lexer -> current;
+            lexer -> pending_dedents--;
+            return makeToken(lexer, AVL_DEDENT);
+        }
 
-    // We take care to issue dedentations that match indentations outside of declarations
-    // This case is encountered at the end of declarations where we need to issue dedent tokens that correpond to issued indent tokens that were introduced by the declaration body
-    // This case occurs because we won't have blank spaces before the next declaration begins but only (usually) new lines
-    if (peekBack(lexer) == '\n' && (peek(lexer) != ' ' && peek(lexer) != '\t' && peek(lexer) != '\n')) {
-        lexer -> dedentation_count = 0;
-        lexer -> last_indentation_size = 0;
+        // Past the beginning of a line, whitespace carries no meaning
+        if (lexer -> ignore_whitespace == true)
+            break;
 
-        while (lexer -> indentation_count > 0) {
-            lexer -> indentation_count--;
-            return makeToken(lexer, AVL_DEDENT);
+        // The indentation of a line is made of blank spaces or of tabulations
+        // A line the lexer stopped in, inside a comment at its beginning, had its indentation read already
+        char const * line = lexer -> current;
+        if (lexer -> comment_depth == 0) {
+            lexer -> line_indentation = peek(lexer);
+            if (lexer -> line_indentation == ' ' || lexer -> line_indentation == '\t')
+                skipTo(lexer, scanRun(lexer -> current, lexer -> line_indentation));
+            lexer -> line_indentation_size = (size_t) (lexer -> current - line);
         }
-    }
+        char const * indented = lexer -> current;
 
-    // We handle whitespace in order to issue indentation tokens if appropriate
-    // We have this specific case here because it allows us to ignore lines that begin with whitespace but end up with a new line as they are ultimately empty so long the parser is concerned and we shouldn't emit tokens for those empty lines
-    if (lexer -> ignore_whitespace == false && (peek(lexer) == ' ' || peek(lexer) == '\t')) {
-        bool is_space = false;
-        size_t whitespace_size = 0;
+        // Lines that only contain whitespace and comments are ultimately empty so far as the parser is concerned so we skip them, new line included, and start over with the next line
+        // Generated sources can contain long runs of such lines so we go around this loop instead of calling lexToken() again, which keeps the stack depth constant regardless of how many there are
+        if (skipBlankLine(lexer))
+            continue;
 
-        if (peek(lexer) == ' ')
-            is_space = true;
+        if (lexer -> comment_depth > 0)
+            return unterminatedComment(lexer);
 
-        if (is_space) {
-            while (peek(lexer) == ' ') {
-                advance(lexer);
-                whitespace_size++;
-            }
-        }
-        else {
-            while (peek(lexer) == '\t') {
-                advance(lexer);
-                whitespace_size++;
-            }
-        }
+        // The end of the source, or of the window of a streaming lexer, ends the last line before it holds any token
+        if (isAtEnd(lexer))
+            break;
 
-        // If the next character after the whitespace read is not a new line, we handle the current whitespace in expectation of an INDENT, DEDENT or NO_INDENT token
-        if (peek(lexer) != '\n') {
-            return handleWhitespace(lexer, is_space, whitespace_size);
-        }
-        // If we do have a new line after reading all the whitespace, we consume the new line and ask the lexer to lex anew
-        else {
-            advance(lexer);
-            lexer -> line++;
-            lexer -> column = 1;
-            return lexToken(lexer);
+        // The indentation tokens span the whitespace that makes up the indentation
+        // When a comment comes first on the line, they sit right before the first token instead since the comment may begin before the window of a streaming lexer
+        lexer -> start = lexer -> current == indented ? line : lexer -> current;
+
+        // The indentation of the first line of the source is not significant
+        if (lexer -> first_line) {
+            lexer -> first_line = false;
+            lexer -> ignore_whitespace = true;
+            break;
         }
-    }
 
-    // If the previous token was a new line but the next token is not a space, we can ignore whitespace until the next new line is reached
-    if (peekBack(lexer) == '\n' && peek(lexer) != ' ' && peek(lexer) != '\t')
+        // The line is indented so we handle its indentation in expectation of an INDENT, DEDENT or NO_INDENT token
+        if (lexer -> line_indentation_size > 0)
+            return handleWhitespace(lexer, lexer -> line_indentation == ' ', lexer -> line_indentation_size);
+
+        // A line that is not indented closes every indentation level still open, such as those introduced by the body of the declaration before it
         lexer -> ignore_whitespace = true;
+        size_t levels = sizeTStackSize(lexer -> indentations);
+        if (levels > 0) {
+            clearSizeTStack(lexer -> indentations);
+            lexer -> pending_dedents = levels - 1;
+            return makeToken(lexer, AVL_DEDENT);
+        }
+
+        break;
+    }
 
     // Before lexing the next token, we make sure to skip any unnecessary whitespace if we are allowed to.
-    if (lexer -> ignore_whitespace == true)
-        skipWhitespace(lexer);
+    if (lexer -> ignore_whitespace == true && skipWhitespace(lexer) == false)
+        return unterminatedComment(lexer);
 
     lexer -> start = lexer -> current;
 
-    if (isAtEnd(lexer))
+    // The end of the source closes every indentation level still open, whether the last line ends with a new line or not, so INDENT and DEDENT tokens always balance
+    // The end of the buffer of a lexer over a window of a source is not the end of the source so the lexer stops there without closing anything
+    if (isAtEnd(lexer)) {
+        size_t levels = sizeTStackSize(lexer -> indentations);
+        if (levels > 0 && lexer -> complete) {
+            clearSizeTStack(lexer -> indentations);
+            lexer -> pending_dedents = levels - 1;
+            return makeToken(lexer, AVL_DEDENT);
+        }
+
         return makeToken(lexer, AVL_EOF);
+    }
     
     char c = advance(lexer);
 
+    // Identifiers and numbers are the most frequent tokens so we dispatch on their class before looking at individual characters
+    uint16_t classes = char_classes[(unsigned char) c];
+    if ((classes & CHAR_LETTER) != 0)
+        return identifier(lexer);
+
+    if ((classes & CHAR_DIGIT) != 0)
+        return number(lexer);
+
     switch (c) {
         case '.':
             return makeToken(lexer, AVL_DOT);
@@ -207,7 +284,7 @@ struct Token lexToken(struct Lexer * const lexer) {
             return makeToken(lexer, match(lexer, '*') ? AVL_POW : AVL_MUL);
 
         case '/':
-            return makeToken(lexer, match(lexer, '-') ? AVL_NS_CLOSE : AVL_MINUS);
+            return makeToken(lexer, match(lexer, '-') ? AVL_NS_CLOSE : AVL_DIV);
 
         case '%':
             return makeToken(lexer, AVL_MOD);
@@ -256,7 +333,7 @@ struct Token lexToken(struct Lexer * const lexer) {
             return makeToken(lexer, AVL_LEFT_BRACKET);
 
         case ']':
-            return makeToken(lexer, AVL_RIGHT_PAREN);
+            return makeToken(lexer, AVL_RIGHT_BRACKET);
 
         case '{':
             return makeToken(lexer, AVL_LEFT_BRACE);
@@ -269,37 +346,86 @@ struct Token lexToken(struct Lexer * const lexer) {
             return makeToken(lexer, AVL_UNDERSCORE);
 
         case '\n': {
+            // We return only the current new line
+            struct Token token = makeToken(lexer, AVL_NEWLINE);
+
             // We ignore all new lines that follow the current one because they provide no useful information to the parser
-            while (peek(lexer) == '\n') {
+            while (peek(lexer) == '\n')
                 advance(lexer);
-                lexer -> line++;
-            }
 
-            // We return only the current new line
-            struct Token token = makeToken(lexer, AVL_NEWLINE);
-            lexer -> line++;
-            lexer -> column = 1;
             lexer -> ignore_whitespace = false;
             return token;
         }
 
-        case '\t':
-            fprintf(stderr, "[Lexer bug]:\nFile: %s.\nLine: %d.\nMessage: We reached a switch case that handles tabulations but these cases are to handled before getting the next non-whitespace character.\n", __FILE__, __LINE__);
-            exit(74);
+        default:
+            break;
+    }
 
-        case ' ':
-            fprintf(stderr, "[Lexer bug]:\nFile: %s.\nLine: %d.\nMessage: We reached a switch case that handles blank spaces but these cases are to handled before getting the next non-whitespace character.\n", __FILE__, __LINE__);
-            exit(74);
+    return errorToken(lexer, "Unexpected character.");
+}
 
-        default:
-            if (isAlpha(c))
-                return identifier(lexer);
 
-            if (isDigit(c))
-                return number(lexer);
+/**
+ * Lexes the entire source in one go and returns all the tokens packed in a token buffer.
+ * The last token in the buffer is always the EOF token.
+ * Identifiers are interned into the global interner once the source is lexed and their symbols recorded in the buffer.
+ *
+ * @param       lexer pointer to the lexer.
+ *
+ * @return      the token buffer holding every token found in the source.
+ */
+struct TokenBuffer * lexTokens(struct Lexer * const lexer) {
+    if (lexer == NULL) {
+        fprintf(stderr, "File: %s\n.Line: %d.\nOperation: lexTokens.\nMessage: The lexer cannot be NULL.\n", __FILE__, __LINE__);
+        exit(74);
+    }
+
+    // The source manager already made sure every offset in the source fits on 32 bits.
+    // On average, a token is a handful of bytes long so we size the buffer accordingly to avoid growing it too often
+    // Pages of the buffer no token reaches are never touched so overestimating only costs address space
+    struct Source const * source = getSource(lexer -> sources, lexer -> file);
+    struct TokenBuffer * buffer = newTokenBuffer(lexer -> file, source -> base, lexer -> source, lexer -> length / 4 + 16, "Ran out of memory while lexing tokens.");
+    for (;;) {
+        struct Token token = lexToken(lexer);
+        if (token.type == AVL_ERROR)
+            tokenBufferPushError(buffer, & token, lexer -> error);
+        else if (token.type >= AVL_CLASSICAL_INT && token.type <= AVL_QUANTUM_DEC)
+            tokenBufferPushLiteral(buffer, & token, & lexer -> literal);
+        else
+            tokenBufferPush(buffer, & token);
+
+        // The hash of an identifier is parked in its symbol slot until the whole source is lexed
+        if (token.type == AVL_IDENTIFIER)
+            tokenBufferSetSymbol(buffer, tokenBufferSize(buffer) - 1, lexer -> identifier_hash);
+
+        // When a line closes several indentation levels, we append all its DEDENT tokens at once instead of going through lexToken() for each
+        if (token.type == AVL_DEDENT) {
+            for (; lexer -> pending_dedents > 0; lexer -> pending_dedents--)
+                tokenBufferPush(buffer, & token);
+        }
+
+        if (token.type == AVL_EOF)
+            break;
     }
 
-    return errorToken(lexer, "Unexpected character.");
+    // The limbs of bit patterns were decoded straight into the pool of the lexer, which the buffer takes over
+    struct Uint64Vector * limbs = buffer -> limbs;
+    buffer -> limbs = lexer -> limbs;
+    lexer -> limbs = limbs;
+
+    // Modules are lexed concurrently so identifiers are interned in one batch under a single lock instead of contending for it on every identifier
+    struct Interner * interner = globalInterner();
+    lockInterner(interner);
+    for (size_t i = 0; i < buffer -> size; i++) {
+        if (buffer -> types[i] == AVL_IDENTIFIER)
+            buffer -> symbols[i] = internLocked(interner, buffer -> source + buffer -> offsets[i], buffer -> lengths[i], buffer -> symbols[i]);
+    }
+    unlockInterner(interner);
+
+    // The buffer outlives the lexing in the program that owns it so it gives back the capacity it did not use
+    tokenBufferShrink(buffer);
+
+    return buffer;
 }
 
 
@@ -314,6 +440,9 @@ static struct Token number(struct Lexer * const lexer) {
     bool is_classical = true;
     bool is_decimal = false;
 
+    // What lies between the data type and the data format is the payload the value of the literal is decoded from
+    char const * digits = lexer -> start;
+
     // if the type of data was specified, we watch out for quantum data as classical is already the default
     if (peekBack(lexer) == '0' && (peek(lexer) == 'c' || peek(lexer) == 'q')) {
         if (peek(lexer) == 'c')
@@ -323,15 +452,15 @@ static struct Token number(struct Lexer * const lexer) {
 
         // We consume the data type identifier
         advance(lexer);
+        digits = lexer -> current;
     }
     // If we do have 0 but the peeked at character is a letter and of course not an hexadecimal digit and not <c> or <q> then we inform the user of malformed data.
-    else if (peekBack(lexer) == '0' && isLetter(peek(lexer)) && !isDigit(peek(lexer)) && peek(lexer) != 'c' && peek(lexer) != 'q') {
+    else if (peekBack(lexer) == '0' && isLetter(peek(lexer)) && !isHexDigit(peek(lexer)) && peek(lexer) != 'c' && peek(lexer) != 'q') {
         return errorToken(lexer, "Expected <c> or <q> to indicate whether we have classical or quantum data.");
     }
 
-    // Now we proceed to matching the actual number itself
-    while (isDigit(peek(lexer)))
-        advance(lexer);
+    // Now we proceed to matching the actual number itself, hexadecimal digits included since the data format comes after the digits
+    skipTo(lexer, scanDigits(lexer -> current));
 
     // Match the fractional part if any
     if (peek(lexer) == '.' && isDigit(peekNext(lexer))) {
@@ -346,6 +475,7 @@ static struct Token number(struct Lexer * const lexer) {
     }
 
     // Match the data format
+    char const * end = lexer -> current;
     char format = peek(lexer);
     if (isLetter(format)) {
         // Consume the data format
@@ -353,16 +483,16 @@ static struct Token number(struct Lexer * const lexer) {
 
         if (is_classical && !is_decimal) {
             if (format == 'b') {
-                return makeToken(lexer, AVL_CLASSICAL_BIT);
+                return literalToken(lexer, AVL_CLASSICAL_BIT, digits, end);
             }
             else if (format == 'h') {
-                return makeToken(lexer, AVL_CLASSICAL_HEX);
+                return literalToken(lexer, AVL_CLASSICAL_HEX, digits, end);
             }
             else if (format == 'o') {
-                return makeToken(lexer, AVL_CLASSICAL_OCT);
+                return literalToken(lexer, AVL_CLASSICAL_OCT, digits, end);
             }
             else if(format == 'd') {
-                return makeToken(lexer, AVL_CLASSICAL_INT);
+                return literalToken(lexer, AVL_CLASSICAL_INT, digits, end);
             }
             else {
                 return errorToken(lexer, "Unexpected data format for classical integers. Valid formats for integers are: <b> for bits, <h> for hexadecimals, <o> for octals and <d> for base 10.");
@@ -370,24 +500,27 @@ static struct Token number(struct Lexer * const lexer) {
         }
         else if (is_classical && is_decimal) {
             if (format == 'f') {
-                return makeToken(lexer, AVL_CLASSICAL_FLOAT);
+                return literalToken(lexer, AVL_CLASSICAL_FLOAT, digits, end);
             }
             else if (format == 'd') {
-                return makeToken(lexer, AVL_CLASSICAL_DEC);
+                return literalToken(lexer, AVL_CLASSICAL_DEC, digits, end);
+            }
+            else {
+                return errorToken(lexer, "Unexpected data format for classical floating point numbers. Valid formats for floating point numbers are: <f> for floats and <d> for decimals.");
             }
         }
         else if (!is_classical && !is_decimal) {
             if (format == 'b') {
-                return makeToken(lexer, AVL_QUANTUM_BIT);
+                return literalToken(lexer, AVL_QUANTUM_BIT, digits, end);
             }
             else if (format == 'h') {
-                return makeToken(lexer, AVL_QUANTUM_HEX);
+                return literalToken(lexer, AVL_QUANTUM_HEX, digits, end);
             }
             else if (format == 'o') {
-                return makeToken(lexer, AVL_QUANTUM_OCT);
+                return literalToken(lexer, AVL_QUANTUM_OCT, digits, end);
             }
             else if(format == 'd') {
-                return makeToken(lexer, AVL_QUANTUM_INT);
+                return literalToken(lexer, AVL_QUANTUM_INT, digits, end);
             }
             else {
                 return errorToken(lexer, "Unexpected data format for quantum integers. Valid formats for integers are: <b> for bits, <h> for hexadecimals, <o> for octals and <d> for base 10.");
@@ -395,26 +528,29 @@ static struct Token number(struct Lexer * const lexer) {
         }
         else {
             if (format == 'f') {
-                return makeToken(lexer, AVL_QUANTUM_FLOAT);
+                return literalToken(lexer, AVL_QUANTUM_FLOAT, digits, end);
             }
             else if (format == 'd') {
-                return makeToken(lexer, AVL_QUANTUM_DEC);
+                return literalToken(lexer, AVL_QUANTUM_DEC, digits, end);
+            }
+            else {
+                return errorToken(lexer, "Unexpected data format for quantum floating point numbers. Valid formats for floating point numbers are: <f> for floats and <d> for decimals.");
             }
         }
     }
     else {
         // If the data format is missing, we go on to assume default data formats.
         if (is_classical && !is_decimal) {
-            return makeToken(lexer, AVL_CLASSICAL_INT);
+            return literalToken(lexer, AVL_CLASSICAL_INT, digits, end);
         }
         else if (is_classical && is_decimal) {
-            return makeToken(lexer, AVL_CLASSICAL_FLOAT);
+            return literalToken(lexer, AVL_CLASSICAL_FLOAT, digits, end);
         }
         else if (!is_classical && !is_decimal) {
-            return makeToken(lexer, AVL_QUANTUM_INT);
+            return literalToken(lexer, AVL_QUANTUM_INT, digits, end);
         }
         else {
-            return makeToken(lexer, AVL_QUANTUM_FLOAT);
+            return literalToken(lexer, AVL_QUANTUM_FLOAT, digits, end);
         }
     }
 
@@ -433,252 +569,17 @@ static struct Token number(struct Lexer * const lexer) {
  * @return      a IDENTIFIER token.
  */
 static struct Token identifier(struct Lexer * const lexer) {
-    while (isAlpha(peek(lexer)) || isDigit(peek(lexer)))
-        advance(lexer);
-
-    switch (lexer -> start[0]) {
-        case 'a':
-            return handleKeyword(lexer, 1, 2, "nd", AVL_LOGICAL_AND);
-
-        case 'b':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'a':
-                        return handleKeyword(lexer, 2, 2, "nd", AVL_BITWISE_AND);
-
-                    case 'n':
-                        return handleKeyword(lexer, 2, 2, "ot", AVL_BITWISE_NOT);
-
-                    case 'o':
-                        return handleKeyword(lexer, 2, 1, "r", AVL_BITWISE_OR);
-
-                    case 'r':
-                        return handleKeyword(lexer, 2, 3, "eak", AVL_BREAK);
-                }
-            }
-            break;
-
-        case 'c':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'a':
-                        if (lexer -> current - lexer -> start <= 2)
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> start[2] != 's')
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> current - lexer -> start > 3) {
-                            switch (lexer -> start[3]) {
-                                case 'e':
-                                    return handleKeyword(lexer, 3, 1, "e", AVL_CASE);
-
-                                case 't':
-                                    return handleKeyword(lexer, 3, 1, "t", AVL_CAST);
-                            }
-                        }
-                        break;
-
-                    case 'o':
-                        if (lexer -> current - lexer -> start <= 2)
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> start[2] != 'n')
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> current - lexer -> start > 3) {
-                            switch (lexer -> start[3]) {
-                                case 's':
-                                    return handleKeyword(lexer, 4, 1, "t", AVL_CONST);
-
-                                case 't':
-                                    return handleKeyword(lexer, 4, 4, "inue", AVL_CONTINUE);
-                            }
-                        }
-                        break;
-                }
-            }
-            break;
-
-        case 'd':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'e':
-                        if (lexer -> current - lexer -> start <= 2)
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> start[2] != 'f')
-                            return makeToken(lexer, AVL_IDENTIFIER);
-
-                        if (lexer -> current -  lexer -> start > 3) {
-                            switch (lexer -> start[3]) {
-                                case 'a':
-                                    return handleKeyword(lexer, 4, 3, "ult", AVL_DEFAULT);
-
-                                case 'f':
-                                    return handleKeyword(lexer, 3, 1, "f", AVL_DEF);
-                            }
-                        }
-                        break;
-
-                    case 'r':
-                        return handleKeyword(lexer, 2, 2, "ef", AVL_DREF);
-                }
-            }
-            break;
-
-        case 'e':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'l':
-                        if (lexer -> current - lexer -> start > 2) {
-                            switch (lexer -> start[2]) {
-                                case 'i':
-                                    return handleKeyword(lexer, 3, 1, "f", AVL_ELIF);
-
-                                case 's':
-                                    return handleKeyword(lexer, 3, 1, "e", AVL_ELSE);
-                            }
-                        }
-                        break;
-
-                    case 'm':
-                        return handleKeyword(lexer, 2, 3, "pty", AVL_EMPTY);
-                }
-            }
-            break;
-
-        case 'f':
-            return handleKeyword(lexer, 1, 2, "or", AVL_FOR);
-
-        case 'i':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'f':
-                        return handleKeyword(lexer, 1, 1, "f", AVL_IF);
-
-                    case 'm':
-                        return handleKeyword(lexer, 2, 4, "port", AVL_IMPORT);
-
-                    case 'n':
-                        return handleKeyword(lexer, 1, 1, "n", AVL_IN);
-
-                    case 's':
-                        return handleKeyword(lexer, 1, 1, "s", AVL_IS);
-                }
-            }
-            break;
-
-        case 'l':
-            return handleKeyword(lexer, 1, 2, "sh", AVL_LEFT_SHIFT);
-
-        case 'n':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'a':
-                        return handleKeyword(lexer, 2, 7, "mespace", AVL_NAMESPACE);
-
-                    case 'e':
-                        return handleKeyword(lexer, 2, 2, "xt", AVL_NEXT);
-
-                    case 'o':
-                        return handleKeyword(lexer, 2, 1, "t", AVL_LOGICAL_NOT);
-                }
-            }
-            break;
-
-        case 'o':
-            return handleKeyword(lexer, 1, 1, "r", AVL_LOGICAL_OR);
-
-        case 'p':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'a':
-                        return handleKeyword(lexer, 2, 2, "ss", AVL_PASS);
-
-                    case 'r':
-                        if (lexer -> current - lexer -> start > 2) {
-                            switch (lexer -> start[2]) {
-                                case 'e':
-                                    return handleKeyword(lexer, 3, 1, "v", AVL_PREV);
-
-                                case 'i':
-                                    return handleKeyword(lexer, 3, 4, "vate", AVL_PRIVATE);
-                            }
-                        }
-                        break;
-
-                    case 't':
-                        return handleKeyword(lexer, 2, 1, "r", AVL_PTR);
-
-                    case 'u':
-                        return handleKeyword(lexer, 2, 4, "blic", AVL_PUBLIC);
-                }
-            }
-            break;
-
-        case 'r':
-            if (lexer -> current - lexer -> start > 1) {
-                switch (lexer -> start[1]) {
-                    case 'e':
-                        if (lexer -> current - lexer -> start > 2) {
-                            switch (lexer -> start[2]) {
-                                case 'f':
-                                    return handleKeyword(lexer, 2, 1, "f", AVL_REF);
-
-                                case 't':
-                                    return handleKeyword(lexer, 3, 3, "urn", AVL_RETURN);
-                            }
-                        }
-                        break;
-
-                    case 's':
-                        return handleKeyword(lexer, 2, 1, "h", AVL_RIGHT_SHIFT);
-                }
-            }
-            break;
-
-        case 's':
-            return handleKeyword(lexer, 1, 5, "witch", AVL_SWITCH);
-
-        case 't':
-            return handleKeyword(lexer, 1, 3, "ype", AVL_TYPE);
-
-        case 'u':
-            return handleKeyword(lexer, 1, 5, "nique", AVL_UNIQUE);
-
-        case 'v':
-            if (lexer -> current - lexer -> start <= 1)
-                return makeToken(lexer, AVL_IDENTIFIER);
-
-            if (lexer -> start[1] != 'a')
-                return makeToken(lexer, AVL_IDENTIFIER);
-
-            if (lexer -> current - lexer -> start > 2) {
-                switch (lexer -> start[2]) {
-                    case 'r':
-                        return handleKeyword(lexer, 2, 1, "r", AVL_VAR);
-
-                    case 'l':
-                        return handleKeyword(lexer, 2, 1, "l", AVL_VAL);
-                }
-            }
-            break;
-
-        case 'w':
-            return handleKeyword(lexer, 1, 4, "hile", AVL_WHILE);
-
-        case 'x':
-            return handleKeyword(lexer, 1, 2, "or", AVL_BITWISE_XOR);
+    skipTo(lexer, scanIdentifier(lexer -> current));
+
+    // Keywords are recognized with one hash and one comparison against the generated perfect hash table
+    size_t length = (size_t) (lexer -> current - lexer -> start);
+    if (length <= KEYWORD_MAX_LENGTH) {
+        struct Keyword const * keyword = & keywords[keywordHash(lexer -> start, length, KEYWORD_SEED, KEYWORD_BITS)];
+        if (keyword -> length == length && memcmp(keyword -> lexeme, lexer -> start, length) == 0)
+            return makeToken(lexer, (enum TokenType) keyword -> type);
     }
 
-    return makeToken(lexer, AVL_IDENTIFIER);
-}
-
-static struct Token handleKeyword(struct Lexer * const lexer, size_t start, size_t length, char const * rest, enum TokenType type) {
-    if ((size_t) (lexer -> current - lexer -> start) == start + length && memcmp(lexer -> start + start, rest, length) == 0)
-        return makeToken(lexer, type);
-
+    lexer -> identifier_hash = symbolHash(lexer -> start, length);
     return makeToken(lexer, AVL_IDENTIFIER);
 }
 
@@ -713,70 +614,64 @@ static struct Token handleWhitespace(struct Lexer * const lexer, bool is_space,
             return errorToken(lexer, "Indentation using blank spaces is already is effect hence tabulation cannot be used for the same.");
     }
 
-    // Figure out if this is the first indentation and if not then this is our first indentation
+    // Remember what the first indentation was made of so all the others can be checked against it
     if (lexer -> first_indentation_found == false) {
         lexer -> first_indentation_found = true;
         lexer -> is_first_indentation_space = is_space;
-        lexer -> last_indentation_size = whitespace_size;
-        lexer -> first_indentation_line = lexer -> line;
-        lexer -> first_indentation_size = whitespace_size;
+        lexer -> first_indentation_offset = (uint32_t) (lexer -> start - lexer -> source);
+    }
+
+    // Every line start goes through here so the indentation stack is accessed through the unchecked operations
+    struct SizeTStack * const indentations = lexer -> indentations;
+    size_t current_indentation = sizeTStackSizeUnchecked(indentations) == 0 ? 0 : sizeTStackTopUnchecked(indentations);
 
-        lexer -> indentation_count = 1;
-        lexer -> last_indentation_size = whitespace_size;
+    // If the number of blank spaces (tabulations) found is equal to the number of blank spaces (tabulations) of the current level, we emit an NO_INDENT token
+    if (whitespace_size == current_indentation)
+        return makeToken(lexer, AVL_NO_INDENT);
+
+    // If the number of blank spaces (tabulations) found is greater than the number of blank spaces (tabulations) of the current level, we open a new level and emit an INDENT token
+    if (whitespace_size > current_indentation) {
+        sizeTStackPushUnchecked(indentations, whitespace_size);
         return makeToken(lexer, AVL_INDENT);
     }
-    // If this is not our first indentation, we make sure that the number of blank spaces (tabulations) matched is a multiple of the number of blank spaces (tabulations) matched for the first indentation
-    else  {
-        if (whitespace_size % lexer -> first_indentation_size != 0) {
-            if (is_space)
-                return errorToken(lexer, "Expected a valid indentation: the number of blank spaces that form a valid indentation must be a multiple of the number of blank spaces that form the first indentation.");
-            else
-                return errorToken(lexer, "Expected a valid indentation: the number of tabulations that form a valid indentation must be a multiple of the number of tabulations that form the first indentation.");
-        }
 
-        if (whitespace_size > lexer -> last_indentation_size && ((size_t) abs(whitespace_size - lexer -> last_indentation_size)) != lexer -> first_indentation_size) {
-            if (is_space)
-                return errorToken(lexer, "Expected a valid indentation: the number of blank spaces must increase by the number of blank spaces used for the first indentation.");
-            else
-                return errorToken(lexer, "Expected a valid indentation: the number of tabulations must increase by the number of tabulations used for the first indentation.");
-        }
-
-        if (whitespace_size < lexer -> last_indentation_size && ((size_t) abs(whitespace_size - lexer -> last_indentation_size)) % lexer -> first_indentation_size != 0) {
-            if (is_space)
-                return errorToken(lexer, "Expected a valid indentation: the number of blank spaces must decrease by the number of blank spaces used for the first indentation.");
-            else
-                return errorToken(lexer, "Expected a valid indentation: the number of tabulations must decrease by the number of tabulations used for the first indentation.");
-        }
+    // If the number of blank spaces (tabulations) found is less than the number of blank spaces (tabulations) of the current level, we close every level deeper than the current line
+    size_t closed_levels = 0;
+    while (sizeTStackSizeUnchecked(indentations) > 0 && sizeTStackTopUnchecked(indentations) > whitespace_size) {
+        sizeTStackPopUnchecked(indentations);
+        closed_levels++;
+    }
 
-        // We figure out if we must emit a INDENT or DEDENT token
-        // If the number of blank spaces (tabulations) found is equal to the number of blank spaces (tabulations) of the last indentation (dedentation), we emit an NO_INDENT token
-        if (whitespace_size == lexer -> last_indentation_size) {
-            return makeToken(lexer, AVL_NO_INDENT);
-        }
-        // If the number of blank spaces (tabulations) found is greater than the number of blank spaces (tabulations) of the last indentation (dedentation), we emit an INDENT token
-        else if (whitespace_size > lexer -> last_indentation_size) {
-            lexer -> indentation_count = whitespace_size / lexer -> first_indentation_size;
-            lexer -> last_indentation_size = whitespace_size;
-            return makeToken(lexer, AVL_INDENT);
-        }
-        // If the number of blank spaces (tabulations) found is less thank the number of blank spaces (tabulations) of the last indentation (dedentation), we emit a DEDENT token
-        else {
-            size_t new_whitespace = lexer -> last_indentation_size - whitespace_size;
-            lexer -> dedentation_count = (new_whitespace / lexer -> first_indentation_size) - 1;
-            lexer -> indentation_count--;
-            lexer -> last_indentation_size = whitespace_size;
-            return makeToken(lexer, AVL_DEDENT);
-        }
+    // The line must land exactly on a level that is still open
+    // Otherwise the levels it closed are still closed with DEDENT tokens after the error so the parser finds where the blocks end and resumes from there
+    current_indentation = sizeTStackSizeUnchecked(indentations) == 0 ? 0 : sizeTStackTopUnchecked(indentations);
+    if (whitespace_size != current_indentation) {
+        lexer -> pending_dedents = closed_levels;
+        if (is_space)
+            return errorToken(lexer, "Expected a valid dedentation: the number of blank spaces must match the number of blank spaces of an enclosing indentation.");
+        else
+            return errorToken(lexer, "Expected a valid dedentation: the number of tabulations must match the number of tabulations of an enclosing indentation.");
     }
+
+    // We emit the first DEDENT token now and the others from lexToken()
+    lexer -> pending_dedents = closed_levels - 1;
+    return makeToken(lexer, AVL_DEDENT);
 }
 
 
 /**
- * Ignores whitespace when appropriate. Whitespace includes: spaces, tabulations and carriage returns.
+ * Ignores whitespace when appropriate. Whitespace includes: spaces, tabulations, carriage returns and comments.
+ * New lines are left to the caller since they end the current line.
  *
  * @param       lexer pointer to the lexer.
+ *
+ * @return      false if a multi line comment runs until the end of the buffer without being closed, true otherwise.
  */
-static void skipWhitespace(struct Lexer * const lexer) {
+static bool skipWhitespace(struct Lexer * const lexer) {
+    // A comment the lexer stopped in at the end of its previous buffer comes first
+    if (lexer -> comment_depth > 0 && skipMultiComment(lexer) == false)
+        return false;
+
     for (;;) {
         char c = peek(lexer);
         switch (c) {
@@ -784,7 +679,7 @@ static void skipWhitespace(struct Lexer * const lexer) {
             case '\r':
             case '\t':
             case ' ':
-                advance(lexer);
+                skipTo(lexer, scanBlanks(lexer -> current));
                 break;
 
             // We treat comments as whitespace and handle them here
@@ -795,24 +690,44 @@ static void skipWhitespace(struct Lexer * const lexer) {
                 else if (peekNext(lexer) == '[') {
                     // since we are sure we have a multi line comment, we consume the MINUS token in order to avoid clashing with nested comments
                     advance(lexer);
-                    skipMultiComment(lexer);
+                    if (skipMultiComment(lexer) == false)
+                        return false;
                 }
                 else {
-                    goto continue_skipping;
+                    return true;
                 }
                 break;
 
             default:
-                goto continue_skipping;
+                return true;
         }
     }
+}
+
+
+/**
+ * Skips the rest of the current line, new line included, if it only contains whitespace and comments.
+ * A multi line comment that begins on the line makes it blank so long as nothing but whitespace follows it on the line it ends on.
+ *
+ * @param       lexer pointer to the lexer.
+ *
+ * @return      true if the line was blank and was skipped, false if the line holds a token, if the buffer ends before the line does or if a multi line comment is not closed.
+ */
+static bool skipBlankLine(struct Lexer * const lexer) {
+    char const * line = lexer -> current;
+    if (skipWhitespace(lexer) == false)
+        return false;
 
-continue_skipping:
-    // If the last token before skipping whitespace characters was a new line and the next if a new line, we ignore the fresh new line
-    while (peekBack(lexer) == '\n' && peek(lexer) == '\n') {
+    if (peek(lexer) == '\n') {
         advance(lexer);
-        lexer -> line++;
+        return true;
     }
+
+    // A token follows on the line, the whitespace before it is left for its indentation to be checked unless a comment comes first
+    if (isAtEnd(lexer) == false && scanBlanks(line) == lexer -> current)
+        skipTo(lexer, line);
+
+    return false;
 }
 
 
@@ -822,28 +737,31 @@ continue_skipping:
  * @param       lexer pointer to the lexer.
  */
 static void skipSingleComment(struct Lexer * const lexer) {
-    while (peek(lexer) != '\n' && isAtEnd(lexer) == false)
-        advance(lexer);
-
-    // we consume the newline since comments may appear at the beginning of a source
-    if (peek(lexer) == '\n' && isAtEnd(lexer) == false) {
-        advance(lexer);
-        lexer -> line++;
-        lexer -> column = 1;
-    }
+    // The new line is left for the caller since it ends the line the comment is on
+    skipTo(lexer, scanLine(lexer -> current));
 }
 
 
 /**
- * Skips multiple lines comments.
+ * Skips multiple lines comments, the lexer being right after the opening dash or where it stopped inside the comment at the end of its previous buffer.
+ * When the buffer ends before the comment does, the lexer remembers how deeply nested it is in the comment and where the comment begins.
  *
  * @param       lexer pointer to the lexer.
+ *
+ * @return      false if the comment runs until the end of the buffer without being closed, true otherwise.
  */
-static void skipMultiComment(struct Lexer * const lexer) {
+static bool skipMultiComment(struct Lexer * const lexer) {
+    char const * resumed = lexer -> current;
     size_t levels = 0;
-    size_t line = lexer -> line;
+    uint32_t distance = 1;
     bool terminated = false;
 
+    // A comment the lexer stopped in goes on with the comments that were open then
+    if (lexer -> comment_depth > 0) {
+        levels = lexer -> comment_depth - 1;
+        distance = lexer -> comment_distance;
+    }
+
     while (isAtEnd(lexer) == false) {
         // if we have nested comments
         if (peek(lexer) == '-' && peekNext(lexer) == '[') {
@@ -860,31 +778,24 @@ static void skipMultiComment(struct Lexer * const lexer) {
                 terminated = true;
                 break;
             }
-            else {
-                levels--;
-            }
+
+            // The closing characters are consumed already so we look at what follows them, which may well be the end of the source
+            levels--;
+            continue;
         }
         
-        // Gracefully handle newlines inside comments
-        if (peek(lexer) == '\n') {
-            lexer -> line++;
-            lexer -> column = 1;
-        }
-
         advance(lexer);
     }
 
+    // The new line after the comment is left for the caller since it ends the line the comment is on
     if (isAtEnd(lexer) && terminated == false) {
-        fprintf(stderr, "Unterminated multi line comment starting at line %zu.\n", line);
-        exit(74);
+        lexer -> comment_depth = levels + 1;
+        lexer -> comment_distance = distance + (uint32_t) (lexer -> current - resumed);
+        return false;
     }
 
-    // we consume the newline since comments may appear at the beginning of a source
-    if (peek(lexer) == '\n' && isAtEnd(lexer) == false) {
-        advance(lexer);
-        lexer -> line++;
-        lexer -> column = 1;
-    }
+    lexer -> comment_depth = 0;
+    return true;
 }
 
 
@@ -896,7 +807,7 @@ static void skipMultiComment(struct Lexer * const lexer) {
  * @return      true if we are at the beginning of the source, false otherwise.
  */
 static bool isAtStart(struct Lexer const * const lexer) {
-    return * lexer -> current == * lexer -> source;
+    return lexer -> current == lexer -> source;
 }
 
 
@@ -921,11 +832,22 @@ static bool isAtEnd(struct Lexer const * const lexer) {
  */
 static char advance(struct Lexer * const lexer) {
     lexer -> current++;
-    lexer -> column++;
     return lexer -> current[-1];
 }
 
 
+/**
+ * Moves the current position forward to the given position.
+ * This is used with the scanning kernels which find the end of an entire span at once.
+ *
+ * @param       lexer pointer to the lexer.
+ * @param       end the position to move to.
+ */
+static void skipTo(struct Lexer * const lexer, char const * end) {
+    lexer -> current = end;
+}
+
+
 /**
  * Returns true if the current character macthes the given one. It advances pointer to the next available character if the match succeeds.
  *
@@ -941,7 +863,6 @@ static bool match(struct Lexer * const lexer, char expected) {
     if (* lexer -> current != expected)
         return false;
 
-    lexer -> column++;
     lexer -> current++;
     return true;
 }
@@ -990,12 +911,22 @@ static char peekBack(struct Lexer const * const lexer) {
 
 
 /**
- * Returns true if the given character is a digit.
+ * Returns true if the given character is a decimal digit.
  *
  * @param       c the character to verify being a digit.
  */
 static bool isDigit(char c) {
-    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F');
+    return isCharClass(c, CHAR_DIGIT);
+}
+
+
+/**
+ * Returns true if the given character is a decimal digit or an uppercase hexadecimal digit.
+ *
+ * @param       c the character to verify being a hexadecimal digit.
+ */
+static bool isHexDigit(char c) {
+    return isCharClass(c, CHAR_HEX_DIGIT);
 }
 
 
@@ -1005,7 +936,7 @@ static bool isDigit(char c) {
  * @param       c the character to verify being a letter.
  */
 static bool isLetter(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    return isCharClass(c, CHAR_LETTER);
 }
 
 
@@ -1015,7 +946,7 @@ static bool isLetter(char c) {
  * @param       c the character to verify being a letter or underscore.
  */
 static bool isAlpha(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    return isCharClass(c, CHAR_IDENT_START);
 }
 
 
@@ -1029,31 +960,65 @@ static bool isAlpha(char c) {
 static struct Token makeToken(struct Lexer const * const lexer, enum TokenType type) {
     struct Token token;
     token.type = type;
-    token.file = lexer -> file;
-    token.start = lexer -> start;
-    token.length = (size_t)(lexer -> current - lexer -> start);
-    token.line = lexer -> line;
-    token.column = lexer -> column;
+    token.offset = (uint32_t) (lexer -> start - lexer -> source);
+    token.length = (uint32_t) (lexer -> current - lexer -> start);
 
     return token;
 }
 
 
 /**
- * Creates an error token.
+ * Creates an error token spanning the characters read since the beginning of the current lexeme.
+ * The message is kept by the lexer until the next error.
  *
  * @param       lexer pointer to the lexer.
+ * @param       message the description of the error.
  *
  * @return      the newly created token.
  */
-static struct Token errorToken(struct Lexer const * const lexer, char const * message) {
-    struct Token token;
-    token.type = AVL_ERROR;
-    token.file = lexer -> file;
-    token.start = message;
-    token.length = strlen(message);
-    token.line = lexer -> line;
-    token.column = lexer -> column;
+static struct Token errorToken(struct Lexer * const lexer, char const * message) {
+    lexer -> error = message;
+    return makeToken(lexer, AVL_ERROR);
+}
 
+
+/**
+ * Creates the token for a multi line comment that runs until the end of the buffer of the lexer without being closed.
+ * At the end of the source, this is an error that spans the opening of the comment rather than the whole rest of the source, and the next call returns EOF.
+ * At the end of the window of a streaming lexer, the lexer stops with an EOF token and goes on skipping the comment once it is moved along its source.
+ *
+ * @param       lexer pointer to the lexer.
+ *
+ * @return      the newly created token.
+ */
+static struct Token unterminatedComment(struct Lexer * const lexer) {
+    lexer -> start = lexer -> current;
+    if (lexer -> complete == false)
+        return makeToken(lexer, AVL_EOF);
+
+    lexer -> comment_depth = 0;
+    struct Token token = errorToken(lexer, "Unterminated multi line comment.");
+    token.offset -= lexer -> comment_distance;
+    token.length = 2;
     return token;
 }
+
+
+/**
+ * Creates a numeric literal token after decoding its value into the literal member of the lexer.
+ * The limbs of bit patterns are appended to the limb pool of the lexer.
+ *
+ * @param       lexer pointer to the lexer.
+ * @param       type the type of the literal.
+ * @param       digits the first character of the payload of the literal.
+ * @param       end the character after the last one of the payload.
+ *
+ * @return      the newly created token, or an error token if the payload is not valid for the type of the literal.
+ */
+static struct Token literalToken(struct Lexer * const lexer, enum TokenType type, char const * digits, char const * end) {
+    char const * error = decodeLiteral(type, digits, (size_t) (end - digits), & lexer -> literal, lexer -> limbs);
+    if (error != NULL)
+        return errorToken(lexer, error);
+
+    return makeToken(lexer, type);
+}
@@ -19,19 +19,34 @@
 #define LEXER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stddef.h>
 
+#include "common/source_manager.h"
+#include "common/token_buffer.h"
 #include "common/token_type.h"
 #include "common/token.h"
+#include "utils/vector.h"
+#include "utils/stack.h"
 
 
 struct Lexer {
-    char const * file;
+    /* The source being lexed and the manager it belongs to, which knows its name and where it lies among the other sources.
+     * A lexer over a window of a source has no source manager and only sees the part of the source its window holds.
+     */
+    struct SourceManager * sources;
+    uint16_t file;
     char const * source;
+    size_t length;
+
+    /* Whether the buffer of the lexer holds the end of the source, otherwise the end of the buffer is only where the lexer has to stop until it is moved along its source. */
+    bool complete;
+
     char const * start;
     char const * current;
-    size_t line;
-    size_t column;
+
+    /* The message of the last error token, the token itself only records where the error is. */
+    char const * error;
 
     /* The following members help us keep track of spaces since whitespace is significant in Avalon */
 
@@ -41,41 +56,90 @@ struct Lexer {
      */
     bool ignore_whitespace;
 
+    /* Line tracking.
+     * Lines are read from their beginning and skipped if they only contain whitespace and comments.
+     *
+     * first_line                   : signals that no line held a token yet, the indentation of the first line that does is not significant.
+     * line_indentation             : the character the indentation of the current line is made of, a blank space or a tabulation, or whatever character begins the line.
+     * line_indentation_size        : the number of blank spaces or tabulations the indentation of the current line is made of.
+     */
+    bool first_line;
+    char line_indentation;
+    size_t line_indentation_size;
+
+    /* Multi line comment tracking.
+     * A multi line comment can be longer than the window of a streaming lexer.
+     * The lexer then stops at the end of the window and, once it is moved along its source, goes on skipping the comment from where it stopped instead of lexing it again from its beginning.
+     *
+     * comment_depth                : the number of nested comments still open where the lexer stopped, 0 if it did not stop inside a comment.
+     * comment_distance             : the number of characters between the beginning of the outermost comment and where the lexer stopped, to report the comment if it is never closed.
+     */
+    size_t comment_depth;
+    uint32_t comment_distance;
+
     /* We do not allow indentation to at the very beginning of the source code.
-     * We also require that all indentations found in the source file be a multiple of the very first indentation found.
-     * Also, since spaces or tabs can be used for indentation, we require that only one of them be used throughout a source.
+     * Since spaces or tabs can be used for indentation, we require that only one of them be used throughout a source.
      *
      * first_indentation_found      : signals whether we have our first indentation.
      * is_first_indentation_space   : signals whehter the first indentation found is a space or a tab.
-     * first_indentation_line       : for error reporting purposes, we keep track of the line where the first indentation was found. This is so we can let users know how many spaces (tabs) their first indentation is made of.
-     * first_indentation_size      : the number of spaces (tabulations) encountered for the first indentation.
+     * first_indentation_offset     : for error reporting purposes, we keep track of the offset in the source where the first indentation was found.
      */
     bool first_indentation_found;
     bool is_first_indentation_space;
-    size_t first_indentation_line;
-    size_t first_indentation_size;
+    uint32_t first_indentation_offset;
 
     /* Indentation tracking
-     * This helps determine if we should emit an INDENT token or a DEDENT token.
+     * The stack holds the number of spaces (tabulations) of every indentation level currently open, the outermost level (no indentation) is implicit.
+     * A deeper line opens a level and emits an INDENT token, a shallower line closes every level deeper than itself and must land exactly on an open level.
+     * Nested levels can have any width: each level only needs to be deeper than the one enclosing it.
      */
-    size_t last_indentation_size;
+    struct SizeTStack * indentations;
 
     /**
      * Dedentation tracking
-     * THis helps determine how many dedentations tokens we should issue.
+     * When a line closes several levels at once, we emit the first DEDENT token right away and count the remaining ones here.
+     */
+    size_t pending_dedents;
+
+    /* Hash of the last identifier lexed, computed while its characters are still in cache so it can be interned without reading it again. */
+    uint32_t identifier_hash;
+
+    /* Value of the last numeric literal lexed, decoded while its characters are still in cache.
+     * The limbs of bit patterns are appended to the pool, which lexTokens() hands over to the token buffer.
      */
-    size_t indentation_count;
-    size_t dedentation_count;
+    struct Literal literal;
+    struct Uint64Vector * limbs;
 };
 
 
 /**
  * Initializes the lexer by allocate memory for it and setting up the Lexer struct fields.
  *
- * @param       file pointer to the file name which is used to show meaningful error messages.
- * @param       source pointer to the string containing the entirety of the source code contained in the source file.
+ * @param       sources the source manager holding the source to lex.
+ * @param       file the id of the source to lex, which must be loaded.
  */
-struct Lexer * newLexer(char const * file, char const * source);
+struct Lexer * newLexer(struct SourceManager * const sources, uint16_t file);
+
+
+/**
+ * Initializes a lexer over a buffer that only holds the beginning of a source, such as the window of a streaming lexer.
+ * Such a lexer is driven with lexToken() and moved along its source with moveLexer(), it cannot be used with lexTokens().
+ *
+ * @param       window the null terminated buffer holding the beginning of the source.
+ */
+struct Lexer * newWindowLexer(char const * window);
+
+
+/**
+ * Moves the lexer to another buffer holding what is left of its source, the lexer keeps track of indentation as if the source had not moved.
+ * Token offsets are relative to the new buffer from now on.
+ *
+ * @param       lexer pointer to the lexer.
+ * @param       source the null terminated buffer holding the rest of the source, the character before the current one included.
+ * @param       current where the lexer resumes in the buffer.
+ * @param       complete true if the buffer holds the end of the source, false if the source goes on past the buffer.
+ */
+void moveLexer(struct Lexer * const lexer, char const * source, char const * current, bool complete);
 
 
 /**
@@ -95,4 +159,16 @@ void deleteLexer(struct Lexer ** lexer);
  */
 struct Token lexToken(struct Lexer * const lexer);
 
+
+/**
+ * Lexes the entire source in one go and returns all the tokens packed in a token buffer.
+ * The last token in the buffer is always the EOF token.
+ * Identifiers are interned into the global interner and their symbols recorded in the buffer, numeric literals have their values recorded in the buffer.
+ *
+ * @param       lexer pointer to the lexer.
+ *
+ * @return      the token buffer holding every token found in the source.
+ */
+struct TokenBuffer * lexTokens(struct Lexer * const lexer);
+
 #endif
@@ -0,0 +1,356 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "common/token_buffer.h"
+#include "common/bitvector.h"
+#include "common/token_type.h"
+#include "lexer/literal.h"
+#include "utils/vector.h"
+
+
+/* Payloads only ever contain decimal digits and the uppercase hexadecimal digits A to F, besides the decimal point of floating point numbers.
+ * A digit is out of range for a base when its character has any of these bits set: letters have 0x40, 8 and 9 have 0x08, 2 to 7 have 0x02 or 0x04.
+ */
+#define DECIMAL_INVALID_BITS        0x40
+#define OCTAL_INVALID_BITS          0x48
+#define BINARY_INVALID_BITS         0x4E
+#define HEXADECIMAL_INVALID_BITS    0x00
+
+/* Every byte of a 64 bits integer set to the given byte. */
+#define BROADCAST(byte) (UINT64_C(0x0101010101010101) * (byte))
+
+/* Writes the limbs of the bit vector of a pattern from its least significant bit up, one limb at a time. */
+struct BitWriter {
+    uint64_t * limbs;
+    uint64_t limb;
+    unsigned filled;
+};
+
+static char const * decodeInteger(char const * digits, size_t length, uint64_t * const value);
+static char const * decodeReal(char const * digits, size_t length, double * const value);
+static char const * decodePattern(char const * digits, size_t length, unsigned bits, uint32_t * const width, struct Uint64Vector * const limbs);
+static void writeBits(struct BitWriter * const writer, uint64_t value, unsigned count);
+static uint64_t loadDigits(char const * digits);
+static uint64_t eightDecimalDigits(uint64_t chunk);
+static uint64_t eightPatternDigits(uint64_t chunk, unsigned bits);
+
+
+/**
+ * Decodes the payload of a numeric literal.
+ * Bit patterns of any width are packed into limbs appended to the given pool, the pool is left untouched if the payload is invalid.
+ *
+ * @param       type the type of the literal token, which tells the base and the kind of the value.
+ * @param       digits the first character of the payload.
+ * @param       length the number of characters in the payload.
+ * @param       literal set to the value of the literal.
+ * @param       limbs the pool the limbs of bit patterns are appended to.
+ *
+ * @return      NULL if the payload was decoded, otherwise the reason it is not a valid payload for the literal type.
+ */
+char const * decodeLiteral(enum TokenType type, char const * digits, size_t length, struct Literal * const literal, struct Uint64Vector * const limbs) {
+    // Only a literal that begins with its data type can have no digits, as in 0cb
+    if (length == 0)
+        return "Expected digits after the data type.";
+
+    literal -> width = 0;
+    switch (type) {
+        case AVL_CLASSICAL_INT:
+        case AVL_QUANTUM_INT:
+            return decodeInteger(digits, length, & literal -> value.integer);
+
+        case AVL_CLASSICAL_FLOAT:
+        case AVL_CLASSICAL_DEC:
+        case AVL_QUANTUM_FLOAT:
+        case AVL_QUANTUM_DEC:
+            return decodeReal(digits, length, & literal -> value.real);
+
+        case AVL_CLASSICAL_BIT:
+        case AVL_QUANTUM_BIT:
+            literal -> value.limbs = (uint32_t) uint64VectorSize(limbs);
+            return decodePattern(digits, length, 1, & literal -> width, limbs);
+
+        case AVL_CLASSICAL_OCT:
+        case AVL_QUANTUM_OCT:
+            literal -> value.limbs = (uint32_t) uint64VectorSize(limbs);
+            return decodePattern(digits, length, 3, & literal -> width, limbs);
+
+        case AVL_CLASSICAL_HEX:
+        case AVL_QUANTUM_HEX:
+            literal -> value.limbs = (uint32_t) uint64VectorSize(limbs);
+            return decodePattern(digits, length, 4, & literal -> width, limbs);
+
+        default:
+            fprintf(stderr, "[Lexer bug]:\nFile: %s.\nLine: %d.\nMessage: Attempted to decode a token that is not a numeric literal.\n", __FILE__, __LINE__);
+            exit(74);
+    }
+}
+
+
+/**
+ * Decodes a base 10 integer.
+ *
+ * @param       digits the first digit.
+ * @param       length the number of digits, at least one.
+ * @param       value set to the integer.
+ *
+ * @return      NULL if the integer was decoded, otherwise the reason it could not be.
+ */
+static char const * decodeInteger(char const * digits, size_t length, uint64_t * const value) {
+    char const * end = digits + length;
+
+    // Leading zeros do not count towards the 20 digits the largest 64 bits integer has
+    while (digits < end - 1 && * digits == '0')
+        digits++;
+
+    bool invalid = false;
+    if (end - digits > 20) {
+        for (; digits < end; digits++)
+            invalid = invalid || (* digits & DECIMAL_INVALID_BITS) != 0;
+        return invalid ? "Invalid digit in a base 10 integer. Only the digits 0 to 9 are allowed." : "Integer literal too large, integers are at most 64 bits wide.";
+    }
+
+    // The digits in front of the last multiple of eight never overflow since there are at most seven of them
+    uint64_t integer = 0;
+    for (; (end - digits) % 8 != 0; digits++) {
+        invalid = invalid || (* digits & DECIMAL_INVALID_BITS) != 0;
+        integer = integer * 10 + (uint64_t) (* digits - '0');
+    }
+
+    bool overflow = false;
+    for (; digits < end; digits += 8) {
+        uint64_t chunk = loadDigits(digits);
+        invalid = invalid || (chunk & BROADCAST(DECIMAL_INVALID_BITS)) != 0;
+
+        uint64_t group = eightDecimalDigits(chunk);
+        overflow = overflow || integer > (UINT64_MAX - group) / 100000000;
+        integer = integer * 100000000 + group;
+    }
+
+    if (invalid)
+        return "Invalid digit in a base 10 integer. Only the digits 0 to 9 are allowed.";
+    if (overflow)
+        return "Integer literal too large, integers are at most 64 bits wide.";
+
+    * value = integer;
+    return NULL;
+}
+
+
+/**
+ * Decodes a floating point or decimal number to the nearest double.
+ *
+ * @param       digits the first digit.
+ * @param       length the number of characters, digits and the decimal point.
+ * @param       value set to the double nearest to the number.
+ *
+ * @return      NULL if the number was decoded, otherwise the reason it could not be.
+ */
+static char const * decodeReal(char const * digits, size_t length, double * const value) {
+    // Powers of ten that doubles hold exactly
+    static double const powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    uint64_t mantissa = 0;
+    size_t significant = 0;
+    size_t fraction = 0;
+    bool after_point = false;
+    bool invalid = false;
+    for (size_t i = 0; i < length; i++) {
+        if (digits[i] == '.') {
+            after_point = true;
+            continue;
+        }
+
+        invalid = invalid || (digits[i] & DECIMAL_INVALID_BITS) != 0;
+        fraction += after_point;
+        if (significant > 0 || digits[i] != '0') {
+            significant++;
+            if (significant <= 19)
+                mantissa = mantissa * 10 + (uint64_t) (digits[i] - '0');
+        }
+    }
+
+    if (invalid)
+        return "Invalid digit in a floating point number. Only the digits 0 to 9 are allowed.";
+
+    // When the mantissa and the power of ten are both exact, a single division yields the correctly rounded result.
+    // This only holds if divisions are carried out in double precision and not in a wider format.
+    if (FLT_EVAL_METHOD == 0 && significant <= 19 && mantissa <= (UINT64_C(1) << 53) && fraction < sizeof powers / sizeof powers[0]) {
+        * value = (double) mantissa / powers[fraction];
+        return NULL;
+    }
+
+    // Otherwise, we let the C library find the correctly rounded result on a null terminated copy of the number
+    char small[64];
+    char * copy = length < sizeof small ? small : malloc(length + 1);
+    if (copy == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: decodeReal.\nMessage: Ran out of memory while decoding a floating point number.\n", __FILE__, __LINE__);
+        exit(74);
+    }
+    memcpy(copy, digits, length);
+    copy[length] = '\0';
+
+    double real = strtod(copy, NULL);
+    if (copy != small)
+        free(copy);
+
+    if (isinf(real))
+        return "Floating point literal too large to be represented.";
+
+    * value = real;
+    return NULL;
+}
+
+
+/**
+ * Decodes a bit pattern written in base 2, 8 or 16 and appends the limbs of its bit vector to the pool.
+ *
+ * @param       digits the first digit.
+ * @param       length the number of digits, at least one.
+ * @param       bits the number of bits each digit stands for, 1, 3 or 4.
+ * @param       width set to the number of bits in the pattern.
+ * @param       limbs the pool to append the limbs of the pattern to, left untouched if the pattern is invalid.
+ *
+ * @return      NULL if the pattern was decoded, otherwise the reason it could not be.
+ */
+static char const * decodePattern(char const * digits, size_t length, unsigned bits, uint32_t * const width, struct Uint64Vector * const limbs) {
+    if (length > UINT32_MAX / bits)
+        return "Literal too wide, bit patterns are at most 4294967295 bits wide.";
+
+    uint64_t mask = bits == 1 ? BINARY_INVALID_BITS : bits == 3 ? OCTAL_INVALID_BITS : HEXADECIMAL_INVALID_BITS;
+    uint64_t total = (uint64_t) length * bits;
+    size_t count = bitVectorLimbs((size_t) total);
+
+    // The limbs are written past the end of the pool and only become part of it once the whole pattern is known to be valid
+    size_t first = uint64VectorSize(limbs);
+    uint64VectorReserve(limbs, first + count);
+    struct BitWriter writer = { .limbs = uint64VectorData(limbs) + first, .limb = 0, .filled = 0 };
+
+    // The last digit is the least significant so we go through the digits backwards, eight at a time
+    uint64_t invalid = 0;
+    size_t remaining = length;
+    for (; remaining >= 8; remaining -= 8) {
+        uint64_t chunk = loadDigits(digits + remaining - 8);
+        invalid |= chunk & BROADCAST(mask);
+        writeBits(& writer, eightPatternDigits(chunk, bits), 8 * bits);
+    }
+
+    for (; remaining > 0; remaining--) {
+        char digit = digits[remaining - 1];
+        invalid |= (uint64_t) digit & mask;
+        writeBits(& writer, (uint64_t) ((digit & 0x0F) + 9 * (digit >> 6)), bits);
+    }
+
+    if (writer.filled > 0)
+        * writer.limbs = writer.limb;
+
+    if (invalid != 0) {
+        if (bits == 1)
+            return "Invalid digit in a bitstring. Only the digits 0 and 1 are allowed.";
+        else
+            return "Invalid digit in an octal number. Only the digits 0 to 7 are allowed.";
+    }
+
+    limbs -> size += count;
+    * width = (uint32_t) total;
+    return NULL;
+}
+
+
+/**
+ * Appends bits to a pattern above the bits already written, the limb being filled is only stored once it is full.
+ *
+ * @param       writer pointer to the writer of the pattern.
+ * @param       value the bits to append.
+ * @param       count the number of bits to append, between 1 and 32.
+ */
+static void writeBits(struct BitWriter * const writer, uint64_t value, unsigned count) {
+    writer -> limb |= value << writer -> filled;
+    writer -> filled += count;
+    if (writer -> filled >= 64) {
+        * writer -> limbs++ = writer -> limb;
+        writer -> filled -= 64;
+        writer -> limb = writer -> filled > 0 ? value >> (count - writer -> filled) : 0;
+    }
+}
+
+
+/**
+ * Loads eight digits into an integer, the first digit in the least significant byte regardless of the byte order of the processor.
+ *
+ * @param       digits the first of the eight digits.
+ *
+ * @return      the eight digits.
+ */
+static uint64_t loadDigits(char const * digits) {
+    uint64_t chunk;
+    memcpy(& chunk, digits, sizeof chunk);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    chunk = __builtin_bswap64(chunk);
+#endif
+    return chunk;
+}
+
+
+/**
+ * Converts eight base 10 digits to the integer they stand for.
+ * Neighbouring digits are combined in pairs, then pairs of pairs and so on, each step being a couple of multiplications on the whole chunk.
+ *
+ * @param       chunk the eight digits as loaded by loadDigits().
+ *
+ * @return      the integer, less than 10^8.
+ */
+static uint64_t eightDecimalDigits(uint64_t chunk) {
+    chunk -= BROADCAST('0');
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & UINT64_C(0x000000FF000000FF)) * (100 + (UINT64_C(1000000) << 32)) + ((chunk >> 16) & UINT64_C(0x000000FF000000FF)) * (1 + (UINT64_C(10000) << 32))) >> 32;
+    return chunk;
+}
+
+
+/**
+ * Converts eight digits of a bit pattern to the bits they stand for.
+ * Each byte is turned into the value of its digit, then neighbouring values are combined in pairs, then pairs of pairs and so on.
+ *
+ * @param       chunk the eight digits as loaded by loadDigits().
+ * @param       bits the number of bits each digit stands for.
+ *
+ * @return      the 8 * bits bits, the first digit being the most significant.
+ */
+static uint64_t eightPatternDigits(uint64_t chunk, unsigned bits) {
+    // A single multiplication gathers the low bit of every byte into the top byte, the first digit landing on its most significant bit
+    if (bits == 1)
+        return ((chunk & BROADCAST(0x01)) * UINT64_C(0x8040201008040201)) >> 56;
+
+    // 0 to 9 are 0x30 to 0x39 and A to F are 0x41 to 0x46, the latter need 9 more than their low nibble
+    uint64_t values = (chunk & BROADCAST(0x0F)) + ((chunk >> 6) & BROADCAST(0x01)) * 9;
+    values = ((values & UINT64_C(0x00FF00FF00FF00FF)) << bits) | ((values >> 8) & UINT64_C(0x00FF00FF00FF00FF));
+    values = ((values & UINT64_C(0x0000FFFF0000FFFF)) << (2 * bits)) | ((values >> 16) & UINT64_C(0x0000FFFF0000FFFF));
+    values = ((values & UINT64_C(0x00000000FFFFFFFF)) << (4 * bits)) | (values >> 32);
+    return values;
+}
@@ -0,0 +1,47 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LEXER_LITERAL_H
+#define LEXER_LITERAL_H
+
+#include <stddef.h>
+
+#include "common/token_buffer.h"
+#include "common/token_type.h"
+#include "utils/vector.h"
+
+
+/* Decoding of the payload of numeric literals, the digits found between the optional <c> or <q> data type and the data format.
+ * Digits are converted eight at a time: eight characters are loaded into a 64 bits integer and checked and combined with a handful of arithmetic operations instead of one at a time.
+ */
+
+
+/**
+ * Decodes the payload of a numeric literal.
+ * Bit patterns of any width are decoded into the limbs of a bit vector appended to the given pool, the pool is left untouched if the payload is invalid.
+ *
+ * @param       type the type of the literal token, which tells the base and the kind of the value.
+ * @param       digits the first character of the payload.
+ * @param       length the number of characters in the payload.
+ * @param       literal set to the value of the literal.
+ * @param       limbs the pool the limbs of bit patterns are appended to.
+ *
+ * @return      NULL if the payload was decoded, otherwise the reason it is not a valid payload for the literal type.
+ */
+char const * decodeLiteral(enum TokenType type, char const * digits, size_t length, struct Literal * const literal, struct Uint64Vector * const limbs);
+
+#endif
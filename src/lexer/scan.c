@@ -0,0 +1,466 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+    #define AVALON_SCAN_X86
+    #include <immintrin.h>
+#endif
+
+#include "common/char_class.h"
+#include "lexer/scan.h"
+
+
+/* Blanks, identifiers and numbers are skipped one character at a time for this many characters before the kernels in effect take over.
+ * Most of these runs are a few characters long, too short to pay for loading and classifying a whole block, while comment bodies are scanned by the kernels right away.
+ */
+#define SCALAR_PREFIX 16
+
+struct ScanKernels {
+    char const * (* blanks)(char const * current);
+    char const * (* run)(char const * current, char c);
+    char const * (* line)(char const * current);
+    size_t (* newlines)(char const * current, char const * source, uint32_t * starts);
+    char const * (* identifier)(char const * current);
+    char const * (* digits)(char const * current);
+};
+
+static char const * scalarBlanks(char const * current);
+static char const * scalarRun(char const * current, char c);
+static char const * scalarLine(char const * current);
+static size_t scalarNewlines(char const * current, char const * source, uint32_t * starts);
+static char const * scalarIdentifier(char const * current);
+static char const * scalarDigits(char const * current);
+
+static struct ScanKernels const scalar_kernels = {
+    scalarBlanks, scalarRun, scalarLine, scalarNewlines, scalarIdentifier, scalarDigits
+};
+
+#if defined(AVALON_SCAN_X86)
+static char const * sse2Blanks(char const * current);
+static char const * sse2Run(char const * current, char c);
+static char const * sse2Line(char const * current);
+static size_t sse2Newlines(char const * current, char const * source, uint32_t * starts);
+static char const * sse2Identifier(char const * current);
+static char const * sse2Digits(char const * current);
+static char const * avx2Blanks(char const * current);
+static char const * avx2Run(char const * current, char c);
+static char const * avx2Line(char const * current);
+static size_t avx2Newlines(char const * current, char const * source, uint32_t * starts);
+static char const * avx2Identifier(char const * current);
+static char const * avx2Digits(char const * current);
+
+static struct ScanKernels const sse2_kernels = {
+    sse2Blanks, sse2Run, sse2Line, sse2Newlines, sse2Identifier, sse2Digits
+};
+
+static struct ScanKernels const avx2_kernels = {
+    avx2Blanks, avx2Run, avx2Line, avx2Newlines, avx2Identifier, avx2Digits
+};
+
+// SSE2 is part of the x86-64 baseline so it is what we use until told otherwise
+static struct ScanKernels kernels = {
+    sse2Blanks, sse2Run, sse2Line, sse2Newlines, sse2Identifier, sse2Digits
+};
+static enum ScanKernel kernel_in_effect = SCAN_SSE2;
+#else
+static struct ScanKernels kernels = {
+    scalarBlanks, scalarRun, scalarLine, scalarNewlines, scalarIdentifier, scalarDigits
+};
+static enum ScanKernel kernel_in_effect = SCAN_SCALAR;
+#endif
+
+
+/**
+ * Selects the kernels to use. Falls back to the best supported kernels if the requested ones are not supported by the processor.
+ * Must be called before lexing begins on any thread.
+ *
+ * @param       kernel the kernels to use.
+ *
+ * @return      the kernels that are now in effect.
+ */
+enum ScanKernel selectScanKernel(enum ScanKernel kernel) {
+#if defined(AVALON_SCAN_X86)
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+
+    if (kernel == SCAN_BEST || (kernel == SCAN_AVX2 && has_avx2 == false))
+        kernel = has_avx2 ? SCAN_AVX2 : SCAN_SSE2;
+
+    switch (kernel) {
+        case SCAN_SCALAR:
+            kernels = scalar_kernels;
+            break;
+
+        case SCAN_AVX2:
+            kernels = avx2_kernels;
+            break;
+
+        default:
+            kernel = SCAN_SSE2;
+            kernels = sse2_kernels;
+            break;
+    }
+#else
+    kernel = SCAN_SCALAR;
+    kernels = scalar_kernels;
+#endif
+
+    kernel_in_effect = kernel;
+    return kernel;
+}
+
+
+/**
+ * Returns the kernels currently in effect.
+ *
+ * @return      the kernels currently in effect.
+ */
+enum ScanKernel currentScanKernel(void) {
+    return kernel_in_effect;
+}
+
+
+/**
+ * Skips blank spaces, tabulations and carriage returns.
+ */
+char const * scanBlanks(char const * current) {
+    for (size_t i = 0; i < SCALAR_PREFIX; i++, current++) {
+        if (isCharClass(* current, CHAR_WHITESPACE) == false)
+            return current;
+    }
+
+    return kernels.blanks(current);
+}
+
+
+/**
+ * Skips a run of the given character.
+ */
+char const * scanRun(char const * current, char c) {
+    for (size_t i = 0; i < SCALAR_PREFIX; i++, current++) {
+        if (* current != c || c == '\0')
+            return current;
+    }
+
+    return kernels.run(current, c);
+}
+
+
+/**
+ * Skips everything up to the next new line (or the end of the source).
+ */
+char const * scanLine(char const * current) {
+    return kernels.line(current);
+}
+
+
+/**
+ * Counts the new lines from the given position up to the end of the source.
+ * When starts is not NULL, the offset from source of the character following each new line is also recorded there, in order.
+ */
+size_t scanNewlines(char const * current, char const * source, uint32_t * starts) {
+    return kernels.newlines(current, source, starts);
+}
+
+
+/**
+ * Skips letters, digits and underscores.
+ */
+char const * scanIdentifier(char const * current) {
+    for (size_t i = 0; i < SCALAR_PREFIX; i++, current++) {
+        if (isCharClass(* current, CHAR_IDENT) == false)
+            return current;
+    }
+
+    return kernels.identifier(current);
+}
+
+
+/**
+ * Skips decimal digits and uppercase hexadecimal digits.
+ */
+char const * scanDigits(char const * current) {
+    for (size_t i = 0; i < SCALAR_PREFIX; i++, current++) {
+        if (isCharClass(* current, CHAR_HEX_DIGIT) == false)
+            return current;
+    }
+
+    return kernels.digits(current);
+}
+
+
+/* Scalar kernels */
+
+static char const * scalarBlanks(char const * current) {
+    while (isCharClass(* current, CHAR_WHITESPACE))
+        current++;
+
+    return current;
+}
+
+static char const * scalarRun(char const * current, char c) {
+    while (* current == c && c != '\0')
+        current++;
+
+    return current;
+}
+
+static char const * scalarLine(char const * current) {
+    while (* current != '\n' && * current != '\0')
+        current++;
+
+    return current;
+}
+
+static size_t scalarNewlines(char const * current, char const * source, uint32_t * starts) {
+    size_t count = 0;
+    for (; * current != '\0'; current++) {
+        if (* current != '\n')
+            continue;
+
+        if (starts != NULL)
+            starts[count] = (uint32_t) (current + 1 - source);
+        count++;
+    }
+
+    return count;
+}
+
+static char const * scalarIdentifier(char const * current) {
+    while (isCharClass(* current, CHAR_IDENT))
+        current++;
+
+    return current;
+}
+
+static char const * scalarDigits(char const * current) {
+    while (isCharClass(* current, CHAR_HEX_DIGIT))
+        current++;
+
+    return current;
+}
+
+
+#if defined(AVALON_SCAN_X86)
+/* Vectorized kernels.
+ * Each classifier returns a mask with one bit set for every byte of the block that ends the run, the drivers below turn the first set bit into a pointer.
+ * The first block is loaded from the aligned address below the current position and the bits of the bytes that precede the current position are shifted out.
+ */
+
+#define SCAN_BLOCKS(type, width, load, current, classify, c)                                \
+    do {                                                                                    \
+        uintptr_t misalign = (uintptr_t) (current) & ((width) - 1);                         \
+        char const * block = (current) - misalign;                                          \
+        uint32_t mask = classify(load((type const *) block), c) >> misalign;                \
+        if (mask != 0)                                                                      \
+            return (current) + __builtin_ctz(mask);                                         \
+                                                                                            \
+        for (;;) {                                                                          \
+            block += (width);                                                               \
+            mask = classify(load((type const *) block), c);                                 \
+            if (mask != 0)                                                                  \
+                return block + __builtin_ctz(mask);                                         \
+        }                                                                                   \
+    } while (0)
+
+
+/* Goes through every block up to the one holding the null byte, newline and end classify a block into the mask of its new lines and the mask of its null bytes.
+ * The bits of the bytes that precede the current position in the first block and those of the bytes past the null byte in the last block are cleared.
+ */
+#define SCAN_NEWLINES(type, width, load, current, source, starts, newline, end)                 \
+    do {                                                                                    \
+        uintptr_t misalign = (uintptr_t) (current) & ((width) - 1);                         \
+        char const * block = (current) - misalign;                                          \
+        type chunk = load((type const *) block);                                            \
+        uint32_t lines = newline(chunk) >> misalign << misalign;                            \
+        uint32_t stop = end(chunk) >> misalign << misalign;                                 \
+        size_t count = 0;                                                                   \
+                                                                                            \
+        for (;;) {                                                                          \
+            if (stop != 0)                                                                  \
+                lines &= (stop & -stop) - 1;                                                \
+                                                                                            \
+            if ((starts) == NULL) {                                                         \
+                count += (size_t) __builtin_popcount(lines);                                \
+            }                                                                               \
+            else {                                                                          \
+                for (; lines != 0; lines &= lines - 1)                                      \
+                    (starts)[count++] = (uint32_t) (block + __builtin_ctz(lines) + 1 - (source)); \
+            }                                                                               \
+                                                                                            \
+            if (stop != 0)                                                                  \
+                return count;                                                               \
+                                                                                            \
+            block += (width);                                                               \
+            chunk = load((type const *) block);                                             \
+            lines = newline(chunk);                                                         \
+            stop = end(chunk);                                                              \
+        }                                                                                   \
+    } while (0)
+
+
+static inline uint32_t sse2StopBlanks(__m128i chunk, char c) {
+    (void) c;
+    __m128i blank = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))
+    );
+    return ~(uint32_t) _mm_movemask_epi8(blank) & 0xFFFF;
+}
+
+static inline uint32_t sse2StopRun(__m128i chunk, char c) {
+    return ~(uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c))) & 0xFFFF;
+}
+
+static inline uint32_t sse2StopLine(__m128i chunk, char c) {
+    (void) c;
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+    return (uint32_t) _mm_movemask_epi8(stop);
+}
+
+static inline uint32_t sse2Newline(__m128i chunk) {
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+}
+
+static inline uint32_t sse2End(__m128i chunk) {
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+}
+
+static inline uint32_t sse2StopIdentifier(__m128i chunk, char c) {
+    (void) c;
+    // Bytes above 0x7F are negative as signed bytes so they never fall within the ranges below
+    __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)));
+    __m128i underscore = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'));
+    return ~(uint32_t) _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore)) & 0xFFFF;
+}
+
+static inline uint32_t sse2StopDigits(__m128i chunk, char c) {
+    (void) c;
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)));
+    __m128i hex = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('F' + 1)));
+    return ~(uint32_t) _mm_movemask_epi8(_mm_or_si128(digit, hex)) & 0xFFFF;
+}
+
+static char const * sse2Blanks(char const * current) {
+    SCAN_BLOCKS(__m128i, 16, _mm_load_si128, current, sse2StopBlanks, '\0');
+}
+
+static char const * sse2Run(char const * current, char c) {
+    if (c == '\0')
+        return current;
+
+    SCAN_BLOCKS(__m128i, 16, _mm_load_si128, current, sse2StopRun, c);
+}
+
+static char const * sse2Line(char const * current) {
+    SCAN_BLOCKS(__m128i, 16, _mm_load_si128, current, sse2StopLine, '\0');
+}
+
+static size_t sse2Newlines(char const * current, char const * source, uint32_t * starts) {
+    SCAN_NEWLINES(__m128i, 16, _mm_load_si128, current, source, starts, sse2Newline, sse2End);
+}
+
+static char const * sse2Identifier(char const * current) {
+    SCAN_BLOCKS(__m128i, 16, _mm_load_si128, current, sse2StopIdentifier, '\0');
+}
+
+static char const * sse2Digits(char const * current) {
+    SCAN_BLOCKS(__m128i, 16, _mm_load_si128, current, sse2StopDigits, '\0');
+}
+
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline uint32_t avx2StopBlanks(__m256i chunk, char c) {
+    (void) c;
+    __m256i blank = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))
+    );
+    return ~(uint32_t) _mm256_movemask_epi8(blank);
+}
+
+AVX2 static inline uint32_t avx2StopRun(__m256i chunk, char c) {
+    return ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c)));
+}
+
+AVX2 static inline uint32_t avx2StopLine(__m256i chunk, char c) {
+    (void) c;
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_setzero_si256()));
+    return (uint32_t) _mm256_movemask_epi8(stop);
+}
+
+AVX2 static inline uint32_t avx2Newline(__m256i chunk) {
+    return (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+}
+
+AVX2 static inline uint32_t avx2End(__m256i chunk) {
+    return (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_setzero_si256()));
+}
+
+AVX2 static inline uint32_t avx2StopIdentifier(__m256i chunk, char c) {
+    (void) c;
+    __m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk));
+    __m256i underscore = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_'));
+    return ~(uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+}
+
+AVX2 static inline uint32_t avx2StopDigits(__m256i chunk, char c) {
+    (void) c;
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk));
+    __m256i hex = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('F' + 1), chunk));
+    return ~(uint32_t) _mm256_movemask_epi8(_mm256_or_si256(digit, hex));
+}
+
+AVX2 static inline __m256i avx2Load(__m256i const * block) {
+    return _mm256_load_si256(block);
+}
+
+AVX2 static char const * avx2Blanks(char const * current) {
+    SCAN_BLOCKS(__m256i, 32, avx2Load, current, avx2StopBlanks, '\0');
+}
+
+AVX2 static char const * avx2Run(char const * current, char c) {
+    if (c == '\0')
+        return current;
+
+    SCAN_BLOCKS(__m256i, 32, avx2Load, current, avx2StopRun, c);
+}
+
+AVX2 static char const * avx2Line(char const * current) {
+    SCAN_BLOCKS(__m256i, 32, avx2Load, current, avx2StopLine, '\0');
+}
+
+AVX2 static size_t avx2Newlines(char const * current, char const * source, uint32_t * starts) {
+    SCAN_NEWLINES(__m256i, 32, avx2Load, current, source, starts, avx2Newline, avx2End);
+}
+
+AVX2 static char const * avx2Identifier(char const * current) {
+    SCAN_BLOCKS(__m256i, 32, avx2Load, current, avx2StopIdentifier, '\0');
+}
+
+AVX2 static char const * avx2Digits(char const * current) {
+    SCAN_BLOCKS(__m256i, 32, avx2Load, current, avx2StopDigits, '\0');
+}
+#endif
@@ -0,0 +1,99 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LEXER_SCAN_H
+#define LEXER_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Scanning kernels used by the lexer to skip over runs of characters of the same class in bulk.
+ * Every kernel takes a pointer into a null terminated source and returns a pointer to the first character that does not belong to the run.
+ * The null byte never belongs to a run so kernels never go past the end of the source.
+ * The new line kernel is the exception: it goes through the rest of the source at once to find where lines begin.
+ *
+ * The vectorized kernels only ever perform aligned loads: an aligned block that contains at least one byte of the source lies in a page that belongs to the source so it is always safe to read, even when the block extends past the null byte.
+ */
+
+
+/**
+ * The available kernel implementations.
+ */
+enum ScanKernel {
+    SCAN_SCALAR,            // one character at a time
+    SCAN_SSE2,              // 16 characters at a time
+    SCAN_AVX2,              // 32 characters at a time
+    SCAN_BEST               // the best kernels supported by the processor we are running on
+};
+
+
+/**
+ * Selects the kernels to use. Falls back to the best supported kernels if the requested ones are not supported by the processor.
+ * Must be called before lexing begins on any thread.
+ *
+ * @param       kernel the kernels to use.
+ *
+ * @return      the kernels that are now in effect.
+ */
+enum ScanKernel selectScanKernel(enum ScanKernel kernel);
+
+
+/**
+ * Returns the kernels currently in effect.
+ *
+ * @return      the kernels currently in effect.
+ */
+enum ScanKernel currentScanKernel(void);
+
+
+/**
+ * Skips blank spaces, tabulations and carriage returns.
+ */
+char const * scanBlanks(char const * current);
+
+
+/**
+ * Skips a run of the given character.
+ */
+char const * scanRun(char const * current, char c);
+
+
+/**
+ * Skips everything up to the next new line (or the end of the source).
+ */
+char const * scanLine(char const * current);
+
+
+/**
+ * Counts the new lines from the given position up to the end of the source.
+ * When starts is not NULL, the offset from source of the character following each new line is also recorded there, in order.
+ */
+size_t scanNewlines(char const * current, char const * source, uint32_t * starts);
+
+
+/**
+ * Skips letters, digits and underscores.
+ */
+char const * scanIdentifier(char const * current);
+
+
+/**
+ * Skips decimal digits and uppercase hexadecimal digits.
+ */
+char const * scanDigits(char const * current);
+
+#endif
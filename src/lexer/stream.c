@@ -0,0 +1,387 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <unistd.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include "common/line_table.h"
+#include "common/token_type.h"
+#include "common/token.h"
+#include "lexer/stream.h"
+#include "lexer/lexer.h"
+#include "utils/vector.h"
+#include "lexer/scan.h"
+
+
+static void refill(struct StreamLexer * const stream, size_t resume);
+static size_t findCut(struct StreamLexer const * const stream, size_t after);
+static void readChunk(struct StreamLexer * const stream);
+static void countLines(struct StreamLexer * const stream, size_t until);
+
+extern inline char const * streamLexeme(struct StreamLexer const * const stream, struct Token const * const token);
+
+
+/**
+ * Initializes a streaming lexer that reads its source from the given file descriptor.
+ *
+ * @param       descriptor the file descriptor to read the source from, left open when the streaming lexer is deleted.
+ * @param       name the name of the stream in diagnostics, which is copied.
+ * @param       message error message to display in case any operation on the streaming lexer fails.
+ *
+ * @return      the newly created streaming lexer.
+ */
+struct StreamLexer * newStreamLexer(int descriptor, char const * name, char const * message) {
+    struct StreamLexer * stream = malloc(sizeof *stream);
+    if (stream == NULL)
+        goto exit;
+
+    // One more byte than the capacity so the null byte always fits after the stream
+    stream -> name = strdup(name);
+    stream -> capacity = STREAM_CHUNKS * STREAM_CHUNK_SIZE;
+    stream -> window = malloc(stream -> capacity + 1);
+    if (stream -> name == NULL || stream -> window == NULL)
+        goto exit;
+
+    stream -> descriptor = descriptor;
+    stream -> finished = false;
+    stream -> message = message;
+
+    // Nothing comes before the stream so the lexer finds a null byte when it looks back from the first character, as it would at the beginning of any source
+    stream -> window[0] = '\0';
+    stream -> filled = 1;
+    stream -> end = 1;
+    stream -> cut = '\0';
+    stream -> base = UINT32_MAX;
+
+    stream -> window_line = 1;
+    stream -> window_line_start = 0;
+    stream -> counted = 1;
+    stream -> line = 1;
+    stream -> line_start = 0;
+
+    stream -> lexer = newWindowLexer(stream -> window + 1);
+    stream -> comment_position = (struct SourcePosition) { .line = 0, .column = 0 };
+    stream -> dedent = (struct Token) { .type = AVL_DEDENT, .offset = 0, .length = 0 };
+    refill(stream, 1);
+
+    return stream;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newStreamLexer.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the streaming lexer.
+ *
+ * @param       stream pointer to memory occupied by the streaming lexer.
+ */
+void deleteStreamLexer(struct StreamLexer ** const stream) {
+    if (stream == NULL)
+        return;
+
+    if (* stream == NULL)
+        return;
+
+    deleteLexer(& (* stream) -> lexer);
+    free((* stream) -> window);
+    free((* stream) -> name);
+    free(* stream);
+    * stream = NULL;
+}
+
+
+/**
+ * Returns the next token of the stream, reading more of the stream when the lexer needs it.
+ * The tokens are the ones lexTokens() would find if the whole stream was in memory.
+ * The message of an error token is found in the error member of the lexer of the stream.
+ * The value of a numeric literal token is found in the literal member of the lexer of the stream and the bit vector of a bit pattern is found in its limb pool.
+ *
+ * @param       stream pointer to the streaming lexer.
+ *
+ * @return      the next token, which offset is its offset in the stream.
+ */
+struct Token streamToken(struct StreamLexer * const stream) {
+    char const * message = "The parameter <stream> cannot be NULL.";
+    if (stream == NULL)
+        goto exit;
+
+    struct Lexer * const lexer = stream -> lexer;
+    if (lexer -> pending_dedents > 0) {
+        lexer -> pending_dedents--;
+        return stream -> dedent;
+    }
+
+    for (;;) {
+        // Until the lexer finds its next token, the only things it may change are whether it ignores whitespace and the comment it is in.
+        // So when the window ends before the token does, lexing again from here once more of the stream is read yields the same token.
+        char const * resume = lexer -> current;
+        bool ignore_whitespace = lexer -> ignore_whitespace;
+        size_t comment_depth = lexer -> comment_depth;
+        uint32_t comment_distance = lexer -> comment_distance;
+
+        // Only the limbs of the last bit pattern are kept so memory stays bounded
+        uint64VectorClear(lexer -> limbs);
+        struct Token token = lexToken(lexer);
+
+        // The lexer only returns EOF before the end of the stream when it reaches the end of the window
+        bool starved = token.type == AVL_EOF;
+        if (starved == false || stream -> finished) {
+            token.offset += stream -> base;
+            if (token.type == AVL_DEDENT)
+                stream -> dedent = token;
+
+            // A line that lands on no open level still closes the levels deeper than itself, the DEDENT tokens follow the error right where it ends
+            if (token.type == AVL_ERROR && lexer -> pending_dedents > 0)
+                stream -> dedent = (struct Token) { .type = AVL_DEDENT, .offset = token.offset + token.length, .length = 0 };
+            return token;
+        }
+
+        // A lexer that stopped inside a comment goes on from where it stopped so the comment is only read once
+        // The opening of the comment is located while it is still in the window, in case the comment is never closed
+        if (lexer -> comment_depth > 0) {
+            size_t stopped = (size_t) (lexer -> current - stream -> window);
+            if (lexer -> comment_distance < stopped) {
+                struct Token opening = { .type = AVL_ERROR, .offset = stream -> base + (uint32_t) (stopped - lexer -> comment_distance), .length = 2 };
+                stream -> comment_position = streamPosition(stream, & opening);
+            }
+
+            refill(stream, stopped);
+            continue;
+        }
+
+        // The lexer is back in the comment it began in, if any, whose remainder lies before the first closing in the window
+        lexer -> ignore_whitespace = ignore_whitespace;
+        lexer -> comment_depth = comment_depth;
+        lexer -> comment_distance = comment_distance;
+        refill(stream, (size_t) (resume - stream -> window));
+    }
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: streamToken.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the line and column at which a token begins.
+ * Only the last token returned by streamToken() is guaranteed to still be in the window.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       token the token to locate.
+ *
+ * @return      the position of the first character of the token in the stream.
+ */
+struct SourcePosition streamPosition(struct StreamLexer * const stream, struct Token const * const token) {
+    char const * message = "The parameter <stream> cannot be NULL.";
+    if (stream == NULL)
+        goto exit;
+
+    // Only the opening of a comment that was never closed can lie before the window
+    size_t offset = (uint32_t) (token -> offset - stream -> base);
+    if (offset > stream -> filled)
+        return stream -> comment_position;
+
+    // Tokens are usually located in order so we count lines from where the previous position was found
+    if (offset < stream -> counted) {
+        stream -> counted = 1;
+        stream -> line = stream -> window_line;
+        stream -> line_start = stream -> window_line_start;
+    }
+    countLines(stream, offset);
+
+    struct SourcePosition position = {
+        .line = stream -> line,
+        .column = token -> offset - stream -> line_start + 1
+    };
+    return position;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: streamPosition.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Moves what is left to lex to the front of the window and reads the stream until the window can end before the first character of a line that is not whitespace.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       resume the position in the window from which the lexer has to go on.
+ */
+static void refill(struct StreamLexer * const stream, size_t resume) {
+    stream -> window[stream -> end] = stream -> cut;
+
+    // The lexer looks one character back so the character before the resume point stays
+    size_t dropped = resume - 1;
+    if (stream -> counted > resume) {
+        stream -> counted = 1;
+        stream -> line = stream -> window_line;
+        stream -> line_start = stream -> window_line_start;
+    }
+    countLines(stream, resume);
+
+    memmove(stream -> window, stream -> window + dropped, stream -> filled - dropped);
+    stream -> filled -= dropped;
+    stream -> base += (uint32_t) dropped;
+    stream -> counted = 1;
+    stream -> window_line = stream -> line;
+    stream -> window_line_start = stream -> line_start;
+
+    // The new end must be past the old one, otherwise the lexer would starve at the same place again
+    size_t after = stream -> end - dropped;
+    size_t end = 0;
+    while (stream -> finished == false) {
+        size_t filled = stream -> filled;
+        readChunk(stream);
+        end = findCut(stream, filled - 1 > after ? filled - 1 : after);
+        if (end != 0)
+            break;
+    }
+
+    stream -> end = stream -> finished ? stream -> filled : end;
+    stream -> cut = stream -> window[stream -> end];
+    stream -> window[stream -> end] = '\0';
+    moveLexer(stream -> lexer, stream -> window, stream -> window + 1, stream -> finished);
+}
+
+
+/**
+ * Returns the last position in the window where the window can end: right before the first character of a line that is not whitespace.
+ * The indentation before that character must be made of spaces only or of tabulations only, otherwise the lexer would tell them apart by looking past the end of the window.
+ * The window can also end right after the opening of a comment that starts a line and, when the lexer stopped inside a comment, anywhere up to the first closing of a comment so long as it does not split an opening or a closing.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       after the position past which to look.
+ *
+ * @return      the position found, 0 if there is none.
+ */
+static size_t findCut(struct StreamLexer const * const stream, size_t after) {
+    char const * window = stream -> window;
+
+    // Until the first closing, the lexer does nothing but look for the end of the comment
+    size_t comment_cut = 0;
+    if (stream -> lexer -> comment_depth > 0) {
+        size_t closing = 1;
+        while (closing + 1 < stream -> filled && (window[closing] != ']' || window[closing + 1] != '-'))
+            closing++;
+
+        if (closing + 1 < stream -> filled)
+            comment_cut = closing;
+        else
+            comment_cut = window[stream -> filled - 1] == '-' || window[stream -> filled - 1] == ']' ? stream -> filled - 1 : stream -> filled;
+
+        if (comment_cut <= after)
+            comment_cut = 0;
+    }
+
+    for (size_t i = stream -> filled - 1; i > after && i > comment_cut; i--) {
+        if (window[i] == ' ' || window[i] == '\t' || window[i] == '\r' || window[i] == '\n' || window[i] == '\0')
+            continue;
+
+        // Every character we go back over belongs to the indentation of a single candidate so finding a cut takes time linear in the size of the window
+        size_t start = i;
+        while (start > 0 && window[start - 1] == window[i - 1] && (window[start - 1] == ' ' || window[start - 1] == '\t'))
+            start--;
+
+        if (start > 0 && window[start - 1] == '\n') {
+            // Right after a comment that opens a line, the lexer also does nothing but look for the end of the comment
+            if (window[i] == '-' && i + 1 < stream -> filled && window[i + 1] == '[')
+                return i + 2;
+
+            return i;
+        }
+    }
+
+    return comment_cut;
+}
+
+
+/**
+ * Reads the next chunk of the stream at the end of the window, growing the window when it is full.
+ *
+ * @param       stream pointer to the streaming lexer.
+ */
+static void readChunk(struct StreamLexer * const stream) {
+    // A full window holds a single line or comment that is not over yet
+    if (stream -> filled == stream -> capacity) {
+        char * window = realloc(stream -> window, 2 * stream -> capacity + 1);
+        if (window == NULL)
+            goto exit;
+
+        stream -> window = window;
+        stream -> capacity = 2 * stream -> capacity;
+    }
+
+    size_t size = stream -> capacity - stream -> filled < STREAM_CHUNK_SIZE ? stream -> capacity - stream -> filled : STREAM_CHUNK_SIZE;
+    for (;;) {
+        ssize_t count = read(stream -> descriptor, stream -> window + stream -> filled, size);
+        if (count >= 0) {
+            stream -> filled += (size_t) count;
+            stream -> finished = count == 0;
+            return;
+        }
+
+        if (errno != EINTR) {
+            fprintf(stderr, "Could not read the content of <%s>: %s.\n", stream -> name, strerror(errno));
+            exit(74);
+        }
+    }
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: readChunk.\nMessage: %s\n", __FILE__, __LINE__, stream -> message);
+    exit(74);
+}
+
+
+/**
+ * Counts the lines that begin before the given position in the window, from where lines were counted so far.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       until the position up to which to count.
+ */
+static void countLines(struct StreamLexer * const stream, size_t until) {
+    if (until <= stream -> counted)
+        return;
+
+    // The new line kernel counts up to the null byte so one stands at the end of the range while it runs
+    char * const window = stream -> window;
+    char saved = window[until];
+    window[until] = '\0';
+    size_t lines = scanNewlines(window + stream -> counted, window, NULL);
+    window[until] = saved;
+
+    // The last line counted begins after the last new line of the range
+    if (lines > 0) {
+        size_t start = until;
+        while (window[start - 1] != '\n')
+            start--;
+
+        stream -> line += (uint32_t) lines;
+        stream -> line_start = stream -> base + (uint32_t) start;
+    }
+    stream -> counted = until;
+}
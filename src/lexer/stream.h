@@ -0,0 +1,149 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LEXER_STREAM_H
+#define LEXER_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common/line_table.h"
+#include "common/token.h"
+#include "lexer/lexer.h"
+
+
+/* The stream is read in chunks of this size into a window that starts out STREAM_CHUNKS chunks large. */
+#define STREAM_CHUNK_SIZE (64 * 1024)
+#define STREAM_CHUNKS 4
+
+/* Lexes a source as it is read from a file descriptor, such as a pipe, without ever holding the whole source in memory.
+ *
+ * The lexer scans contiguous memory and looks one character back and a couple ahead so the stream is read into a window it runs over.
+ * The window always ends right before the first character of a line that is not whitespace, after the indentation of the line: no token spans such a boundary, nor does the lexer need to see past it to decide what the last token is.
+ * The line may still turn out to only hold a comment, which makes it blank, so the lexer leaves the indentation before the end of a window to be read again once more of the stream is read.
+ * The lexer keeps its indentation state as the window moves so the window can end in an indented block as well as anywhere else, however deeply nested the block.
+ * Once the lexer reaches the end of the window, what it did not lex yet is moved to the front of the window and the next chunks are read after it.
+ *
+ * Inside a multi line comment, the window can also end anywhere before the first closing of a comment since the lexer only looks for the end of the comment until then.
+ * The lexer stops inside the comment at the end of the window and goes on from there once more of the stream is read, so a comment is read once and never has to fit in the window.
+ *
+ * The window only grows when a single line outside of comments does not fit in it so memory is bounded by the longest of them and not by the size of the stream.
+ */
+struct StreamLexer {
+    /* The name of the stream in diagnostics. */
+    char * name;
+
+    int descriptor;
+    bool finished;
+
+    /* window[0] holds the character before the first one the lexer has left to lex, the stream follows it up to filled.
+     * The lexer sees the window up to end, the character there is replaced by a null byte and kept in cut until the window moves.
+     */
+    char * window;
+    size_t capacity;
+    size_t filled;
+    size_t end;
+    char cut;
+
+    /* The offset in the stream of window[0], token offsets are offsets in the stream taken modulo 2^32. */
+    uint32_t base;
+
+    /* Lines are counted as positions are looked up, from the beginning of the window or from where the last position was found.
+     * The line and the offset in the stream of the beginning of that line are known at window[1], where the lexer resumed, and at window[counted].
+     */
+    uint32_t window_line;
+    uint32_t window_line_start;
+    size_t counted;
+    uint32_t line;
+    uint32_t line_start;
+
+    struct Lexer * lexer;
+
+    /* The opening of a comment the window moved past while the lexer was still inside it, in case the comment is never closed. */
+    struct SourcePosition comment_position;
+
+    /* A line that closes several indentation levels at once yields its first DEDENT token once per level, as lexTokens() does.
+     * A line that lands on no open level yields its DEDENT tokens right after the error about it.
+     */
+    struct Token dedent;
+
+    char const * message;
+};
+
+
+/**
+ * Initializes a streaming lexer that reads its source from the given file descriptor.
+ *
+ * @param       descriptor the file descriptor to read the source from, left open when the streaming lexer is deleted.
+ * @param       name the name of the stream in diagnostics, which is copied.
+ * @param       message error message to display in case any operation on the streaming lexer fails.
+ *
+ * @return      the newly created streaming lexer.
+ */
+struct StreamLexer * newStreamLexer(int descriptor, char const * name, char const * message);
+
+
+/**
+ * Frees the memory occupied by the streaming lexer.
+ *
+ * @param       stream pointer to memory occupied by the streaming lexer.
+ */
+void deleteStreamLexer(struct StreamLexer ** const stream);
+
+
+/**
+ * Returns the next token of the stream, reading more of the stream when the lexer needs it.
+ * The tokens are the ones lexTokens() would find if the whole stream was in memory.
+ * The message of an error token is found in the error member of the lexer of the stream.
+ * The value of a numeric literal token is found in the literal member of the lexer of the stream and the bit vector of a bit pattern is found in its limb pool.
+ *
+ * @param       stream pointer to the streaming lexer.
+ *
+ * @return      the next token, which offset is its offset in the stream.
+ */
+struct Token streamToken(struct StreamLexer * const stream);
+
+
+/**
+ * Returns the line and column at which a token begins.
+ * Only the last token returned by streamToken() is guaranteed to still be in the window.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       token the token to locate.
+ *
+ * @return      the position of the first character of the token in the stream.
+ */
+struct SourcePosition streamPosition(struct StreamLexer * const stream, struct Token const * const token);
+
+
+/**
+ * Returns the lexeme of a token, which spans as many characters as the length of the token.
+ * Only the last token returned by streamToken() is guaranteed to still be in the window.
+ *
+ * @param       stream pointer to the streaming lexer.
+ * @param       token the token which lexeme to return.
+ *
+ * @return      a pointer to the first character of the token in the window.
+ */
+inline char const * streamLexeme(struct StreamLexer const * const stream, struct Token const * const token) {
+    // Only the opening of a comment that was never closed can lie before the window, and all openings are alike
+    uint32_t offset = token -> offset - stream -> base;
+    return offset <= stream -> filled ? stream -> window + offset : "-[";
+}
+
+#endif
@@ -16,74 +16,240 @@
  */
 
 
+#include <unistd.h>
+
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 
-#include "utils/file.h"
-#include "lexer/lexer.h"
+#include "driver/search_path.h"
+#include "common/token_buffer.h"
+#include "common/source_manager.h"
 #include "common/token_type.h"
+#include "common/interner.h"
+#include "common/ast/ast.h"
+#include "driver/driver.h"
+#include "lexer/stream.h"
+#include "lexer/scan.h"
+#include "utils/file.h"
 
 
-void compile(char const * source_path);
+/* Exit status of a compilation that found errors in the sources, EX_DATAERR from sysexits.h. */
+#define COMPILATION_FAILED 65
+
+bool compile(char const * source_path, size_t jobs);
+static bool dumpStream(void);
+static void dumpModule(struct Driver * const driver, struct Module const * const module);
+static void dumpChanges(struct Module const * const module);
 
 
 int main(int argc, char * argv[])
 {
-    // At the moment, we do not allow arguments
+    // At the moment, we do not allow arguments to be passed to the program being compiled
     // This is motivated by the fact that the generated code will be running on a QC that do not provide access to command line arguments
     // And since our goals is to immediately target such systems, we ommit this feature for now.
 
-    if (argc != 2) {
-        printf("Usage: avalon program\n");
+    // Pick the fastest scanning kernels the processor supports before any lexing happens
+    selectScanKernel(SCAN_BEST);
+
+    // The only option is -j <jobs> (or -j<jobs>), the number of threads modules are compiled on
+    size_t jobs = 1;
+    int argument = 1;
+    bool valid = true;
+    if (argument < argc && strncmp(argv[argument], "-j", 2) == 0) {
+        char const * count = argv[argument][2] != '\0' ? argv[argument] + 2 : argument + 1 < argc ? argv[++argument] : "";
+        char * end = NULL;
+        jobs = strtoul(count, & end, 10);
+        valid = * count != '\0' && * end == '\0' && jobs > 0;
+        argument++;
     }
-    else {
-        char * source_path = argv[1];
-        compile(source_path);
+
+    if (valid == false || argc - argument != 1) {
+        printf("Usage: avalon [-j jobs] program\n");
+        printf("The program is read from the standard input when it is -.\n");
+        return 0;
     }
 
-    return 0;
+    char * source_path = argv[argument];
+    return compile(source_path, jobs) ? 0 : COMPILATION_FAILED;
 }
 
-void compile(char const * source_path) {
+bool compile(char const * source_path, size_t jobs) {
+    bool standard_input = strcmp(source_path, STANDARD_INPUT_PATH) == 0;
+
+    // The tokens of a program read from the standard input are printed as it is read so it never has to fit in memory
+    char const * dump = getenv("AVALON_DUMP");
+    if (standard_input && dump != NULL && strcmp(dump, "tokens") == 0)
+        return dumpStream();
+
     /* We begin by making sure the given source path exists */
-    if (fileExists(source_path) == false) {
+    if (standard_input == false && fileExists(source_path) == false) {
         fprintf(stderr, "File <%s> was not found.\n", source_path);
-        return;
+        return false;
     }
 
     /* 1. Configure the compiler */
+    // The load mode can be forced through AVALON_LOAD_MODE ("auto", "read" or "map") so both loaders can be compared on the same input
+    struct Driver * driver = newDriver(loadModeFromString(getenv("AVALON_LOAD_MODE")), "Ran out of memory while compiling.");
+    setDriverJobs(driver, jobs);
+
+    // The number of errors after which we give up can be set through AVALON_MAX_ERRORS, 0 reports every error
+    char const * max_errors = getenv("AVALON_MAX_ERRORS");
+    if (max_errors != NULL)
+        setDriverErrorLimit(driver, strtoul(max_errors, NULL, 10));
+
     // Add the current directory to the search path
+    searchPathAdd(driver -> search_path, ".", 1);
 
     // Add the given source directory to the search path
+    char const * separator = strrchr(source_path, '/');
+    if (separator != NULL)
+        searchPathAdd(driver -> search_path, source_path, separator == source_path ? 1 : (size_t) (separator - source_path));
 
     // Add the AVALON_HOME directory to the search path
+    char const * home = getenv("AVALON_HOME");
+    if (home != NULL)
+        searchPathAdd(driver -> search_path, home, strlen(home));
 
     // Add the AVALON_PATH directories to the search path
+    searchPathAddList(driver -> search_path, getenv("AVALON_PATH"));
+
+    // The interfaces of imported modules are cached in the AVALON_CACHE directory so unchanged modules are not parsed again
+    char const * cache = getenv("AVALON_CACHE");
+    if (cache != NULL && cache[0] != '\0')
+        setDriverCache(driver, cache);
 
     /* 2. Invoke the compiler */
-    char * source = readFile(source_path);
-    printf("%s\n", source);
+    // Every module is parsed before any is compiled since we can only order modules once we know what each imports
+    // Syntax errors leave the imports of a module known so import cycles are still reported, unless some imported module is missing
+    bool loaded = loadModules(driver, source_path);
+    bool scheduled = driver -> incomplete == false && scheduleModules(driver);
+    bool succeeded = loaded && scheduled;
+
+    // What each module is made of can be printed through AVALON_DUMP ("tokens") to debug the front-end, even when it has errors
+    // Modules loaded from the cache were not lexed so they have no tokens to print
+    if (dump != NULL && strcmp(dump, "tokens") == 0) {
+        uint32_t const * order = compilationOrder(driver);
+        for (size_t i = 0; i < modulesCount(driver); i++) {
+            struct Module const * module = driverModule(driver, scheduled ? order[i] : i);
+            if (module -> source != NO_SOURCE && module -> interface == NULL)
+                dumpModule(driver, module);
+        }
+    }
+
+    // The declarations each module has to check again since the previous compilation can be printed through AVALON_DUMP ("changes")
+    if (succeeded && dump != NULL && strcmp(dump, "changes") == 0) {
+        uint32_t const * order = compilationOrder(driver);
+        for (size_t i = 0; i < modulesCount(driver); i++)
+            dumpChanges(driverModule(driver, order[i]));
+    }
+
+    reportDriverErrors(driver);
+    deleteDriver(& driver);
+    deleteGlobalInterner();
+    return succeeded;
+}
+
+
+/**
+ * Prints the tokens of the program read from the standard input, one per line, as the program is read.
+ * Lexer errors are reported as they are found.
+ *
+ * @return      true if the program has no lexer error, false otherwise.
+ */
+static bool dumpStream(void) {
+    struct StreamLexer * stream = newStreamLexer(STDIN_FILENO, "<stdin>", "Ran out of memory while reading the standard input.");
+    bool succeeded = true;
+    uint32_t line = 0;
 
-    struct Lexer * lexer = newLexer(source_path, source);
-    size_t line = 0;
     for (;;) {
-        struct Token token = lexToken(lexer);
-        if (token.line != line) {
-            printf("%4zu ", token.line);
-            line = (int) token.line;
+        struct Token token = streamToken(stream);
+        struct SourcePosition position = streamPosition(stream, & token);
+        if (position.line != line) {
+            printf("%4u ", (unsigned) position.line);
+            line = position.line;
         } else {
             printf("   | ");
         }
         if (token.type == AVL_NEWLINE || token.type == AVL_DEDENT || token.type == AVL_INDENT || token.type == AVL_NO_INDENT)
             printf("%-20s ''\n", tokenTypeToString(token.type));
         else
-            printf("%-20s '%.*s'\n", tokenTypeToString(token.type), (int) token.length, token.start);
+            printf("%-20s '%.*s'\n", tokenTypeToString(token.type), (int) token.length, streamLexeme(stream, & token));
+
+        if (token.type == AVL_ERROR) {
+            fprintf(stderr, "%s:%u:%u: %s\n", stream -> name, (unsigned) position.line, (unsigned) position.column, stream -> lexer -> error);
+            succeeded = false;
+        }
 
         if (token.type == AVL_EOF)
             break;
     }
 
-    free(source);
-    deleteLexer(& lexer);
+    deleteStreamLexer(& stream);
+    return succeeded;
+}
+
+
+/**
+ * Prints the source of the module followed by its tokens, one per line.
+ *
+ * @param       driver the driver which source manager holds the source of the module.
+ * @param       module the module to print.
+ */
+static void dumpModule(struct Driver * const driver, struct Module const * const module) {
+    printf("%s\n", getSource(driver -> sources, module -> source) -> file -> content);
+
+    struct TokenBuffer const * tokens = programTokens(module -> program);
+    uint32_t line = 0;
+    for (size_t i = 0; i < tokenBufferSize(tokens); i++) {
+        struct Token token = tokenBufferAt(tokens, i);
+        struct SourcePosition position = sourcePosition(driver -> sources, module -> source, token.offset);
+        if (position.line != line) {
+            printf("%4u ", (unsigned) position.line);
+            line = position.line;
+        } else {
+            printf("   | ");
+        }
+        if (token.type == AVL_NEWLINE || token.type == AVL_DEDENT || token.type == AVL_INDENT || token.type == AVL_NO_INDENT)
+            printf("%-20s ''\n", tokenTypeToString(token.type));
+        else
+            printf("%-20s '%.*s'\n", tokenTypeToString(token.type), (int) token.length, tokenBufferLexeme(tokens, i));
+    }
+}
+
+
+/**
+ * Prints the name of the module followed by the declarations it has to check again.
+ *
+ * @param       module the module to print.
+ */
+static void dumpChanges(struct Module const * const module) {
+    char const * name = fqnName(getFQN(module -> program));
+    if (module -> interface != NULL) {
+        printf("%s: loaded from the cache\n", name);
+        return;
+    }
+
+    struct TokenBuffer const * tokens = programTokens(module -> program);
+    struct Ast const * ast = programAst(module -> program);
+    uint32_t const * declarations = programDeclarations(module -> program);
+    uint32_t const * changed = uint32VectorData(module -> changed);
+    size_t changed_count = uint32VectorSize(module -> changed);
+    printf("%s: %zu of %zu declarations to check\n", name, changed_count, declarationsCount(module -> program));
+
+    for (size_t i = 0; i < changed_count; i++) {
+        uint32_t declaration = declarations[changed[i]];
+        if (astKind(ast, declaration) == NODE_IMPORT) {
+            char * imported = programImportName(module -> program, declaration);
+            printf("    import %s\n", imported);
+            free(imported);
+        }
+        else {
+            uint32_t name = astToken(ast, astChildren(ast, declaration)[0]);
+            struct Token token = tokenBufferAt(tokens, name);
+            printf("    %s %.*s\n", astKind(ast, declaration) == NODE_VALUE ? "val" : "var", (int) token.length, tokenBufferLexeme(tokens, name));
+        }
+    }
 }
@@ -17,24 +17,110 @@
 
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
+#include "common/source_manager.h"
 #include "common/ast/program.h"
+#include "common/token_buffer.h"
 #include "common/token_type.h"
+#include "common/ast/ast.h"
 #include "parser/parser.h"
 #include "common/token.h"
 #include "lexer/lexer.h"
+#include "utils/result.h"
+#include "utils/vector.h"
 
 
-static void completeParserInit(struct Parser * const parser);
-static struct Token invalidToken(struct Parser const * const parser);
+/* Binding power of operators, from the loosest to the tightest. */
+enum Precedence {
+    PRECEDENCE_NONE = 0,
+    PRECEDENCE_OR,              // or ||
+    PRECEDENCE_AND,             // and &&
+    PRECEDENCE_NOT,             // not ! (prefix)
+    PRECEDENCE_COMPARISON,      // == != === =!= < <= > >=
+    PRECEDENCE_BITWISE_OR,      // bor |
+    PRECEDENCE_BITWISE_XOR,     // xor ^
+    PRECEDENCE_BITWISE_AND,     // band &
+    PRECEDENCE_SHIFT,           // lsh << rsh >>
+    PRECEDENCE_TERM,            // + -
+    PRECEDENCE_FACTOR,          // * / %
+    PRECEDENCE_UNARY,           // - + bnot ~ (prefix)
+    PRECEDENCE_POWER,           // ** (right associative)
+    PRECEDENCE_POSTFIX          // . and calls and subscripts
+};
+
+/* What an entry of the operator stack stands for. */
+enum PendingKind {
+    PENDING_PREFIX,             // a prefix operator waiting for its operand
+    PENDING_INFIX,              // an infix operator waiting for its right operand
+    PENDING_GROUP,              // an opening parenthesis that groups a subexpression
+    PENDING_CALL,               // an opening parenthesis that starts the arguments of a call
+    PENDING_SUBSCRIPT           // an opening bracket that starts the arguments of a subscript
+};
+
+struct InfixOperator {
+    uint8_t precedence;
+    bool right_associative;
+};
+
+/* Infix operators by token type, every other token type has PRECEDENCE_NONE. */
+static struct InfixOperator const infix_operators[AVL_ERROR + 1] = {
+    [AVL_LOGICAL_OR]        = { PRECEDENCE_OR,          false },
+    [AVL_LOGICAL_AND]       = { PRECEDENCE_AND,         false },
+    [AVL_EQUAL_EQUAL]       = { PRECEDENCE_COMPARISON,  false },
+    [AVL_NOT_EQUAL]         = { PRECEDENCE_COMPARISON,  false },
+    [AVL_MATCH]             = { PRECEDENCE_COMPARISON,  false },
+    [AVL_NOT_MATCH]         = { PRECEDENCE_COMPARISON,  false },
+    [AVL_GREATER]           = { PRECEDENCE_COMPARISON,  false },
+    [AVL_GREATER_EQUAL]     = { PRECEDENCE_COMPARISON,  false },
+    [AVL_LESS]              = { PRECEDENCE_COMPARISON,  false },
+    [AVL_LESS_EQUAL]        = { PRECEDENCE_COMPARISON,  false },
+    [AVL_BITWISE_OR]        = { PRECEDENCE_BITWISE_OR,  false },
+    [AVL_VERTICAL_BAR]      = { PRECEDENCE_BITWISE_OR,  false },
+    [AVL_BITWISE_XOR]       = { PRECEDENCE_BITWISE_XOR, false },
+    [AVL_BITWISE_AND]       = { PRECEDENCE_BITWISE_AND, false },
+    [AVL_LEFT_SHIFT]        = { PRECEDENCE_SHIFT,       false },
+    [AVL_RIGHT_SHIFT]       = { PRECEDENCE_SHIFT,       false },
+    [AVL_PLUS]              = { PRECEDENCE_TERM,        false },
+    [AVL_MINUS]             = { PRECEDENCE_TERM,        false },
+    [AVL_MUL]               = { PRECEDENCE_FACTOR,      false },
+    [AVL_DIV]               = { PRECEDENCE_FACTOR,      false },
+    [AVL_MOD]               = { PRECEDENCE_FACTOR,      false },
+    [AVL_POW]               = { PRECEDENCE_POWER,       true  },
+    [AVL_DOT]               = { PRECEDENCE_POSTFIX,     false },
+};
+
+VECTOR_DEFINE(OperatorVector, operatorVector, struct PendingOperator, 16)
+
+static enum TokenType currentType(struct Parser const * const parser);
+static enum TokenType nextType(struct Parser const * const parser);
+static void advance(struct Parser * const parser);
+static void skipLayout(struct Parser * const parser);
+static uint32_t expect(struct Parser * const parser, enum TokenType type, char const * message);
+static uint32_t parseImport(struct Parser * const parser);
+static uint32_t parseBinding(struct Parser * const parser);
+static void skipDeclaration(struct Parser * const parser);
+static void synchronize(struct Parser * const parser);
+static void endDeclaration(struct Parser * const parser);
+static void pushOperator(struct Parser * const parser, uint32_t token, enum PendingKind kind, enum Precedence precedence);
+static void reduce(struct Parser * const parser, enum Precedence precedence, bool right_associative);
+static void closeBracket(struct Parser * const parser, uint32_t bracket);
+static void callBracket(struct Parser * const parser, struct PendingOperator const * const bracket);
+static enum Precedence prefixPrecedence(enum TokenType type);
+static bool isLiteral(enum TokenType type);
+static void collectLexerErrors(struct Parser * const parser, size_t token);
+static void syntaxError(struct Parser * const parser, size_t token, char const * message);
+static void recordError(struct Parser * const parser, struct Error error);
+static bool errorLimitReached(struct Parser const * const parser);
 
 
 /**
  * Initializes the parser and returns it, ready to parse.
+ * The lexer is run over the entire source right away and the tokens it returns handed to the program, which owns them from then on.
  *
  * @param       program the program that is to hold all the declarations found.
  * @param       lexer the lexer to give us tokens
@@ -59,9 +145,20 @@ struct Parser * newParser(struct Lexer * const lexer, struct Program * const pro
     parser -> lexer = lexer;
     parser -> program = program;
     parser -> namespace = "*";
+    parser -> operands = newUint32Vector(0, message);
+    parser -> operators = newOperatorVector(0, message);
+    parser -> errors = newErrorVector(0, message);
+    parser -> error_limit = DEFAULT_ERROR_LIMIT;
+    parser -> panic = false;
+    parser -> lexer_errors = 0;
+
+    // The syntax tree refers to tokens by index so the program keeps the tokens for as long as it lives
+    struct TokenBuffer * old_tokens = setProgramTokens(program, lexTokens(lexer));
+    deleteTokenBuffer(& old_tokens);
+    parser -> tokens = programTokens(program);
+    parser -> current = 0;
 
-    // We need to set tokens before the parsing begins so we call the function below to do the same
-    completeParserInit(parser);
+    return parser;
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newParser.\nMessage: %s\n", __FILE__, __LINE__, message);
@@ -81,6 +178,9 @@ void deleteParser(struct Parser ** const parser) {
     if (* parser == NULL)
         return;
 
+    deleteUint32Vector(& (* parser) -> operands);
+    deleteOperatorVector(& (* parser) -> operators);
+    deleteErrorVector(& (* parser) -> errors);
     free(* parser);
     * parser = NULL;
 }
@@ -88,45 +188,686 @@ void deleteParser(struct Parser ** const parser) {
 
 /**
  * The parser entry point. It receives tokens from the lexer and determines what to do with them.
+ * Imports as well as value and variable declarations are appended to the program, other declarations are skipped for now.
+ *
+ * Syntax errors do not stop the parser: the declaration in error is dropped and parsing resumes at the next declaration, so a single pass finds every error up to the error limit.
  *
  * @param       parser the parser with information needed for parsing.
  *
  * @return      the program with all the declarations set.
  */
 struct Program * parse(struct Parser * const parser) {
+    while (errorLimitReached(parser) == false) {
+        uint32_t declaration = NO_NODE;
+
+        switch (currentType(parser)) {
+            case AVL_EOF:
+                return parser -> program;
+
+            case AVL_ERROR:
+                syntaxError(parser, parser -> current, "Unexpected token.");
+                break;
+
+            // Empty lines between declarations
+            case AVL_NEWLINE:
+            case AVL_NO_INDENT:
+                advance(parser);
+                break;
+
+            case AVL_IMPORT:
+                declaration = parseImport(parser);
+                break;
+
+            case AVL_VAL:
+            case AVL_VAR:
+                declaration = parseBinding(parser);
+                break;
+
+            default:
+                skipDeclaration(parser);
+                break;
+        }
+
+        if (parser -> panic)
+            synchronize(parser);
+        else if (declaration != NO_NODE)
+            addDeclaration(parser -> program, declaration);
+    }
 
     return parser -> program;
 }
 
 
 /**
- * Sets up the previous, current and next tokens on the parser.
+ * Sets the number of errors after which the parser gives up.
+ *
+ * @param       parser the parser which error limit to set.
+ * @param       limit the maximum number of errors to collect, 0 to collect every error.
+ */
+void setErrorLimit(struct Parser * const parser, size_t limit) {
+    char const * message = "The parameter <parser> cannot be NULL.";
+    if (parser == NULL)
+        goto exit;
+
+    parser -> error_limit = limit;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: setErrorLimit.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of lexer and syntax errors found so far.
+ *
+ * @param       parser the parser which errors to count.
+ *
+ * @return      the number of errors.
+ */
+size_t parserErrorsCount(struct Parser const * const parser) {
+    char const * message = "The parameter <parser> cannot be NULL.";
+    if (parser == NULL)
+        goto exit;
+
+    return errorVectorSize(parser -> errors);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: parserErrorsCount.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Prints every error found so far on the standard error, in source order.
  *
- * @param       parser the parser on which to set said tokens.
+ * @param       parser the parser which errors to print.
+ *
+ * @return      the number of errors printed.
  */
-static void completeParserInit(struct Parser * const parser) {
-    parser -> previous = invalidToken(parser);
-    parser -> current = lexToken(parser -> lexer);
-    parser -> next = invalidToken(parser);
+size_t reportErrors(struct Parser * const parser) {
+    char const * message = "The parameter <parser> cannot be NULL.";
+    if (parser == NULL)
+        goto exit;
+
+    size_t count = errorVectorSize(parser -> errors);
+    struct SourceManager * sources = parser -> lexer -> sources;
+    printErrors(sources, errorVectorData(parser -> errors), count);
+    if (errorLimitReached(parser))
+        fprintf(stderr, "%s: too many errors, stopped after %zu.\n", getSource(sources, parser -> lexer -> file) -> path, count);
+
+    return count;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: reportErrors.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
 }
 
 
 /**
- * Creates an invalid token that is used when trying to access a non-existent token.
+ * Parses the expression that starts at the current token and leaves the parser on the first token after it.
+ * Inside parentheses and brackets, expressions can span several lines.
  *
- * @param       lexer pointer to the lexer.
+ * This is an operator precedence parser driven by explicit stacks: operands are pushed as they are read and operators wait on the operator stack until an operator that binds more loosely, or the end of the expression, reduces them.
+ * Each token is looked at once, with no lookahead beyond the current token, and the parser never backtracks so parsing takes time linear in the length of the expression whatever its nesting depth.
  *
- * @return      a token indicating invalid access.
+ * @param       parser the parser with information needed for parsing.
+ *
+ * @return      the index of the expression node in the program syntax tree, NO_NODE if the expression is invalid.
  */
-static struct Token invalidToken(struct Parser const * const parser) {
-    char const * message = "[Parser bug] Invalid access of non-existent token";
-    struct Token token;
-    token.type = AVL_ERROR;
-    token.file = parser -> lexer -> file;
-    token.start = message;
-    token.length = strlen(message);
-    token.line = 0;
-    token.column = 0;
+uint32_t parseExpression(struct Parser * const parser) {
+    struct Ast * ast = programAst(parser -> program);
+    uint32VectorClear(parser -> operands);
+    operatorVectorClear(parser -> operators);
+
+    // The number of brackets currently open and whether the next token must start an operand or follow one
+    size_t depth = 0;
+    bool expect_operand = true;
+
+    for (;;) {
+        if (depth > 0)
+            skipLayout(parser);
+
+        uint32_t token = (uint32_t) parser -> current;
+        enum TokenType type = currentType(parser);
+
+        if (expect_operand) {
+            enum Precedence precedence = prefixPrecedence(type);
+            if (precedence != PRECEDENCE_NONE) {
+                pushOperator(parser, token, PENDING_PREFIX, precedence);
+                advance(parser);
+                continue;
+            }
+
+            if (type == AVL_LEFT_PAREN) {
+                pushOperator(parser, token, PENDING_GROUP, PRECEDENCE_NONE);
+                depth++;
+                advance(parser);
+                continue;
+            }
+
+            if (type == AVL_IDENTIFIER || isLiteral(type)) {
+                enum NodeKind kind = type == AVL_IDENTIFIER ? NODE_IDENTIFIER : NODE_LITERAL;
+                uint32VectorPushback(parser -> operands, astAppend(ast, kind, token, NULL, 0));
+                expect_operand = false;
+                advance(parser);
+                continue;
+            }
+
+            syntaxError(parser, token, "Expected an expression.");
+            return NO_NODE;
+        }
+
+        // An operand was just completed so the token either extends it or ends the expression
+        struct InfixOperator infix = infix_operators[type];
+        if (infix.precedence != PRECEDENCE_NONE) {
+            reduce(parser, infix.precedence, infix.right_associative);
+            if (parser -> panic)
+                return NO_NODE;
+
+            pushOperator(parser, token, PENDING_INFIX, infix.precedence);
+            expect_operand = true;
+            advance(parser);
+
+            // The member name is read right after the dot instead of as a general operand so that x.(y) is not taken for a member access
+            if (type == AVL_DOT) {
+                if (depth > 0)
+                    skipLayout(parser);
+
+                if (currentType(parser) != AVL_IDENTIFIER) {
+                    syntaxError(parser, (uint32_t) parser -> current, "Expected a member name after the dot.");
+                    return NO_NODE;
+                }
+
+                uint32VectorPushback(parser -> operands, astAppend(ast, NODE_IDENTIFIER, (uint32_t) parser -> current, NULL, 0));
+                expect_operand = false;
+                advance(parser);
+            }
+            continue;
+        }
+
+        if (type == AVL_LEFT_PAREN || type == AVL_LEFT_BRACKET) {
+            // Calls and subscripts apply to the entire member access chain before them, such as a.b in a.b(c)
+            reduce(parser, PRECEDENCE_POSTFIX, false);
+            if (parser -> panic)
+                return NO_NODE;
 
+            pushOperator(parser, token, type == AVL_LEFT_PAREN ? PENDING_CALL : PENDING_SUBSCRIPT, PRECEDENCE_NONE);
+            depth++;
+            advance(parser);
+
+            // Calls without arguments are closed right away since there is no operand to expect
+            skipLayout(parser);
+            if (type == AVL_LEFT_PAREN && currentType(parser) == AVL_RIGHT_PAREN) {
+                closeBracket(parser, (uint32_t) parser -> current);
+                if (parser -> panic)
+                    return NO_NODE;
+
+                depth--;
+                advance(parser);
+                continue;
+            }
+
+            expect_operand = true;
+            continue;
+        }
+
+        if (type == AVL_COMMA && depth > 0) {
+            reduce(parser, PRECEDENCE_NONE, false);
+            if (parser -> panic)
+                return NO_NODE;
+
+            uint8_t kind = operatorVectorData(parser -> operators)[operatorVectorSize(parser -> operators) - 1].kind;
+            if (kind == PENDING_GROUP) {
+                syntaxError(parser, token, "Unexpected comma: only calls and subscripts take several arguments.");
+                return NO_NODE;
+            }
+
+            expect_operand = true;
+            advance(parser);
+            continue;
+        }
+
+        if ((type == AVL_RIGHT_PAREN || type == AVL_RIGHT_BRACKET) && depth > 0) {
+            closeBracket(parser, token);
+            if (parser -> panic)
+                return NO_NODE;
+
+            depth--;
+            advance(parser);
+            continue;
+        }
+
+        // Any other token ends the expression
+        if (depth > 0) {
+            syntaxError(parser, token, "Expected a closing parenthesis or bracket.");
+            return NO_NODE;
+        }
+
+        break;
+    }
+
+    reduce(parser, PRECEDENCE_NONE, false);
+    if (parser -> panic)
+        return NO_NODE;
+
+    return * uint32VectorAt(parser -> operands, 0);
+}
+
+
+/**
+ * Returns the type of the current token.
+ *
+ * @param       parser the parser which current token to look at.
+ *
+ * @return      the type of the current token.
+ */
+static enum TokenType currentType(struct Parser const * const parser) {
+    return tokenBufferType(parser -> tokens, parser -> current);
+}
+
+
+/**
+ * Returns the type of the token right after the current token.
+ *
+ * @param       parser the parser which next token to look at.
+ *
+ * @return      the type of the next token, EOF if the current token is the last one.
+ */
+static enum TokenType nextType(struct Parser const * const parser) {
+    if (parser -> current + 1 >= tokenBufferSize(parser -> tokens))
+        return AVL_EOF;
+
+    return tokenBufferType(parser -> tokens, parser -> current + 1);
+}
+
+
+/**
+ * Moves the token window one token forward. Once the end of the source is reached, the window stays on the EOF token.
+ *
+ * @param       parser the parser which tokens to move.
+ */
+static void advance(struct Parser * const parser) {
+    enum TokenType type = currentType(parser);
+
+    // Error tokens are reported as they are passed so errors are recorded in source order whichever way the parser went over them
+    if (type == AVL_ERROR)
+        collectLexerErrors(parser, parser -> current);
+
+    if (type != AVL_EOF)
+        parser -> current++;
+}
+
+
+/**
+ * Skips new lines and indentation tokens, which carry no meaning within brackets.
+ *
+ * @param       parser the parser which tokens to skip.
+ */
+static void skipLayout(struct Parser * const parser) {
+    for (;;) {
+        enum TokenType type = currentType(parser);
+        if (type != AVL_NEWLINE && type != AVL_INDENT && type != AVL_DEDENT && type != AVL_NO_INDENT)
+            return;
+
+        advance(parser);
+    }
+}
+
+
+/**
+ * Consumes the current token if it has the given type and reports a syntax error otherwise.
+ *
+ * @param       parser the parser which current token to consume.
+ * @param       type the expected token type.
+ * @param       message the description of the error if the current token has another type.
+ *
+ * @return      the index of the consumed token, left unused if the parser is in panic mode.
+ */
+static uint32_t expect(struct Parser * const parser, enum TokenType type, char const * message) {
+    uint32_t token = (uint32_t) parser -> current;
+    if (currentType(parser) != type) {
+        syntaxError(parser, token, message);
+        return token;
+    }
+
+    advance(parser);
     return token;
 }
+
+
+/**
+ * Parses an import declaration, such as import std.io.
+ *
+ * @param       parser the parser positioned on the import keyword.
+ *
+ * @return      the index of the import node, which children are the identifiers of the imported FQN, NO_NODE if the import is invalid.
+ */
+static uint32_t parseImport(struct Parser * const parser) {
+    struct Ast * ast = programAst(parser -> program);
+    uint32_t keyword = expect(parser, AVL_IMPORT, "Expected the import keyword.");
+
+    // The names are gathered on the operand stack, which is free between expressions
+    uint32VectorClear(parser -> operands);
+    for (;;) {
+        uint32_t name = expect(parser, AVL_IDENTIFIER, "Expected the name of a module.");
+        if (parser -> panic)
+            return NO_NODE;
+
+        uint32VectorPushback(parser -> operands, astAppend(ast, NODE_IDENTIFIER, name, NULL, 0));
+
+        if (currentType(parser) != AVL_DOT)
+            break;
+        advance(parser);
+    }
+
+    uint32_t import = astAppend(ast, NODE_IMPORT, keyword, uint32VectorData(parser -> operands), uint32VectorSize(parser -> operands));
+    endDeclaration(parser);
+    return parser -> panic ? NO_NODE : import;
+}
+
+
+/**
+ * Parses a value or a variable declaration, such as val x = 1 + 2.
+ *
+ * @param       parser the parser positioned on the val or var keyword.
+ *
+ * @return      the index of the declaration node, which children are the name and the initializer, NO_NODE if the declaration is invalid.
+ */
+static uint32_t parseBinding(struct Parser * const parser) {
+    struct Ast * ast = programAst(parser -> program);
+    enum NodeKind kind = currentType(parser) == AVL_VAL ? NODE_VALUE : NODE_VARIABLE;
+    uint32_t keyword = (uint32_t) parser -> current;
+    advance(parser);
+
+    uint32_t name = expect(parser, AVL_IDENTIFIER, "Expected the name of the declaration.");
+    if (parser -> panic)
+        return NO_NODE;
+
+    expect(parser, AVL_EQUAL, "Expected an equal sign after the name of the declaration.");
+    if (parser -> panic)
+        return NO_NODE;
+
+    uint32_t children[2];
+    children[0] = astAppend(ast, NODE_IDENTIFIER, name, NULL, 0);
+    children[1] = parseExpression(parser);
+    if (parser -> panic)
+        return NO_NODE;
+
+    uint32_t binding = astAppend(ast, kind, keyword, children, 2);
+    endDeclaration(parser);
+    return parser -> panic ? NO_NODE : binding;
+}
+
+
+/**
+ * Skips a declaration the parser does not handle yet, together with the indented block that follows it if any.
+ *
+ * @param       parser the parser positioned on the first token of the declaration.
+ */
+static void skipDeclaration(struct Parser * const parser) {
+    size_t level = 0;
+
+    for (;;) {
+        switch (currentType(parser)) {
+            case AVL_EOF:
+                return;
+
+            case AVL_INDENT:
+                level++;
+                break;
+
+            // The dedent that brings us back to the top level ends the block, hence the declaration
+            case AVL_DEDENT:
+                if (level > 0)
+                    level--;
+                if (level == 0) {
+                    advance(parser);
+                    return;
+                }
+                break;
+
+            // A new line at the top level ends the declaration unless a block follows
+            case AVL_NEWLINE:
+                if (level == 0 && nextType(parser) != AVL_INDENT) {
+                    advance(parser);
+                    return;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        advance(parser);
+    }
+}
+
+
+/**
+ * Leaves panic mode by skipping what remains of the declaration in error, so parsing resumes with the next declaration.
+ * Declarations end at a new line or, for those with a body, at the dedentation that closes it.
+ *
+ * @param       parser the parser in panic mode.
+ */
+static void synchronize(struct Parser * const parser) {
+    skipDeclaration(parser);
+    parser -> panic = false;
+}
+
+
+/**
+ * Makes sure a declaration ends with the line it is on and moves past the end of the line.
+ *
+ * @param       parser the parser positioned right after the declaration.
+ */
+static void endDeclaration(struct Parser * const parser) {
+    if (currentType(parser) == AVL_EOF)
+        return;
+
+    expect(parser, AVL_NEWLINE, "Expected the end of the line after the declaration.");
+}
+
+
+/**
+ * Pushes an operator or an opening bracket on the operator stack.
+ *
+ * @param       parser the parser which operator stack to push on.
+ * @param       token the index of the operator or the bracket.
+ * @param       kind what the token stands for.
+ * @param       precedence the binding power of the operator, PRECEDENCE_NONE for brackets.
+ */
+static void pushOperator(struct Parser * const parser, uint32_t token, enum PendingKind kind, enum Precedence precedence) {
+    struct PendingOperator pending;
+    pending.token = token;
+    pending.kind = (uint8_t) kind;
+    pending.precedence = (uint8_t) precedence;
+    pending.operands_base = uint32VectorSize(parser -> operands);
+
+    operatorVectorPushback(parser -> operators, pending);
+}
+
+
+/**
+ * Applies the operators on top of the operator stack that bind at least as tightly as an incoming operator of the given precedence.
+ * A right associative incoming operator leaves the operators of its own precedence in place so they apply after it.
+ * Reduction stops at the innermost open bracket.
+ *
+ * @param       parser the parser which stacks to reduce.
+ * @param       precedence the precedence of the incoming operator, PRECEDENCE_NONE to apply every operator up to the innermost bracket.
+ * @param       right_associative whether the incoming operator is right associative.
+ */
+static void reduce(struct Parser * const parser, enum Precedence precedence, bool right_associative) {
+    struct Ast * ast = programAst(parser -> program);
+    struct Uint32Vector * operands = parser -> operands;
+    struct OperatorVector * operators = parser -> operators;
+
+    while (operatorVectorSize(operators) > 0) {
+        struct PendingOperator const * top = operatorVectorData(operators) + operatorVectorSize(operators) - 1;
+        if (top -> kind != PENDING_PREFIX && top -> kind != PENDING_INFIX)
+            return;
+
+        if (top -> precedence < precedence || (top -> precedence == precedence && right_associative))
+            return;
+
+        struct PendingOperator pending = operatorVectorPopback(operators);
+        uint32_t children[2];
+        children[1] = uint32VectorPopback(operands);
+
+        if (pending.kind == PENDING_PREFIX) {
+            uint32VectorPushback(operands, astAppend(ast, NODE_UNARY, pending.token, children + 1, 1));
+            continue;
+        }
+
+        children[0] = uint32VectorPopback(operands);
+        uint32VectorPushback(operands, astAppend(ast, NODE_BINARY, pending.token, children, 2));
+    }
+}
+
+
+/**
+ * Closes the innermost open bracket with the given closing bracket.
+ * A group leaves its subexpression on the operand stack while calls and subscripts replace the callee and the arguments by a single expression.
+ *
+ * @param       parser the parser which stacks to reduce.
+ * @param       bracket the index of the closing parenthesis or bracket.
+ */
+static void closeBracket(struct Parser * const parser, uint32_t bracket) {
+    reduce(parser, PRECEDENCE_NONE, false);
+    if (parser -> panic)
+        return;
+
+    bool is_bracket = tokenBufferType(parser -> tokens, bracket) == AVL_RIGHT_BRACKET;
+    struct PendingOperator opening = operatorVectorPopback(parser -> operators);
+    bool matches = is_bracket ? opening.kind == PENDING_SUBSCRIPT : opening.kind != PENDING_SUBSCRIPT;
+    if (matches == false) {
+        syntaxError(parser, bracket, is_bracket ? "Expected a closing parenthesis but found a bracket." : "Expected a closing bracket but found a parenthesis.");
+        return;
+    }
+
+    if (opening.kind != PENDING_GROUP)
+        callBracket(parser, & opening);
+}
+
+
+/**
+ * Replaces the callee and the arguments of a call or a subscript by the call or the subscript node.
+ * The callee and the arguments are contiguous on the operand stack so they become the children of the node as they are.
+ *
+ * @param       parser the parser which operand stack to reduce.
+ * @param       bracket the opening bracket of the call or the subscript, taken off the operator stack.
+ */
+static void callBracket(struct Parser * const parser, struct PendingOperator const * const bracket) {
+    struct Uint32Vector * operands = parser -> operands;
+    size_t callee = bracket -> operands_base - 1;
+
+    enum NodeKind kind = bracket -> kind == PENDING_CALL ? NODE_CALL : NODE_SUBSCRIPT;
+    uint32_t call = astAppend(programAst(parser -> program), kind, bracket -> token, uint32VectorData(operands) + callee, uint32VectorSize(operands) - callee);
+
+    operands -> size = callee;
+    uint32VectorPushback(operands, call);
+}
+
+
+/**
+ * Returns the precedence of the given token as a prefix operator.
+ *
+ * @param       type the type of the token.
+ *
+ * @return      the precedence of the prefix operator, PRECEDENCE_NONE if the token is not a prefix operator.
+ */
+static enum Precedence prefixPrecedence(enum TokenType type) {
+    switch (type) {
+        case AVL_LOGICAL_NOT:
+            return PRECEDENCE_NOT;
+
+        case AVL_MINUS:
+        case AVL_PLUS:
+        case AVL_BITWISE_NOT:
+            return PRECEDENCE_UNARY;
+
+        default:
+            return PRECEDENCE_NONE;
+    }
+}
+
+
+/**
+ * Returns true if the token is a string or a number.
+ *
+ * @param       type the type of the token.
+ *
+ * @return      true if the token is a literal.
+ */
+static bool isLiteral(enum TokenType type) {
+    return type >= AVL_STRING && type <= AVL_QUANTUM_DEC;
+}
+
+
+/**
+ * Records the errors the lexer found up to the given token, which were not recorded yet, as lexer errors.
+ *
+ * @param       parser the parser which tokens to collect the errors of.
+ * @param       token the index of the last token which error to record.
+ */
+static void collectLexerErrors(struct Parser * const parser, size_t token) {
+    struct TokenErrorVector const * errors = parser -> tokens -> errors;
+
+    // Errors are kept in token order so the ones not recorded yet follow the ones that were
+    for (; parser -> lexer_errors < tokenErrorVectorSize(errors); parser -> lexer_errors++) {
+        struct TokenError const * error = tokenErrorVectorData(errors) + parser -> lexer_errors;
+        if (error -> token > token)
+            return;
+
+        recordError(parser, createError(LEXER_ERROR, tokenBufferLocation(parser -> tokens, error -> token), error -> message));
+    }
+}
+
+
+/**
+ * Reports a syntax error at the given token and puts the parser in panic mode until it reaches the next declaration.
+ * Only the first error of a declaration is recorded since the ones that follow it are usually caused by it.
+ * An error found at an error token is recorded as the lexer error the token stands for.
+ *
+ * @param       parser the parser that found the error.
+ * @param       token the index of the token at which the error was found.
+ * @param       message the description of the error.
+ */
+static void syntaxError(struct Parser * const parser, size_t token, char const * message) {
+    if (parser -> panic)
+        return;
+
+    parser -> panic = true;
+    if (tokenBufferType(parser -> tokens, token) == AVL_ERROR) {
+        collectLexerErrors(parser, token);
+        return;
+    }
+
+    recordError(parser, createError(PARSER_ERROR, tokenBufferLocation(parser -> tokens, token), message));
+}
+
+
+/**
+ * Records an error unless the error limit was already reached.
+ *
+ * @param       parser the parser that found the error.
+ * @param       error the error to record.
+ */
+static void recordError(struct Parser * const parser, struct Error error) {
+    if (errorLimitReached(parser))
+        return;
+
+    errorVectorPushback(parser -> errors, error);
+}
+
+
+/**
+ * Returns true if the parser collected as many errors as it is allowed to.
+ *
+ * @param       parser the parser which errors to count.
+ *
+ * @return      true if the error limit is reached, false otherwise or if there is no limit.
+ */
+static bool errorLimitReached(struct Parser const * const parser) {
+    return parser -> error_limit > 0 && errorVectorSize(parser -> errors) >= parser -> error_limit;
+}
@@ -18,25 +18,69 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
 #include "common/ast/program.h"
-#include "common/token.h"
+#include "common/token_buffer.h"
 #include "lexer/lexer.h"
+#include "utils/result.h"
+#include "utils/vector.h"
+
+
+/* Number of errors after which the parser gives up unless told otherwise. */
+#define DEFAULT_ERROR_LIMIT 100
+
+
+/* An operator, or an opening bracket, waiting on the operator stack of the expression parser for its operands to be parsed. */
+struct PendingOperator {
+    uint32_t token;
+    uint8_t kind;
+    uint8_t precedence;
 
+    /* For calls and subscripts, the number of operands that were on the operand stack when the bracket was opened: the arguments are the operands above it. */
+    size_t operands_base;
+};
+
+VECTOR_DECLARE(OperatorVector, operatorVector, struct PendingOperator, 16)
 
 struct Parser {
     struct Lexer * lexer;
     struct Program * program;
 
-    struct Token previous;
-    struct Token current;
-    struct Token next;
+    /* The tokens of the program, lexed in one go before parsing starts. */
+    struct TokenBuffer * tokens;
+
+    /* The index of the current token, the previous and the next tokens are on either side of it.
+     * Once the end of the source is reached, the parser stays on the EOF token.
+     */
+    size_t current;
 
     char * namespace;
+
+    /* Operand and operator stacks of the expression parser.
+     * Expressions are parsed with explicit stacks and not by recursion so nesting depth is only limited by memory.
+     * We keep the stacks on the parser so they only allocate until they reach the size the deepest expression needs.
+     */
+    struct Uint32Vector * operands;
+    struct OperatorVector * operators;
+
+    /* Lexer and syntax errors found so far, parsing stops once there are error_limit of them (0 means no limit). */
+    struct ErrorVector * errors;
+    size_t error_limit;
+
+    /* Set from the moment a syntax error is found until the parser skips to the next declaration. */
+    bool panic;
+
+    /* Number of the errors of the lexer recorded so far, they are recorded as the parser reaches their tokens. */
+    size_t lexer_errors;
 };
 
 
 /**
  * Initializes the parser and returns it, ready to parse.
+ * The lexer is run over the entire source right away and the tokens it returns handed to the program, which owns them from then on.
  *
  * @param       program the program that is to hold all the declarations found.
  * @param       lexer the lexer to give us tokens
@@ -56,6 +100,9 @@ void deleteParser(struct Parser ** const parser);
 
 /**
  * The parser entry point. It receives tokens from the lexer and determines what to do with them.
+ * Imports as well as value and variable declarations are appended to the program, other declarations are skipped for now.
+ *
+ * Syntax errors do not stop the parser: the declaration in error is dropped and parsing resumes at the next declaration, so a single pass finds every error up to the error limit.
  *
  * @param       parser the parser with information needed for parsing.
  *
@@ -63,4 +110,44 @@ void deleteParser(struct Parser ** const parser);
  */
 struct Program * parse(struct Parser * const parser);
 
+
+/**
+ * Sets the number of errors after which the parser gives up.
+ *
+ * @param       parser the parser which error limit to set.
+ * @param       limit the maximum number of errors to collect, 0 to collect every error.
+ */
+void setErrorLimit(struct Parser * const parser, size_t limit);
+
+
+/**
+ * Returns the number of lexer and syntax errors found so far.
+ *
+ * @param       parser the parser which errors to count.
+ *
+ * @return      the number of errors.
+ */
+size_t parserErrorsCount(struct Parser const * const parser);
+
+
+/**
+ * Prints every error found so far on the standard error, in source order.
+ *
+ * @param       parser the parser which errors to print.
+ *
+ * @return      the number of errors printed.
+ */
+size_t reportErrors(struct Parser * const parser);
+
+
+/**
+ * Parses the expression that starts at the current token and leaves the parser on the first token after it.
+ * Inside parentheses and brackets, expressions can span several lines.
+ *
+ * @param       parser the parser with information needed for parsing.
+ *
+ * @return      the index of the expression node in the program syntax tree, NO_NODE if the expression is invalid.
+ */
+uint32_t parseExpression(struct Parser * const parser);
+
 #endif
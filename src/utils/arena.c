@@ -0,0 +1,251 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "utils/arena.h"
+
+static struct ArenaBlock * arenaNextBlock(struct Arena * const arena, size_t size, size_t alignment);
+
+
+/**
+ * Initializes the arena.
+ *
+ * @param       block_size the number of bytes in each regular block.
+ * @param       message error message to display in case any operation on the arena fails.
+ *
+ * @return      the newly created arena.
+ */
+struct Arena * newArena(size_t block_size, char const * message) {
+    if (block_size == 0)
+        goto exit;
+
+    struct Arena * arena = malloc(sizeof *arena);
+    if (arena == NULL)
+        goto exit;
+
+    // The first block is only allocated on first use so creating an arena that ends up unused costs nothing
+    arena -> blocks = NULL;
+    arena -> current = NULL;
+    arena -> block_size = block_size;
+    arena -> allocated = 0;
+    arena -> message = message;
+
+    return arena;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newArena.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the arena and everything allocated from it.
+ *
+ * @param       arena pointer to memory occupied by the arena.
+ */
+void deleteArena(struct Arena ** const arena) {
+    if (arena == NULL)
+        return;
+
+    if (* arena == NULL)
+        return;
+
+    struct ArenaBlock * block = (* arena) -> blocks;
+    while (block != NULL) {
+        struct ArenaBlock * next = block -> next;
+        free(block);
+        block = next;
+    }
+
+    free(* arena);
+    * arena = NULL;
+}
+
+
+/**
+ * Allocates memory suitably aligned for any object.
+ *
+ * @param       arena pointer to the arena.
+ * @param       size the number of bytes to allocate.
+ *
+ * @return      pointer to the allocated memory, which lives until the arena is reset or deleted.
+ */
+void * arenaAlloc(struct Arena * const arena, size_t size) {
+    return arenaAllocAligned(arena, size, alignof(max_align_t));
+}
+
+
+/**
+ * Allocates memory with the given alignment.
+ *
+ * @param       arena pointer to the arena.
+ * @param       size the number of bytes to allocate.
+ * @param       alignment the alignment of the memory, a power of two.
+ *
+ * @return      pointer to the allocated memory, which lives until the arena is reset or deleted.
+ */
+void * arenaAllocAligned(struct Arena * const arena, size_t size, size_t alignment) {
+    char const * message = "The parameter <arena> cannot be NULL.";
+    if (arena == NULL)
+        goto exit;
+
+    message = "The alignment must be a power of two.";
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        goto exit;
+
+    // The fast path: bump the pointer within the current block
+    struct ArenaBlock * block = arena -> current;
+    if (block != NULL) {
+        uintptr_t start = (uintptr_t) (block -> data + block -> size);
+        size_t padding = (size_t) (-start & (alignment - 1));
+
+        if (padding + size <= block -> capacity - block -> size) {
+            block -> size += padding + size;
+            arena -> allocated += padding + size;
+            return (void *) (start + padding);
+        }
+    }
+
+    block = arenaNextBlock(arena, size, alignment);
+
+    uintptr_t start = (uintptr_t) block -> data;
+    size_t padding = (size_t) (-start & (alignment - 1));
+    block -> size = padding + size;
+    arena -> allocated += padding + size;
+    return (void *) (start + padding);
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: arenaAllocAligned.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Copies the given bytes into the arena, suitably aligned for any object.
+ *
+ * @param       arena pointer to the arena.
+ * @param       data the bytes to copy.
+ * @param       size the number of bytes to copy.
+ *
+ * @return      pointer to the copy.
+ */
+void * arenaCopy(struct Arena * const arena, void const * data, size_t size) {
+    void * copy = arenaAlloc(arena, size);
+    if (size > 0)
+        memcpy(copy, data, size);
+    return copy;
+}
+
+
+/**
+ * Releases everything allocated from the arena at once.
+ * The blocks are kept and reused by later allocations.
+ *
+ * @param       arena pointer to the arena.
+ */
+void arenaReset(struct Arena * const arena) {
+    char const * message = "The parameter <arena> cannot be NULL.";
+    if (arena == NULL)
+        goto exit;
+
+    for (struct ArenaBlock * block = arena -> blocks; block != NULL; block = block -> next)
+        block -> size = 0;
+
+    arena -> current = arena -> blocks;
+    arena -> allocated = 0;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: arenaReset.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Returns the number of bytes handed out since the arena was created or last reset.
+ *
+ * @param       arena pointer to the arena.
+ *
+ * @return      the number of bytes allocated, alignment padding included.
+ */
+size_t arenaAllocated(struct Arena const * const arena) {
+    char const * message = "The parameter <arena> cannot be NULL.";
+    if (arena == NULL)
+        goto exit;
+
+    return arena -> allocated;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: arenaAllocated.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Makes the current block one that can hold an allocation of the given size and alignment.
+ * After a reset, the blocks that follow the current one are reused before any new block is allocated.
+ *
+ * @param       arena pointer to the arena.
+ * @param       size the number of bytes of the allocation.
+ * @param       alignment the alignment of the allocation.
+ *
+ * @return      the new current block, empty.
+ */
+static struct ArenaBlock * arenaNextBlock(struct Arena * const arena, size_t size, size_t alignment) {
+    // Reuse the next block if it was kept by a reset and is large enough
+    struct ArenaBlock * next = arena -> current ? arena -> current -> next : arena -> blocks;
+    if (next != NULL && size + alignment - 1 <= next -> capacity) {
+        arena -> current = next;
+        return next;
+    }
+
+    char const * message = arena -> message;
+    if (size > SIZE_MAX - sizeof(struct ArenaBlock) - alignment)
+        goto exit;
+
+    size_t capacity = size + alignment - 1 > arena -> block_size ? size + alignment - 1 : arena -> block_size;
+    struct ArenaBlock * block = malloc(sizeof *block + capacity);
+    if (block == NULL)
+        goto exit;
+
+    block -> capacity = capacity;
+    block -> size = 0;
+
+    // The new block goes right after the current one so the blocks stay in allocation order
+    if (arena -> current == NULL) {
+        block -> next = arena -> blocks;
+        arena -> blocks = block;
+    }
+    else {
+        block -> next = arena -> current -> next;
+        arena -> current -> next = block;
+    }
+
+    arena -> current = block;
+    return block;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: arenaNextBlock.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
@@ -0,0 +1,123 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef UTILS_ARENA_H
+#define UTILS_ARENA_H
+
+#include <stddef.h>
+
+
+/* Block of memory allocations are carved from. */
+struct ArenaBlock {
+    struct ArenaBlock * next;
+    size_t capacity;
+    size_t size;
+    unsigned char data[];
+};
+
+/* Bump pointer region allocator.
+ * Allocations are carved one after the other from large blocks and are never freed individually:
+ * everything allocated from an arena goes away at once when the arena is reset or deleted, which costs one free() per block and not per object.
+ *
+ * blocks       : every block of the arena, oldest first, so a reset can reuse them in the same order.
+ * current      : the block allocations are currently carved from.
+ * block_size   : the capacity of regular blocks, larger allocations get a block of their own.
+ * allocated    : the number of bytes handed out since the arena was created or last reset.
+ */
+struct Arena {
+    struct ArenaBlock * blocks;
+    struct ArenaBlock * current;
+    size_t block_size;
+    size_t allocated;
+    char const * message;
+};
+
+
+/**
+ * Initializes the arena.
+ *
+ * @param       block_size the number of bytes in each regular block.
+ * @param       message error message to display in case any operation on the arena fails.
+ *
+ * @return      the newly created arena.
+ */
+struct Arena * newArena(size_t block_size, char const * message);
+
+
+/**
+ * Frees the memory occupied by the arena and everything allocated from it.
+ *
+ * @param       arena pointer to memory occupied by the arena.
+ */
+void deleteArena(struct Arena ** const arena);
+
+
+/**
+ * Allocates memory suitably aligned for any object.
+ *
+ * @param       arena pointer to the arena.
+ * @param       size the number of bytes to allocate.
+ *
+ * @return      pointer to the allocated memory, which lives until the arena is reset or deleted.
+ */
+void * arenaAlloc(struct Arena * const arena, size_t size);
+
+
+/**
+ * Allocates memory with the given alignment.
+ *
+ * @param       arena pointer to the arena.
+ * @param       size the number of bytes to allocate.
+ * @param       alignment the alignment of the memory, a power of two.
+ *
+ * @return      pointer to the allocated memory, which lives until the arena is reset or deleted.
+ */
+void * arenaAllocAligned(struct Arena * const arena, size_t size, size_t alignment);
+
+
+/**
+ * Copies the given bytes into the arena, suitably aligned for any object.
+ *
+ * @param       arena pointer to the arena.
+ * @param       data the bytes to copy.
+ * @param       size the number of bytes to copy.
+ *
+ * @return      pointer to the copy.
+ */
+void * arenaCopy(struct Arena * const arena, void const * data, size_t size);
+
+
+/**
+ * Releases everything allocated from the arena at once.
+ * The blocks are kept and reused by later allocations.
+ *
+ * @param       arena pointer to the arena.
+ */
+void arenaReset(struct Arena * const arena);
+
+
+/**
+ * Returns the number of bytes handed out since the arena was created or last reset.
+ *
+ * @param       arena pointer to the arena.
+ *
+ * @return      the number of bytes allocated, alignment padding included.
+ */
+size_t arenaAllocated(struct Arena const * const arena);
+
+#endif
@@ -15,14 +15,35 @@
  *  limitations under the License.
  */
 
+#if defined(__unix__) || defined(__APPLE__)
+    #define _DEFAULT_SOURCE
+    #define AVALON_HAS_MMAP
+#endif
+
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
 
+#if defined(AVALON_HAS_MMAP)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #if !defined(MAP_ANONYMOUS)
+        #define MAP_ANONYMOUS MAP_ANON
+    #endif
+#endif
+
 #include "utils/file.h"
 
+
+#if defined(AVALON_HAS_MMAP)
+static bool mapFile(struct SourceFile * const file, int descriptor, size_t size);
+#endif
+static void readStream(struct SourceFile * const file, FILE * stream);
+
 /**
  * Verify if a file exists given the path to the file. Returns true if it does, false otherwise.
  */
@@ -72,3 +93,191 @@ char * readFile(char const * path) {
     fclose(file);
     return buffer;
 }
+
+
+/**
+ * Loads the content of the file at the given path using the requested load mode.
+ * Regular files are mapped read-only when the mode allows it, pipes and special files are always read into a heap buffer.
+ *
+ * @param       path path to the file to load, STANDARD_INPUT_PATH to read the standard input until its end.
+ * @param       mode how to bring the file content into memory.
+ *
+ * @return      the loaded source file.
+ */
+struct SourceFile * loadFile(char const * path, enum LoadMode mode) {
+    struct SourceFile * file = malloc(sizeof *file);
+    if (file == NULL) {
+        fprintf(stderr, "Failed to allocate enough memory to load the file at <%s>.\n", path);
+        exit(74);
+    }
+
+    file -> path = path;
+    file -> content = NULL;
+    file -> length = 0;
+    file -> mapped_size = 0;
+
+    // The standard input is read as any pipe would be, even when it is redirected from a regular file
+    if (strcmp(path, STANDARD_INPUT_PATH) == 0) {
+        readStream(file, stdin);
+        return file;
+    }
+
+    FILE * stream = fopen(path, "rb");
+    if (stream == NULL) {
+        fprintf(stderr, "Failed to open file <%s>.\n", path);
+        exit(74);
+    }
+
+#if defined(AVALON_HAS_MMAP)
+    struct stat status;
+    if (fstat(fileno(stream), & status) == 0 && S_ISREG(status.st_mode)) {
+        if (mode != LOAD_READ && status.st_size > 0 && mapFile(file, fileno(stream), (size_t) status.st_size)) {
+            fclose(stream);
+            return file;
+        }
+
+        // Regular files can be sized up front so we use the plain buffered read
+        fclose(stream);
+        file -> content = readFile(path);
+        file -> length = (size_t) status.st_size;
+        return file;
+    }
+#else
+    (void) mode;
+#endif
+
+    // Pipes and special files cannot be sized up front so we read them chunk by chunk
+    readStream(file, stream);
+    fclose(stream);
+    return file;
+}
+
+
+/**
+ * Releases the memory (or the mapping) holding the content of the source file as well as the source file itself.
+ *
+ * @param       file pointer to the pointer to the source file to unload.
+ */
+void unloadFile(struct SourceFile ** const file) {
+    if (file == NULL)
+        return;
+
+    if (* file == NULL)
+        return;
+
+#if defined(AVALON_HAS_MMAP)
+    if ((* file) -> mapped_size > 0)
+        munmap((void *) (* file) -> content, (* file) -> mapped_size);
+    else
+        free((void *) (* file) -> content);
+#else
+    free((void *) (* file) -> content);
+#endif
+
+    free(* file);
+    * file = NULL;
+}
+
+
+/**
+ * Returns the load mode with the given name: "auto", "read" or "map".
+ * Unknown names yield LOAD_AUTO.
+ *
+ * @param       name the name of the load mode.
+ *
+ * @return      the load mode that matches the name.
+ */
+enum LoadMode loadModeFromString(char const * name) {
+    if (name == NULL)
+        return LOAD_AUTO;
+
+    if (strcmp(name, "read") == 0)
+        return LOAD_READ;
+
+    if (strcmp(name, "map") == 0)
+        return LOAD_MAP;
+
+    return LOAD_AUTO;
+}
+
+
+#if defined(AVALON_HAS_MMAP)
+/**
+ * Maps the file with the given descriptor read-only and guarantees that the mapped content is followed by a null byte.
+ * We reserve one page more than the file needs and map the file over the beginning of that reservation.
+ * The bytes between the end of the file and the end of its last page are zero-filled by the kernel, and when the file size is a multiple of the page size the extra anonymous page provides the null byte.
+ *
+ * @param       file the source file which content to set.
+ * @param       descriptor the descriptor of the opened file.
+ * @param       size the size of the file in bytes.
+ *
+ * @return      true if the file was mapped, false if the caller should fall back to reading the file.
+ */
+static bool mapFile(struct SourceFile * const file, int descriptor, size_t size) {
+    size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    size_t mapped_size = (size / page_size + 1) * page_size;
+
+    void * region = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+        return false;
+
+    void * content = mmap(region, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, descriptor, 0);
+    if (content == MAP_FAILED) {
+        munmap(region, mapped_size);
+        return false;
+    }
+
+#if defined(MADV_SEQUENTIAL)
+    // The lexer reads the source front to back exactly once
+    madvise(content, size, MADV_SEQUENTIAL);
+#endif
+
+    file -> content = content;
+    file -> length = size;
+    file -> mapped_size = mapped_size;
+    return true;
+}
+#endif
+
+
+/**
+ * Reads the entire content of a stream that cannot be sized up front, such as a pipe, into a heap buffer.
+ *
+ * @param       file the source file which content to set.
+ * @param       stream the stream to read from.
+ */
+static void readStream(struct SourceFile * const file, FILE * stream) {
+    size_t capacity = 4096;
+    size_t length = 0;
+
+    char * buffer = malloc(capacity);
+    if (buffer == NULL)
+        goto exit;
+
+    for (;;) {
+        length += fread(buffer + length, sizeof(char), capacity - length - 1, stream);
+        if (length < capacity - 1)
+            break;
+
+        char * new_buffer = realloc(buffer, 2 * capacity);
+        if (new_buffer == NULL)
+            goto exit;
+
+        buffer = new_buffer;
+        capacity = 2 * capacity;
+    }
+
+    if (ferror(stream)) {
+        fprintf(stderr, "Could not read the content of the file at <%s>.\n", file -> path);
+        exit(74);
+    }
+
+    buffer[length] = '\0';
+    file -> content = buffer;
+    file -> length = length;
+    return;
+
+exit:
+    fprintf(stderr, "Failed to allocate enough memory to hold the file at <%s>.\n", file -> path);
+    exit(74);
+}
@@ -19,6 +19,33 @@
 #define UTILS_FILE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+
+
+/* The path that stands for the standard input, so sources can be piped into the compiler. */
+#define STANDARD_INPUT_PATH "-"
+
+/**
+ * How the content of a source file is brought into memory.
+ */
+enum LoadMode {
+    LOAD_AUTO,              // map regular files and read everything else
+    LOAD_READ,              // always copy the file content into a heap buffer
+    LOAD_MAP                // map the file whenever the file supports it
+};
+
+/**
+ * A source file loaded in memory.
+ * The content is always terminated by a null byte since the lexer relies on it to detect the end of the source.
+ */
+struct SourceFile {
+    char const * path;
+    char const * content;
+    size_t length;
+
+    /* The size of the memory region holding the content when the file was mapped, zero when the content lives on the heap. */
+    size_t mapped_size;
+};
 
 
 /**
@@ -32,4 +59,35 @@ bool fileExists(char const * path);
  */
 char * readFile(char const * path);
 
+
+/**
+ * Loads the content of the file at the given path using the requested load mode.
+ * Regular files are mapped read-only when the mode allows it, pipes and special files are always read into a heap buffer.
+ *
+ * @param       path path to the file to load, STANDARD_INPUT_PATH to read the standard input until its end.
+ * @param       mode how to bring the file content into memory.
+ *
+ * @return      the loaded source file.
+ */
+struct SourceFile * loadFile(char const * path, enum LoadMode mode);
+
+
+/**
+ * Releases the memory (or the mapping) holding the content of the source file as well as the source file itself.
+ *
+ * @param       file pointer to the pointer to the source file to unload.
+ */
+void unloadFile(struct SourceFile ** const file);
+
+
+/**
+ * Returns the load mode with the given name: "auto", "read" or "map".
+ * Unknown names yield LOAD_AUTO.
+ *
+ * @param       name the name of the load mode.
+ *
+ * @return      the load mode that matches the name.
+ */
+enum LoadMode loadModeFromString(char const * name);
+
 #endif
@@ -15,11 +15,85 @@
  *  limitations under the License.
  */
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
 #include <utils/result.h>
 
-#include "common/token.h"
+#include "common/source_manager.h"
+#include "utils/vector.h"
+
+
+/* An error together with where it was resolved to, the order of source ids depends on the order modules were loaded in so errors are sorted by path. */
+struct ResolvedError {
+    char const * path;
+    struct SourcePosition position;
+    struct Error const * error;
+};
 
+VECTOR_DEFINE(ErrorVector, errorVector, struct Error, 4)
+
+static int compareErrors(void const * left, void const * right);
 
 extern inline struct Result createResult(enum ResultType type, void * data);
 
-extern inline struct Error createError(enum ErrorType type, struct Token token, char * message);
+extern inline struct Error createError(enum ErrorType type, uint32_t location, char const * message);
+
+
+/**
+ * Prints the given errors on the standard error, ordered by file path then by position.
+ *
+ * @param       sources the source manager the error locations belong to.
+ * @param       errors the errors to print.
+ * @param       count the number of errors.
+ */
+void printErrors(struct SourceManager * const sources, struct Error const * const errors, size_t count) {
+    if (count == 0)
+        return;
+
+    struct ResolvedError * resolved = malloc(count * sizeof *resolved);
+    if (resolved == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: printErrors.\nMessage: Ran out of memory while printing errors.\n", __FILE__, __LINE__);
+        exit(74);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        struct SourceLocation location = resolveLocation(sources, errors[i].location);
+        resolved[i].path = getSource(sources, location.file) -> path;
+        resolved[i].position = location.position;
+        resolved[i].error = & errors[i];
+    }
+
+    qsort(resolved, count, sizeof *resolved, compareErrors);
+
+    for (size_t i = 0; i < count; i++)
+        fprintf(stderr, "%s:%u:%u: %s\n", resolved[i].path, (unsigned) resolved[i].position.line, (unsigned) resolved[i].position.column, resolved[i].error -> message);
+
+    free(resolved);
+}
+
+
+/**
+ * Orders errors by file path, then by position in the file.
+ * Within a file, global offsets are in the same order as lines and columns so they are compared instead.
+ *
+ * @param       left the first error.
+ * @param       right the second error.
+ *
+ * @return      a negative number if left comes first, a positive number if right comes first, zero otherwise.
+ */
+static int compareErrors(void const * left, void const * right) {
+    struct ResolvedError const * a = left;
+    struct ResolvedError const * b = right;
+
+    int path = strcmp(a -> path, b -> path);
+    if (path != 0)
+        return path;
+
+    if (a -> error -> location != b -> error -> location)
+        return a -> error -> location < b -> error -> location ? -1 : 1;
+
+    return 0;
+}
@@ -18,7 +18,10 @@
 #ifndef UTILS_RESULT_H
 #define UTILS_RESULT_H
 
-#include "common/token.h"
+#include <stdint.h>
+
+#include "common/source_manager.h"
+#include "utils/vector.h"
 
 /**
  * Type of pointer in the returned result.
@@ -59,19 +62,32 @@ enum ErrorType {
 
 /**
  * Struct containing the error and its type.
+ * The error is located by a global offset which the source manager only resolves to a file, line and column when the error is printed.
  */
 struct Error {
     enum ErrorType type;
-    struct Token token;
+    uint32_t location;
     const char * message;
 };
 
-inline struct Error createError(enum ErrorType type, struct Token token, char * message) {
+inline struct Error createError(enum ErrorType type, uint32_t location, char const * message) {
     struct Error error;
     error.type = type;
-    error.token = token;
+    error.location = location;
     error.message = message;
     return error;
 }
 
+VECTOR_DECLARE(ErrorVector, errorVector, struct Error, 4)
+
+
+/**
+ * Prints the given errors on the standard error, ordered by file path then by position.
+ *
+ * @param       sources the source manager the error locations belong to.
+ * @param       errors the errors to print.
+ * @param       count the number of errors.
+ */
+void printErrors(struct SourceManager * const sources, struct Error const * const errors, size_t count);
+
 #endif
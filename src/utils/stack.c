@@ -24,6 +24,16 @@
 #include "utils/stack.h"
 
 
+extern inline size_t stackSizeUnchecked(struct Stack const * const stack);
+extern inline size_t sizeTStackSizeUnchecked(struct SizeTStack const * const stack);
+extern inline void * stackTopUnchecked(struct Stack const * const stack);
+extern inline size_t sizeTStackTopUnchecked(struct SizeTStack const * const stack);
+extern inline void stackPushUnchecked(struct Stack * const stack, void * element);
+extern inline void sizeTStackPushUnchecked(struct SizeTStack * const stack, const size_t element);
+extern inline void * stackPopUnchecked(struct Stack * const stack);
+extern inline size_t sizeTStackPopUnchecked(struct SizeTStack * const stack);
+
+
 /**
  * Initializes the stack
  *
@@ -136,6 +146,70 @@ exit:
 }
 
 
+/**
+ * Returns the number of elements on the stack.
+ *
+ * @param       stack pointer to the stack which content to check.
+ *
+ * @return      the number of elements on the stack.
+ */
+size_t stackSize(struct Stack const * const stack) {
+    char const * message = "The parameter <stack> cannot be NULL.";
+    if (stack == NULL)
+        goto exit;
+
+    return stack -> top;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: stackSize.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
+    exit(74);
+}
+
+size_t sizeTStackSize(struct SizeTStack const * const stack) {
+    char const * message = "The parameter <stack> cannot be NULL.";
+    if (stack == NULL)
+        goto exit;
+
+    return stack -> top;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sizeTStackSize.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
+    exit(74);
+}
+
+
+/**
+ * Removes all the elements from the stack.
+ *
+ * @param       stack pointer to the stack to clear.
+ */
+void clearStack(struct Stack * const stack) {
+    char const * message = "The parameter <stack> cannot be NULL.";
+    if (stack == NULL)
+        goto exit;
+
+    stack -> top = 0;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: clearStack.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+void clearSizeTStack(struct SizeTStack * const stack) {
+    char const * message = "The parameter <stack> cannot be NULL.";
+    if (stack == NULL)
+        goto exit;
+
+    stack -> top = 0;
+    return;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: clearSizeTStack.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
 /**
  * Returns the top of the stack.
  *
@@ -148,7 +222,11 @@ void * stackTop(struct Stack const * const stack) {
     if (stack == NULL)
         goto exit;
 
-    return stack -> elements[stack -> top];
+    // An empty stack has no top
+    if (stack -> top == 0)
+        goto exit;
+
+    return stack -> elements[stack -> top - 1];
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: stackTop.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
@@ -160,7 +238,11 @@ size_t sizeTStackTop(struct SizeTStack const * const stack) {
     if (stack == NULL)
         goto exit;
 
-    return stack -> elements[stack -> top];
+    // An empty stack has no top
+    if (stack -> top == 0)
+        goto exit;
+
+    return stack -> elements[stack -> top - 1];
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sizeTStackTop.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
@@ -179,8 +261,9 @@ void stackPush(struct Stack * const stack, void * element) {
     if (stack == NULL)
         goto exit;
 
+    // We grow the stack geometrically so pushes run in amortized constant time
     if (stack -> top == stack -> size) {
-        size_t new_size = 1.75 * sizeof(*stack -> elements);
+        size_t new_size = 2 * stack -> size;
         void ** new_elements = realloc(stack -> elements, new_size * sizeof *stack -> elements);
         if (new_elements == NULL)
             goto exit;
@@ -190,6 +273,7 @@ void stackPush(struct Stack * const stack, void * element) {
     }
 
     stack -> elements[stack -> top++] = element;
+    return;
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: stackPush.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
@@ -201,8 +285,9 @@ void sizeTStackPush(struct SizeTStack * const stack, const size_t element) {
     if (stack == NULL)
         goto exit;
 
+    // We grow the stack geometrically so pushes run in amortized constant time
     if (stack -> top == stack -> size) {
-        size_t new_size = 1.75 * sizeof(*stack -> elements);
+        size_t new_size = 2 * stack -> size;
         size_t * new_elements = realloc(stack -> elements, new_size * sizeof *stack -> elements);
         if (new_elements == NULL)
             goto exit;
@@ -212,6 +297,7 @@ void sizeTStackPush(struct SizeTStack * const stack, const size_t element) {
     }
 
     stack -> elements[stack -> top++] = element;
+    return;
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sizeTStackPush.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
@@ -232,10 +318,11 @@ void * stackPop(struct Stack * const stack) {
     if (stack == NULL)
         goto exit;
 
-    if (stack -> top == stack -> size)
+    // An empty stack has nothing to pop
+    if (stack -> top == 0)
         goto exit;
 
-    return stack -> elements[stack -> top--];
+    return stack -> elements[--stack -> top];
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: stackPop.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
@@ -247,10 +334,11 @@ size_t sizeTStackPop(struct SizeTStack * const stack) {
     if (stack == NULL)
         goto exit;
 
-    if (stack -> top == stack -> size)
+    // An empty stack has nothing to pop
+    if (stack -> top == 0)
         goto exit;
 
-    return stack -> elements[stack -> top--];
+    return stack -> elements[--stack -> top];
 
 exit:
     fprintf(stderr, "File: %s.\nLine: %d.\nOperation: sizeTStackPop.\nMessage: %s\n", __FILE__, __LINE__, stack ? stack -> message : message);
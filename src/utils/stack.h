@@ -19,6 +19,7 @@
 #define UTILS_STACK_H
 
 #include <stdbool.h>
+#include <assert.h>
 #include <stddef.h>
 
 
@@ -66,6 +67,26 @@ bool isStackEmpty(struct Stack const * const stack);
 bool isSizeTStackEmpty(struct SizeTStack const * const stack);
 
 
+/**
+ * Returns the number of elements on the stack.
+ *
+ * @param       stack pointer to the stack which content to check.
+ *
+ * @return      the number of elements on the stack.
+ */
+size_t stackSize(struct Stack const * const stack);
+size_t sizeTStackSize(struct SizeTStack const * const stack);
+
+
+/**
+ * Removes all the elements from the stack.
+ *
+ * @param       stack pointer to the stack to clear.
+ */
+void clearStack(struct Stack * const stack);
+void clearSizeTStack(struct SizeTStack * const stack);
+
+
 /**
  * Returns the top of the stack.
  *
@@ -97,4 +118,91 @@ void sizeTStackPush(struct SizeTStack * const stack, const size_t element);
 void * stackPop(struct Stack * const stack);
 size_t sizeTStackPop(struct SizeTStack * const stack);
 
+
+/* Unchecked operations.
+ * The functions above validate their arguments and report misuse before terminating, which costs a call and a few branches on every access.
+ * The inline functions below are meant for tight loops: their preconditions are only verified by assertions, compiled out in release builds (where NDEBUG is defined).
+ */
+
+/**
+ * Returns the number of elements on the stack, without validating the stack.
+ *
+ * @param       stack pointer to the stack which content to check.
+ *
+ * @return      the number of elements on the stack.
+ */
+inline size_t stackSizeUnchecked(struct Stack const * const stack) {
+    assert(stack != NULL);
+    return stack -> top;
+}
+
+inline size_t sizeTStackSizeUnchecked(struct SizeTStack const * const stack) {
+    assert(stack != NULL);
+    return stack -> top;
+}
+
+
+/**
+ * Returns the top of the stack, without validating the stack.
+ *
+ * @param       stack pointer to the stack which content to check, it must not be empty.
+ *
+ * @return      the element at the top of the stack.
+ */
+inline void * stackTopUnchecked(struct Stack const * const stack) {
+    assert(stack != NULL && stack -> top > 0);
+    return stack -> elements[stack -> top - 1];
+}
+
+inline size_t sizeTStackTopUnchecked(struct SizeTStack const * const stack) {
+    assert(stack != NULL && stack -> top > 0);
+    return stack -> elements[stack -> top - 1];
+}
+
+
+/**
+ * Push an element on top of the stack, without validating the stack.
+ * Only growing the stack goes through the checked push.
+ *
+ * @param       stack pointer to stack to push an element on.
+ * @param       element the element to push onto the stack.
+ */
+inline void stackPushUnchecked(struct Stack * const stack, void * element) {
+    assert(stack != NULL);
+    if (stack -> top == stack -> size) {
+        stackPush(stack, element);
+        return;
+    }
+
+    stack -> elements[stack -> top++] = element;
+}
+
+inline void sizeTStackPushUnchecked(struct SizeTStack * const stack, const size_t element) {
+    assert(stack != NULL);
+    if (stack -> top == stack -> size) {
+        sizeTStackPush(stack, element);
+        return;
+    }
+
+    stack -> elements[stack -> top++] = element;
+}
+
+
+/**
+ * Pop an element off the top of the stack, without validating the stack.
+ *
+ * @param       stack pointer to the stack to pop the element off, it must not be empty.
+ *
+ * @return      the element popped off the stack top.
+ */
+inline void * stackPopUnchecked(struct Stack * const stack) {
+    assert(stack != NULL && stack -> top > 0);
+    return stack -> elements[--stack -> top];
+}
+
+inline size_t sizeTStackPopUnchecked(struct SizeTStack * const stack) {
+    assert(stack != NULL && stack -> top > 0);
+    return stack -> elements[--stack -> top];
+}
+
 #endif
@@ -16,13 +16,25 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 
 #include "utils/vector.h"
 
 
+extern inline size_t vectorSizeUnchecked(struct Vector const * const vector);
+extern inline void * vectorAtUnchecked(struct Vector const * const vector, size_t position);
+extern inline void vectorPushbackUnchecked(struct Vector * const vector, void * element);
+extern inline void * vectorPopbackUnchecked(struct Vector * const vector);
+
+VECTOR_DEFINE(SizeTVector, sizeTVector, size_t, 8)
+VECTOR_DEFINE(Uint32Vector, uint32Vector, uint32_t, 8)
+VECTOR_DEFINE(Uint64Vector, uint64Vector, uint64_t, 4)
+
+
 /**
  * Initializes the vector.
  *
@@ -154,8 +166,9 @@ void vectorPushback(struct Vector * const vector, void * element) {
     if (vector == NULL)
         goto exit;
 
+    // Doubling the capacity keeps appends amortized O(1)
     if (vector -> capacity == vector -> size)
-        vectorResize(vector, 2);
+        vectorResize(vector, 2 * vector -> capacity);
 
     vector -> elements[vector -> size++] = element;
     return;
@@ -184,10 +197,17 @@ void vectorInsert(struct Vector * const vector, size_t position, void * element)
         goto exit;
 
     // If the position is not within the array bounds, we fail early
+    // Inserting at the size is allowed and amounts to pushing back
     if (position > vector -> size)
         goto exit;
 
+    if (vector -> capacity == vector -> size)
+        vectorResize(vector, 2 * vector -> capacity);
+
+    // Shift the elements after the position to make room for the new one
+    memmove(vector -> elements + position + 1, vector -> elements + position, (vector -> size - position) * sizeof *vector -> elements);
     vector -> elements[position] = element;
+    vector -> size++;
     return;
 
 exit:
@@ -215,7 +235,7 @@ void * vectorAt(struct Vector const * const vector, size_t position) {
         goto exit;
 
     // If the position is not within the array bounds, we fail early
-    if (position > vector -> size)
+    if (position >= vector -> size)
         goto exit;
 
     return vector -> elements[position];
@@ -246,17 +266,14 @@ void * vectorErase(struct Vector * const vector, size_t position) {
         goto exit;
 
     // If the position is not within the array bounds, we fail early
-    if (position > vector -> size)
+    if (position >= vector -> size)
         goto exit;
 
+    // Shift the elements after the position to fill the gap
     void * element = vector -> elements[position];
-    vector -> elements[position] = NULL;
+    memmove(vector -> elements + position, vector -> elements + position + 1, (vector -> size - position - 1) * sizeof *vector -> elements);
     vector -> size--;
-
-    for (size_t i = position; i < vector -> size - 1; ++i) {
-        vector -> elements[i] = vector -> elements[i + 1];
-        vector -> elements[i + 1] = NULL;
-    }
+    vector -> elements[vector -> size] = NULL;
 
     return element;
 
@@ -284,9 +301,9 @@ void * vectorPopback(struct Vector * const vector) {
     if (vector -> size == 0)
         goto exit;
 
+    vector -> size--;
     void * element = vector -> elements[vector -> size];
     vector -> elements[vector -> size] = NULL;
-    vector -> size--;
     return element;
 
 exit:
@@ -295,3 +312,17 @@ exit:
 
 }
 
+
+/**
+ * Reports a failed operation on a vector and terminates the program.
+ * Typed vectors call it from their inline operations so the error reporting code is not duplicated at every call site.
+ *
+ * @param       operation the name of the operation that failed.
+ * @param       message error message attached to the vector.
+ * @param       file the source file the failure is reported from.
+ * @param       line the line the failure is reported from.
+ */
+_Noreturn void vectorFailure(char const * operation, char const * message, char const * file, int line) {
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: %s.\nMessage: %s\n", file, line, operation, message);
+    exit(74);
+}
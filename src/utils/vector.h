@@ -19,6 +19,8 @@
 #define UTILS_VECTOR_H
 
 #include <stdbool.h>
+#include <assert.h>
+#include <stdint.h>
 #include <stddef.h>
 
 
@@ -133,4 +135,224 @@ void * vectorErase(struct Vector * const vector, size_t position);
  */
 void * vectorPopback(struct Vector * const vector);
 
+
+/* Unchecked operations.
+ * The functions above validate their arguments and report misuse before terminating, which costs a call and a few branches on every access.
+ * The inline functions below are meant for tight loops: they perform the same operations directly on the elements array.
+ * Their preconditions are only verified by assertions, so they are checked in debug builds and free in release builds (where NDEBUG is defined).
+ */
+
+/**
+ * Return the current number of elements in the vector, without validating the vector.
+ *
+ * @param       vector pointer to the vector.
+ *
+ * @return      the number of elements in the vector.
+ */
+inline size_t vectorSizeUnchecked(struct Vector const * const vector) {
+    assert(vector != NULL);
+    return vector -> size;
+}
+
+
+/**
+ * Returns the element at the given position, without validating the vector nor the position.
+ *
+ * @param       vector pointer to the vector.
+ * @param       position index of the element within the vector, which must be less than the vector size.
+ *
+ * @return      element that was found at the given position in the vector.
+ */
+inline void * vectorAtUnchecked(struct Vector const * const vector, size_t position) {
+    assert(vector != NULL && position < vector -> size);
+    return vector -> elements[position];
+}
+
+
+/**
+ * Inserts the given element at the back of the vector, without validating the vector.
+ * Only growing the vector goes through vectorPushback().
+ *
+ * @param       vector pointer to the vector.
+ * @param       element element to insert into the vector.
+ */
+inline void vectorPushbackUnchecked(struct Vector * const vector, void * element) {
+    assert(vector != NULL);
+    if (vector -> size == vector -> capacity) {
+        vectorPushback(vector, element);
+        return;
+    }
+
+    vector -> elements[vector -> size++] = element;
+}
+
+
+/**
+ * Returns the last element in the vector and removes it from the vector, without validating the vector.
+ *
+ * @param       vector pointer to the vector, which must not be empty.
+ *
+ * @return      the last element in the vector.
+ */
+inline void * vectorPopbackUnchecked(struct Vector * const vector) {
+    assert(vector != NULL && vector -> size > 0);
+    return vector -> elements[--vector -> size];
+}
+
+
+/**
+ * Reports a failed operation on a vector and terminates the program.
+ * Typed vectors call it from their inline operations so the error reporting code is not duplicated at every call site.
+ *
+ * @param       operation the name of the operation that failed.
+ * @param       message error message attached to the vector.
+ * @param       file the source file the failure is reported from.
+ * @param       line the line the failure is reported from.
+ */
+_Noreturn void vectorFailure(char const * operation, char const * message, char const * file, int line);
+
+/* Typed vectors report failures through this macro so the report names the file and line where the failing vector type is declared or defined rather than vector.c. */
+#define VECTOR_FAILURE(operation, message) vectorFailure(operation, message, __FILE__, __LINE__)
+
+
+/* Typed vectors.
+ * VECTOR_DECLARE(Name, name, Type, inline_capacity) declares struct Name, a vector storing elements of type Type by value, together with its operations:
+ *
+ *      struct Name * newName(size_t initial_capacity, char const * message);
+ *      void deleteName(struct Name ** const vector);
+ *      void nameReserve(struct Name * const vector, size_t capacity);                          : makes room for at least capacity elements.
+ *      void nameAppend(struct Name * const vector, Type const * elements, size_t count);       : copies count elements at the back.
+ *      Type * nameData(struct Name const * const vector);                                      : the elements as a plain array.
+ *      size_t nameSize(struct Name const * const vector);
+ *      Type * nameAt(struct Name const * const vector, size_t position);                       : fails early if position is out of bounds.
+ *      void namePushback(struct Name * const vector, Type element);
+ *      Type namePopback(struct Name * const vector);                                          : fails early if the vector is empty.
+ *      void nameClear(struct Name * const vector);
+ *
+ * The first inline_capacity elements are stored inside the struct itself so short lists, the most common kind, need no allocation besides the vector.
+ * Beyond that, the elements move to the heap and the capacity doubles every time it runs out so appending is amortized O(1).
+ * VECTOR_DEFINE(Name, name, Type, inline_capacity) must appear in exactly one source file with the same arguments to emit the functions.
+ */
+#define VECTOR_DECLARE(Name, name, Type, inline_capacity)                                           \
+    struct Name {                                                                                   \
+        union {                                                                                     \
+            Type * heap;                                                                            \
+            Type small[inline_capacity];                                                            \
+        };                                                                                          \
+        size_t capacity;                                                                            \
+        size_t size;                                                                                \
+        char const * message;                                                                       \
+    };                                                                                              \
+                                                                                                    \
+    struct Name * new##Name(size_t initial_capacity, char const * message);                         \
+    void delete##Name(struct Name ** const vector);                                                 \
+    void name##Reserve(struct Name * const vector, size_t capacity);                                \
+    void name##Append(struct Name * const vector, Type const * elements, size_t count);             \
+                                                                                                    \
+    inline Type * name##Data(struct Name const * const vector) {                                    \
+        return vector -> capacity > (inline_capacity) ? vector -> heap : (Type *) vector -> small;  \
+    }                                                                                               \
+                                                                                                    \
+    inline size_t name##Size(struct Name const * const vector) {                                    \
+        return vector -> size;                                                                      \
+    }                                                                                               \
+                                                                                                    \
+    inline Type * name##At(struct Name const * const vector, size_t position) {                     \
+        if (position >= vector -> size)                                                             \
+            VECTOR_FAILURE(#name "At", vector -> message);                                          \
+        return name##Data(vector) + position;                                                       \
+    }                                                                                               \
+                                                                                                    \
+    inline void name##Pushback(struct Name * const vector, Type element) {                          \
+        if (vector -> size == vector -> capacity)                                                   \
+            name##Reserve(vector, vector -> size + 1);                                              \
+        name##Data(vector)[vector -> size++] = element;                                             \
+    }                                                                                               \
+                                                                                                    \
+    inline Type name##Popback(struct Name * const vector) {                                         \
+        if (vector -> size == 0)                                                                    \
+            VECTOR_FAILURE(#name "Popback", vector -> message);                                     \
+        return name##Data(vector)[--vector -> size];                                                \
+    }                                                                                               \
+                                                                                                    \
+    inline void name##Clear(struct Name * const vector) {                                           \
+        vector -> size = 0;                                                                         \
+    }
+
+
+#define VECTOR_DEFINE(Name, name, Type, inline_capacity)                                            \
+    extern inline Type * name##Data(struct Name const * const vector);                              \
+    extern inline size_t name##Size(struct Name const * const vector);                              \
+    extern inline Type * name##At(struct Name const * const vector, size_t position);               \
+    extern inline void name##Pushback(struct Name * const vector, Type element);                    \
+    extern inline Type name##Popback(struct Name * const vector);                                   \
+    extern inline void name##Clear(struct Name * const vector);                                     \
+                                                                                                    \
+    struct Name * new##Name(size_t initial_capacity, char const * message) {                        \
+        struct Name * vector = malloc(sizeof *vector);                                              \
+        if (vector == NULL)                                                                         \
+            VECTOR_FAILURE("new" #Name, message);                                                   \
+                                                                                                    \
+        vector -> capacity = (inline_capacity);                                                     \
+        vector -> size = 0;                                                                         \
+        vector -> message = message;                                                                \
+                                                                                                    \
+        if (initial_capacity > (inline_capacity))                                                   \
+            name##Reserve(vector, initial_capacity);                                                \
+                                                                                                    \
+        return vector;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    void delete##Name(struct Name ** const vector) {                                                \
+        if (vector == NULL || * vector == NULL)                                                     \
+            return;                                                                                 \
+                                                                                                    \
+        if ((* vector) -> capacity > (inline_capacity))                                             \
+            free((* vector) -> heap);                                                               \
+        free(* vector);                                                                             \
+        * vector = NULL;                                                                            \
+    }                                                                                               \
+                                                                                                    \
+    void name##Reserve(struct Name * const vector, size_t capacity) {                               \
+        if (capacity <= vector -> capacity)                                                         \
+            return;                                                                                 \
+                                                                                                    \
+        size_t new_capacity = 2 * vector -> capacity > capacity ? 2 * vector -> capacity : capacity;\
+        if (new_capacity > SIZE_MAX / sizeof(Type))                                                 \
+            VECTOR_FAILURE(#name "Reserve", vector -> message);                                     \
+                                                                                                    \
+        Type * elements;                                                                            \
+        if (vector -> capacity > (inline_capacity)) {                                               \
+            elements = realloc(vector -> heap, new_capacity * sizeof(Type));                        \
+            if (elements == NULL)                                                                   \
+                VECTOR_FAILURE(#name "Reserve", vector -> message);                                 \
+        }                                                                                           \
+        else {                                                                                      \
+            elements = malloc(new_capacity * sizeof(Type));                                         \
+            if (elements == NULL)                                                                   \
+                VECTOR_FAILURE(#name "Reserve", vector -> message);                                 \
+            memcpy(elements, vector -> small, vector -> size * sizeof(Type));                       \
+        }                                                                                           \
+                                                                                                    \
+        vector -> heap = elements;                                                                  \
+        vector -> capacity = new_capacity;                                                          \
+    }                                                                                               \
+                                                                                                    \
+    void name##Append(struct Name * const vector, Type const * elements, size_t count) {            \
+        if (count == 0)                                                                             \
+            return;                                                                                 \
+                                                                                                    \
+        if (count > SIZE_MAX - vector -> size)                                                      \
+            VECTOR_FAILURE(#name "Append", vector -> message);                                      \
+                                                                                                    \
+        name##Reserve(vector, vector -> size + count);                                              \
+        memcpy(name##Data(vector) + vector -> size, elements, count * sizeof(Type));                \
+        vector -> size += count;                                                                    \
+    }
+
+
+VECTOR_DECLARE(SizeTVector, sizeTVector, size_t, 8)
+VECTOR_DECLARE(Uint32Vector, uint32Vector, uint32_t, 8)
+VECTOR_DECLARE(Uint64Vector, uint64Vector, uint64_t, 4)
+
 #endif
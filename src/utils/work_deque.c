@@ -0,0 +1,208 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utils/work_deque.h"
+
+
+static struct WorkArray * newWorkArray(int64_t capacity, char const * message);
+static struct WorkArray * growWorkArray(struct WorkDeque * const deque, struct WorkArray * array, int64_t top, int64_t bottom);
+
+
+/**
+ * Initializes the deque.
+ *
+ * @param       initial_capacity the number of tasks the deque can hold before growing, a power of two.
+ * @param       message error message to display in case any operation on the deque fails.
+ *
+ * @return      the newly created deque.
+ */
+struct WorkDeque * newWorkDeque(size_t initial_capacity, char const * message) {
+    // Indices are reduced modulo the capacity with a mask
+    if (initial_capacity == 0 || (initial_capacity & (initial_capacity - 1)) != 0)
+        goto exit;
+
+    struct WorkDeque * deque = malloc(sizeof *deque);
+    if (deque == NULL)
+        goto exit;
+
+    atomic_init(& deque -> top, 0);
+    atomic_init(& deque -> bottom, 0);
+    atomic_init(& deque -> array, newWorkArray((int64_t) initial_capacity, message));
+    deque -> message = message;
+    return deque;
+
+exit:
+    fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newWorkDeque.\nMessage: %s\n", __FILE__, __LINE__, message);
+    exit(74);
+}
+
+
+/**
+ * Frees the memory occupied by the deque. No other thread may use the deque anymore.
+ *
+ * @param       deque pointer to memory occupied by the deque.
+ */
+void deleteWorkDeque(struct WorkDeque ** const deque) {
+    if (deque == NULL)
+        return;
+
+    if (* deque == NULL)
+        return;
+
+    struct WorkArray * array = atomic_load_explicit(& (* deque) -> array, memory_order_relaxed);
+    while (array != NULL) {
+        struct WorkArray * retired = array -> retired;
+        free(array);
+        array = retired;
+    }
+
+    free(* deque);
+    * deque = NULL;
+}
+
+
+/**
+ * Pushes a task at the bottom of the deque. Only the owner of the deque may push.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task the task to push.
+ */
+void workDequePush(struct WorkDeque * const deque, uint32_t task) {
+    int64_t bottom = atomic_load_explicit(& deque -> bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(& deque -> top, memory_order_acquire);
+    struct WorkArray * array = atomic_load_explicit(& deque -> array, memory_order_relaxed);
+
+    if (bottom - top >= array -> capacity)
+        array = growWorkArray(deque, array, top, bottom);
+
+    atomic_store_explicit(& array -> tasks[bottom & (array -> capacity - 1)], task, memory_order_relaxed);
+
+    // The task must be visible before the thieves can see the new bottom
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(& deque -> bottom, bottom + 1, memory_order_relaxed);
+}
+
+
+/**
+ * Takes the newest task from the bottom of the deque. Only the owner of the deque may take.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task set to the task taken if there was one.
+ *
+ * @return      true if a task was taken, false if the deque is empty.
+ */
+bool workDequeTake(struct WorkDeque * const deque, uint32_t * task) {
+    // We claim the bottom task first then check whether a thief claimed it too
+    int64_t bottom = atomic_load_explicit(& deque -> bottom, memory_order_relaxed) - 1;
+    struct WorkArray * array = atomic_load_explicit(& deque -> array, memory_order_relaxed);
+    atomic_store_explicit(& deque -> bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(& deque -> top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(& deque -> bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    * task = atomic_load_explicit(& array -> tasks[bottom & (array -> capacity - 1)], memory_order_relaxed);
+    if (top < bottom)
+        return true;
+
+    // This is the last task so thieves may be after it: whoever moves the top first gets it
+    bool taken = atomic_compare_exchange_strong_explicit(& deque -> top, & top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(& deque -> bottom, bottom + 1, memory_order_relaxed);
+    return taken;
+}
+
+
+/**
+ * Steals the oldest task from the top of the deque. Any thread may steal.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task set to the task stolen on success.
+ *
+ * @return      STEAL_SUCCESS if a task was stolen, STEAL_EMPTY if there was none and STEAL_ABORT if we lost a race for it.
+ */
+enum StealResult workDequeSteal(struct WorkDeque * const deque, uint32_t * task) {
+    int64_t top = atomic_load_explicit(& deque -> top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(& deque -> bottom, memory_order_acquire);
+
+    if (top >= bottom)
+        return STEAL_EMPTY;
+
+    struct WorkArray * array = atomic_load_explicit(& deque -> array, memory_order_acquire);
+    uint32_t stolen = atomic_load_explicit(& array -> tasks[top & (array -> capacity - 1)], memory_order_relaxed);
+    if (atomic_compare_exchange_strong_explicit(& deque -> top, & top, top + 1, memory_order_seq_cst, memory_order_relaxed) == false)
+        return STEAL_ABORT;
+
+    * task = stolen;
+    return STEAL_SUCCESS;
+}
+
+
+/**
+ * Allocates an empty array of tasks.
+ *
+ * @param       capacity the number of tasks the array can hold, a power of two.
+ * @param       message error message to display if we run out of memory.
+ *
+ * @return      the new array.
+ */
+static struct WorkArray * newWorkArray(int64_t capacity, char const * message) {
+    struct WorkArray * array = malloc(sizeof *array + (size_t) capacity * sizeof array -> tasks[0]);
+    if (array == NULL) {
+        fprintf(stderr, "File: %s.\nLine: %d.\nOperation: newWorkArray.\nMessage: %s\n", __FILE__, __LINE__, message);
+        exit(74);
+    }
+
+    array -> retired = NULL;
+    array -> capacity = capacity;
+    return array;
+}
+
+
+/**
+ * Replaces the array of the deque with one twice as large holding the same tasks.
+ *
+ * @param       deque pointer to the deque which array is full.
+ * @param       array the current array of the deque.
+ * @param       top the index of the oldest task.
+ * @param       bottom the index one past the newest task.
+ *
+ * @return      the new array.
+ */
+static struct WorkArray * growWorkArray(struct WorkDeque * const deque, struct WorkArray * array, int64_t top, int64_t bottom) {
+    struct WorkArray * grown = newWorkArray(2 * array -> capacity, deque -> message);
+    for (int64_t i = top; i < bottom; i++) {
+        uint32_t task = atomic_load_explicit(& array -> tasks[i & (array -> capacity - 1)], memory_order_relaxed);
+        atomic_store_explicit(& grown -> tasks[i & (grown -> capacity - 1)], task, memory_order_relaxed);
+    }
+
+    // Thieves that loaded the old array before the swap still read from it so it is only freed with the deque
+    grown -> retired = array;
+    atomic_store_explicit(& deque -> array, grown, memory_order_release);
+    return grown;
+}
@@ -0,0 +1,107 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef UTILS_WORK_DEQUE_H
+#define UTILS_WORK_DEQUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/* The outcome of an attempt to steal a task from a deque. */
+enum StealResult {
+    STEAL_SUCCESS,
+    STEAL_EMPTY,            // the deque had no task
+    STEAL_ABORT             // another thread took the task first, the deque may still hold others
+};
+
+/* The circular array a deque stores its tasks in. */
+struct WorkArray {
+    struct WorkArray * retired;
+    int64_t capacity;
+    _Atomic uint32_t tasks[];
+};
+
+/* Work stealing deque of tasks (Chase and Lev, "Dynamic Circular Work-Stealing Deque").
+ * A single thread, the owner, pushes and takes tasks at the bottom while any other thread can steal tasks from the top.
+ * The owner never waits for the thieves: they only contend with it for the last task.
+ *
+ * top          : the index of the oldest task, the next one to be stolen.
+ * bottom       : the index one past the newest task, where the owner pushes and takes.
+ * array        : the tasks between top and bottom. When it fills up, the owner replaces it with one twice as large;
+ *                thieves may still be reading the old one so it is kept until the deque is deleted.
+ */
+struct WorkDeque {
+    _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic(struct WorkArray *) array;
+    char const * message;
+};
+
+
+/**
+ * Initializes the deque.
+ *
+ * @param       initial_capacity the number of tasks the deque can hold before growing, a power of two.
+ * @param       message error message to display in case any operation on the deque fails.
+ *
+ * @return      the newly created deque.
+ */
+struct WorkDeque * newWorkDeque(size_t initial_capacity, char const * message);
+
+
+/**
+ * Frees the memory occupied by the deque. No other thread may use the deque anymore.
+ *
+ * @param       deque pointer to memory occupied by the deque.
+ */
+void deleteWorkDeque(struct WorkDeque ** const deque);
+
+
+/**
+ * Pushes a task at the bottom of the deque. Only the owner of the deque may push.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task the task to push.
+ */
+void workDequePush(struct WorkDeque * const deque, uint32_t task);
+
+
+/**
+ * Takes the newest task from the bottom of the deque. Only the owner of the deque may take.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task set to the task taken if there was one.
+ *
+ * @return      true if a task was taken, false if the deque is empty.
+ */
+bool workDequeTake(struct WorkDeque * const deque, uint32_t * task);
+
+
+/**
+ * Steals the oldest task from the top of the deque. Any thread may steal.
+ *
+ * @param       deque pointer to the deque.
+ * @param       task set to the task stolen on success.
+ *
+ * @return      STEAL_SUCCESS if a task was stolen, STEAL_EMPTY if there was none and STEAL_ABORT if we lost a race for it.
+ */
+enum StealResult workDequeSteal(struct WorkDeque * const deque, uint32_t * task);
+
+#endif
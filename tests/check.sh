@@ -0,0 +1,64 @@
+#!/bin/sh
+#
+# Compiles every program under tests and compares what the compiler prints with the expected output next to the program.
+# The expected output holds the tokens of the program, as printed with AVALON_DUMP=tokens, followed by the diagnostics and the exit status of the compiler.
+# Every program is also read from the standard input to make sure the streaming lexer finds the same tokens as the lexer over the whole file.
+#
+# usage: sh tests/check.sh <compiler>
+#
+
+compiler=$1
+if [ ! -x "$compiler" ]; then
+    echo "usage: sh tests/check.sh <compiler>"
+    exit 2
+fi
+
+actual=$(mktemp)
+streamed=$(mktemp)
+long=$(mktemp)
+trap 'rm -f "$actual" "$actual.err" "$actual.tokens" "$streamed" "$long"' EXIT
+
+checked=0
+failed=0
+for program in $(find tests -name '*.avl' | sort); do
+    checked=$((checked + 1))
+
+    # The compiler prints the source before its tokens, the source ends with an extra new line
+    AVALON_DUMP=tokens "$compiler" "$program" > "$actual" 2> "$actual.err"
+    status=$?
+    lines=$(wc -l < "$program")
+    tail -n +$((lines + 2)) "$actual" > "$actual.tokens"
+    cat "$actual.tokens" "$actual.err" > "$actual"
+    echo "status $status" >> "$actual"
+
+    if ! cmp -s "$actual" "${program%.avl}.expected"; then
+        echo "FAIL $program"
+        diff "${program%.avl}.expected" "$actual" | head -20
+        failed=$((failed + 1))
+    fi
+
+    AVALON_DUMP=tokens "$compiler" - < "$program" > "$streamed" 2> /dev/null
+    if ! cmp -s "$actual.tokens" "$streamed"; then
+        echo "FAIL $program read from the standard input"
+        diff "$actual.tokens" "$streamed" | head -20
+        failed=$((failed + 1))
+    fi
+done
+
+# A comment longer than the window of the streaming lexer is read over several windows, once unterminated and once followed by more of the program
+for ending in "" "]-"; do
+    checked=$((checked + 1))
+    { echo "def f:"; echo "    a"; echo "    -["; seq -f "    line %g of a long comment" 20000; echo "    $ending"; echo "    b"; } > "$long"
+
+    AVALON_DUMP=tokens "$compiler" "$long" > "$actual" 2> /dev/null
+    AVALON_DUMP=tokens "$compiler" - < "$long" > "$streamed" 2> /dev/null
+    tail -n +$(($(wc -l < "$long") + 2)) "$actual" > "$actual.tokens"
+    if ! cmp -s "$actual.tokens" "$streamed"; then
+        echo "FAIL long comment ending with '$ending' read from the standard input"
+        diff "$actual.tokens" "$streamed" | head -20
+        failed=$((failed + 1))
+    fi
+done
+
+echo "$checked programs checked, $failed failures"
+[ $failed -eq 0 ]
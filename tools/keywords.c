@@ -0,0 +1,222 @@
+/*  This file is part of the Avalon programming language
+ * 
+ *  Copyright (c) 2018-2019 Ntwali Bashige Toussaint
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/* Build time generator of the lexer keyword table.
+ * It searches for a seed that makes keywordHash() collision-free over AVL_KEYWORDS, verifies that every keyword and every near-miss of a keyword classifies correctly and writes the table as a header.
+ *
+ * Usage: keywords <output header>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/token_type.h"
+#include "lexer/keyword_hash.h"
+
+
+#define MAX_BITS        10
+#define MAX_SEED        (1u << 16)
+
+#define KEYWORD_ENTRY(lexeme, type) { lexeme, sizeof(lexeme) - 1, type },
+static struct Keyword const source_keywords[] = {
+    AVL_KEYWORDS(KEYWORD_ENTRY)
+};
+#undef KEYWORD_ENTRY
+
+static size_t const keywords_count = sizeof source_keywords / sizeof source_keywords[0];
+
+static struct Keyword table[1u << MAX_BITS];
+
+static bool buildTable(uint32_t seed, unsigned bits);
+static int classify(char const * lexeme, size_t length, uint32_t seed, unsigned bits);
+static int expectedType(char const * lexeme, size_t length);
+static bool verifyTable(uint32_t seed, unsigned bits);
+static void writeTable(FILE * output, uint32_t seed, unsigned bits);
+
+
+int main(int argc, char * argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: keywords <output header>\n");
+        return 64;
+    }
+
+    // We want the smallest table that admits a collision-free seed so the table stays in as few cache lines as possible
+    for (unsigned bits = 1; bits <= MAX_BITS; bits++) {
+        if ((1u << bits) < keywords_count)
+            continue;
+
+        for (uint32_t seed = 0; seed < MAX_SEED; seed++) {
+            if (buildTable(seed, bits) == false)
+                continue;
+
+            if (verifyTable(seed, bits) == false)
+                return 70;
+
+            FILE * output = fopen(argv[1], "w");
+            if (output == NULL) {
+                fprintf(stderr, "Failed to open file <%s>.\n", argv[1]);
+                return 74;
+            }
+
+            writeTable(output, seed, bits);
+            fclose(output);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "Could not find a collision-free seed for the keyword table.\n");
+    return 70;
+}
+
+
+/**
+ * Fills the table with the keywords hashed using the given seed.
+ *
+ * @param       seed the seed to try.
+ * @param       bits the base two logarithm of the table size.
+ *
+ * @return      true if no two keywords landed in the same slot.
+ */
+static bool buildTable(uint32_t seed, unsigned bits) {
+    memset(table, 0, sizeof table);
+
+    for (size_t i = 0; i < keywords_count; i++) {
+        struct Keyword const * keyword = & source_keywords[i];
+        uint32_t slot = keywordHash(keyword -> lexeme, keyword -> length, seed, bits);
+        if (table[slot].length != 0)
+            return false;
+
+        table[slot] = * keyword;
+    }
+
+    return true;
+}
+
+
+/**
+ * Classifies a lexeme the way the lexer does: one hash and one comparison.
+ *
+ * @return      the keyword token type or AVL_IDENTIFIER.
+ */
+static int classify(char const * lexeme, size_t length, uint32_t seed, unsigned bits) {
+    struct Keyword const * keyword = & table[keywordHash(lexeme, length, seed, bits)];
+    if (keyword -> length == length && memcmp(keyword -> lexeme, lexeme, length) == 0)
+        return keyword -> type;
+
+    return AVL_IDENTIFIER;
+}
+
+
+/**
+ * Classifies a lexeme by scanning the keyword list.
+ *
+ * @return      the keyword token type or AVL_IDENTIFIER.
+ */
+static int expectedType(char const * lexeme, size_t length) {
+    for (size_t i = 0; i < keywords_count; i++) {
+        if (source_keywords[i].length == length && memcmp(source_keywords[i].lexeme, lexeme, length) == 0)
+            return source_keywords[i].type;
+    }
+
+    return AVL_IDENTIFIER;
+}
+
+
+/**
+ * Checks that every keyword and every near-miss of a keyword classifies correctly.
+ * Near-misses are all prefixes of a keyword, the keyword extended by one identifier character and the keyword with any one character replaced by any other identifier character.
+ *
+ * @return      true if the table classifies everything correctly.
+ */
+static bool verifyTable(uint32_t seed, unsigned bits) {
+    static char const alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    char lexeme[64];
+    size_t length = 0;
+    size_t checked = 0;
+
+    for (size_t i = 0; i < keywords_count; i++) {
+        struct Keyword const * keyword = & source_keywords[i];
+
+        // Every prefix, including the keyword itself
+        for (length = 1; length <= keyword -> length; length++) {
+            memcpy(lexeme, keyword -> lexeme, length);
+            if (classify(lexeme, length, seed, bits) != expectedType(lexeme, length))
+                goto failure;
+            checked++;
+        }
+
+        for (size_t c = 0; c < sizeof alphabet - 1; c++) {
+            // The keyword extended by one character
+            length = keyword -> length + 1;
+            memcpy(lexeme, keyword -> lexeme, keyword -> length);
+            lexeme[keyword -> length] = alphabet[c];
+            if (classify(lexeme, length, seed, bits) != expectedType(lexeme, length))
+                goto failure;
+            checked++;
+
+            // The keyword with one character replaced
+            length = keyword -> length;
+            for (size_t position = 0; position < length; position++) {
+                memcpy(lexeme, keyword -> lexeme, length);
+                lexeme[position] = alphabet[c];
+                if (classify(lexeme, length, seed, bits) != expectedType(lexeme, length))
+                    goto failure;
+                checked++;
+            }
+        }
+    }
+
+    fprintf(stderr, "Keyword table verified: %zu keywords, %zu lexemes checked, %u slots, seed 0x%08x.\n", keywords_count, checked, 1u << bits, seed);
+    return true;
+
+failure:
+    fprintf(stderr, "Keyword table misclassifies <%.*s>.\n", (int) length, lexeme);
+    return false;
+}
+
+
+/**
+ * Writes the keyword table as a C header.
+ */
+static void writeTable(FILE * output, uint32_t seed, unsigned bits) {
+    fprintf(output, "/* Generated by tools/keywords.c from AVL_KEYWORDS in common/token_type.h. Do not edit. */\n\n");
+    fprintf(output, "#ifndef LEXER_KEYWORDS_H\n#define LEXER_KEYWORDS_H\n\n");
+    fprintf(output, "#include \"common/token_type.h\"\n#include \"lexer/keyword_hash.h\"\n\n");
+
+    size_t max_length = 0;
+    for (size_t i = 0; i < keywords_count; i++) {
+        if (source_keywords[i].length > max_length)
+            max_length = source_keywords[i].length;
+    }
+
+    fprintf(output, "#define KEYWORD_SEED        0x%08xu\n", seed);
+    fprintf(output, "#define KEYWORD_BITS        %u\n", bits);
+    fprintf(output, "#define KEYWORD_MAX_LENGTH  %zu\n\n", max_length);
+
+    fprintf(output, "static struct Keyword const keywords[%u] = {\n", 1u << bits);
+    for (uint32_t slot = 0; slot < (1u << bits); slot++) {
+        if (table[slot].length == 0)
+            fprintf(output, "    { \"\", 0, 0 },\n");
+        else
+            fprintf(output, "    { \"%s\", %u, AVL_%s },\n", table[slot].lexeme, (unsigned) table[slot].length, tokenTypeToString((enum TokenType) table[slot].type));
+    }
+    fprintf(output, "};\n\n#endif\n");
+}